@@ -0,0 +1,30 @@
+#ifndef _ADT_H
+#define _ADT_H
+
+/*******************************************************************************
+ * libadt: everything in one include
+ */
+
+#include "alloc.h"
+#include "cache.h"
+#include "stats.h"
+#include "harden.h"
+#include "pool.h"
+#include "mpool.h"
+#include "list.h"
+#include "dlist.h"
+#include "lru.h"
+#include "hashmap.h"
+#include "skiplist.h"
+#include "heap.h"
+#include "ulist.h"
+#include "ixlist.h"
+#include "scan.h"
+#include "plist.h"
+#include "ring.h"
+#include "hazard.h"
+#include "cqueue.h"
+#include "tpool.h"
+
+
+#endif
@@ -0,0 +1,63 @@
+#include <stdlib.h>
+#include "alloc.h"
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+static void *
+ADT_malloc_alloc(void *ctx, size_t size)
+{
+  return malloc(size);
+}
+
+static void
+ADT_malloc_free(void *ctx, void *ptr)
+{
+  free(ptr);
+}
+
+const struct ADT_allocator ADT_malloc_allocator = {
+  &ADT_malloc_alloc, &ADT_malloc_free, NULL
+};
+
+static const struct ADT_allocator *ADT_default_allocator = &ADT_malloc_allocator;
+
+/*
+ * Set the library-wide allocator used by structures initialized from now on.
+ * Structures keep the allocator they were initialized with, so changing it
+ * never mixes allocators within one structure.
+ * Pre: alloc outlives every structure initialized while it is set. This is
+ *      not synchronized; set it before other threads use libadt.
+ * Post: passing NULL restores ADT_malloc_allocator.
+ */
+void
+ADT_set_allocator(const struct ADT_allocator *alloc)
+{
+  ADT_default_allocator = (alloc != NULL) ? alloc : &ADT_malloc_allocator;
+}
+
+const struct ADT_allocator *
+ADT_get_allocator(void)
+{
+  return ADT_default_allocator;
+}
+
+/*
+ * Allocate size bytes from alloc.
+ * Returns: a pointer to the memory or NULL on failure.
+ */
+void *
+ADT_alloc(const struct ADT_allocator *alloc, size_t size)
+{
+  return (*alloc->alloc)(alloc->ctx, size);
+}
+
+/*
+ * Return ptr to alloc. This is a no-op for allocators which reclaim in bulk.
+ */
+void
+ADT_free(const struct ADT_allocator *alloc, void *ptr)
+{
+  if (alloc->free != NULL)
+    (*alloc->free)(alloc->ctx, ptr);
+}
@@ -0,0 +1,28 @@
+#ifndef _ADT_ALLOC_H
+#define _ADT_ALLOC_H
+
+#include <stddef.h>
+
+/*******************************************************************************
+ * Allocator interface
+ *
+ * Every libadt structure gets its memory through an ADT_allocator. An
+ * allocator whose free is NULL owns everything it hands out and reclaims it
+ * in bulk (e.g. an arena), so structures built on it skip per-node frees.
+ */
+
+struct ADT_allocator {
+  void *(*alloc)(void *ctx, size_t size);
+  void (*free)(void *ctx, void *ptr);
+  void *ctx;
+};
+
+extern const struct ADT_allocator ADT_malloc_allocator;
+
+void ADT_set_allocator(const struct ADT_allocator *);
+const struct ADT_allocator *ADT_get_allocator(void);
+void *ADT_alloc(const struct ADT_allocator *, size_t);
+void ADT_free(const struct ADT_allocator *, void *);
+
+
+#endif
@@ -0,0 +1,446 @@
+/*
+ * Single threaded microbenchmarks for the libadt lists and queues.
+ *
+ * For every variant and every list size from 10 up to the maximum (-n,
+ * default 10^7, in powers of ten) each operation is timed over the whole
+ * list, warm (the list was just built) and cold (the caches were flushed
+ * by writing a large buffer first). Results are ns/op and allocations/op
+ * counted through the library-wide allocator, one record per line as CSV,
+ * or as a JSON array with -j.
+ *
+ * make benchlist links it against the release library, optimized and
+ * built with NDEBUG, so the figures leave out the assert and ADT_check
+ * precondition checks that only debug builds run.
+ *
+ * usage: benchlist [-j] [-n max_size] [-f flush_mb] [-v variant]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "alloc.h"
+#include "pool.h"
+#include "list.h"
+#include "ulist.h"
+#include "cqueue.h"
+
+enum op {
+  OP_PUSH, OP_POP, OP_APPEND, OP_INSERT_AFTER, OP_REMOVE_AFTER, OP_DESTROY,
+  OP_TRAVERSE, OP_MAP, OP_FIND_CMP, OP_FIND, OP_COUNT
+};
+
+static const char *op_names[OP_COUNT] = {
+  "push", "pop", "append", "insert_after", "remove_after", "destroy", "traverse", "map",
+  "find_cmp", "find"
+};
+
+struct bench {
+  int cold;
+  char *flush;
+  size_t flush_len;
+  double start;
+  unsigned long start_allocs;
+  double ns[OP_COUNT];
+  double allocs[OP_COUNT];
+  double ops[OP_COUNT];
+};
+
+static unsigned long allocs;
+static volatile long sink;
+static int json;
+static int records;
+
+static void *counting_alloc(void *ctx, size_t size)
+{
+  allocs++;
+  return malloc(size);
+}
+
+static void counting_free(void *ctx, void *ptr)
+{
+  free(ptr);
+}
+
+static const struct ADT_allocator counting = { &counting_alloc, &counting_free, NULL };
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void begin(struct bench *b)
+{
+  size_t i;
+
+  if (b->cold) {
+    for (i = 0; i < b->flush_len; i += 64)
+      b->flush[i]++;
+  }
+  b->start_allocs = allocs;
+  b->start = now_ns();
+}
+
+static void end(struct bench *b, enum op op, size_t n)
+{
+  b->ns[op] += now_ns() - b->start;
+  b->allocs[op] += allocs - b->start_allocs;
+  b->ops[op] += n;
+}
+
+static void report(struct bench *b, const char *variant, size_t n)
+{
+  int op;
+
+  for (op = 0; op < OP_COUNT; op++) {
+    if (b->ops[op] == 0)
+      continue;
+    if (json)
+      printf("%s\n  {\"variant\": \"%s\", \"op\": \"%s\", \"size\": %zu, \"cache\": \"%s\", "
+             "\"ns_per_op\": %.2f, \"allocs_per_op\": %.3f}",
+             records ? "," : "", variant, op_names[op], n, b->cold ? "cold" : "warm",
+             b->ns[op] / b->ops[op], b->allocs[op] / b->ops[op]);
+    else
+      printf("%s,%s,%zu,%s,%.2f,%.3f\n", variant, op_names[op], n,
+             b->cold ? "cold" : "warm", b->ns[op] / b->ops[op], b->allocs[op] / b->ops[op]);
+    records++;
+  }
+  fflush(stdout);
+}
+
+static void visit(void *data, void *ctx)
+{
+  *(long *)ctx += *(long *)data;
+}
+
+/* find_cmp looks for a missing key through a comparator call per element. */
+static int match(const void *data, const void *key)
+{
+  return data == key;
+}
+
+static int (*volatile matcher)(const void *, const void *) = &match;
+
+/*
+ * Point the n entries of data at the n longs of values in a fixed
+ * shuffled order, so that reading the data behind a list in order misses
+ * the cache the way scattered heap objects do.
+ */
+static void scatter(void **data, long *values, size_t n)
+{
+  unsigned long r = 1;
+  size_t i, j;
+  void *t;
+
+  for (i = 0; i < n; i++) {
+    values[i] = i;
+    data[i] = &values[i];
+  }
+  for (i = n; i > 1; i--) {
+    r = r * 6364136223846793005UL + 1442695040888963407UL;
+    j = (r >> 33) % i;
+    t = data[i - 1];
+    data[i - 1] = data[j];
+    data[j] = t;
+  }
+}
+
+/*
+ * Each run starts from an empty structure, leaves it empty, and keeps the
+ * length at or below n throughout, so the largest sizes fit in memory.
+ */
+static void run_sl(struct bench *b, struct ADT_pool *pool, size_t n)
+{
+  struct ADT_sl_list list;
+  struct ADT_sl_node *node;
+  void *data, **items = (void **)malloc(n * sizeof(void *));
+  long sum = 0, *values = (long *)malloc(n * sizeof(long));
+  size_t i;
+
+  if (items == NULL || values == NULL) {
+    free(items);
+    free(values);
+    return;
+  }
+  scatter(items, values, n);
+  if (pool != NULL)
+    ADT_sl_list_init_pooled(&list, pool);
+  else
+    ADT_sl_list_init(&list);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_sl_list_push(&list, items[i]);
+  end(b, OP_PUSH, n);
+  begin(b);
+  for (node = list.head; node != NULL; node = node->next)
+    sum += *(long *)node->data;
+  end(b, OP_TRAVERSE, n);
+  begin(b);
+  ADT_sl_list_map(&list, &visit, &sum);
+  end(b, OP_MAP, n);
+  begin(b);
+  for (node = list.head; node != NULL; node = node->next)
+    if ((*matcher)(node->data, (void *)n))
+      break;
+  end(b, OP_FIND_CMP, n);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_sl_list_pop(&list, &data);
+  end(b, OP_POP, n);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_sl_list_append(&list, items[i]);
+  end(b, OP_APPEND, n);
+  if (n > 1) {
+    begin(b);
+    for (i = 1; i < n; i++)
+      ADT_sl_list_remove_after(&list, list.head, &data);
+    end(b, OP_REMOVE_AFTER, n - 1);
+    begin(b);
+    for (i = 1; i < n; i++)
+      ADT_sl_list_insert_after(&list, list.head, items[i]);
+    end(b, OP_INSERT_AFTER, n - 1);
+  }
+  begin(b);
+  ADT_sl_list_destroy(&list, NULL);
+  end(b, OP_DESTROY, n);
+  free(items);
+  free(values);
+  sink = sum;
+}
+
+static void run_sl_malloc(struct bench *b, size_t n)
+{
+  run_sl(b, NULL, n);
+}
+
+static void run_sl_pooled(struct bench *b, size_t n)
+{
+  struct ADT_pool pool;
+
+  ADT_sl_pool_init(&pool, 1024);
+  run_sl(b, &pool, n);
+  ADT_pool_destroy(&pool);
+}
+
+struct bench_item {
+  long value;
+  struct ADT_sl_link link;
+};
+
+static void run_sl_intrusive(struct bench *b, size_t n)
+{
+  struct bench_item *items = (struct bench_item *)malloc(n * sizeof(struct bench_item));
+  struct ADT_sl_ilist list;
+  struct ADT_sl_link *link;
+  long sum = 0;
+  size_t i;
+
+  if (items == NULL)
+    return;
+  for (i = 0; i < n; i++)
+    items[i].value = i;
+  ADT_sl_ilist_init(&list);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_sl_ilist_push(&list, &items[i].link);
+  end(b, OP_PUSH, n);
+  begin(b);
+  for (link = list.head; link != NULL; link = link->next)
+    sum += ADT_sl_ilist_entry(link, struct bench_item, link)->value;
+  end(b, OP_TRAVERSE, n);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_sl_ilist_pop(&list, &link);
+  end(b, OP_POP, n);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_sl_ilist_append(&list, &items[i].link);
+  end(b, OP_APPEND, n);
+  if (n > 1) {
+    begin(b);
+    for (i = 1; i < n; i++)
+      ADT_sl_ilist_remove_after(&list, list.head, &link);
+    end(b, OP_REMOVE_AFTER, n - 1);
+    begin(b);
+    for (i = 1; i < n; i++)
+      ADT_sl_ilist_insert_after(&list, list.head, &items[i].link);
+    end(b, OP_INSERT_AFTER, n - 1);
+  }
+  free(items);
+  sink = sum;
+}
+
+static void run_ul(struct bench *b, size_t n)
+{
+  struct ADT_ul_list list;
+  struct ADT_ul_node *node;
+  void *data;
+  long sum = 0;
+  size_t i;
+  unsigned int j;
+
+  ADT_ul_list_init(&list);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_ul_list_push(&list, (void *)i);
+  end(b, OP_PUSH, n);
+  begin(b);
+  for (node = list.head; node != NULL; node = node->next)
+    for (j = node->start; j < node->start + node->count; j++)
+      sum += (long)node->data[j];
+  end(b, OP_TRAVERSE, n);
+  begin(b);
+  for (node = list.head; node != NULL; node = node->next)
+    for (j = node->start; j < node->start + node->count; j++)
+      if ((*matcher)(node->data[j], (void *)n))
+        goto found;
+found:
+  end(b, OP_FIND_CMP, n);
+  begin(b);
+  sum += ADT_ul_list_find(&list, (void *)n, NULL, NULL);
+  end(b, OP_FIND, n);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_ul_list_pop(&list, &data);
+  end(b, OP_POP, n);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_ul_list_append(&list, (void *)i);
+  end(b, OP_APPEND, n);
+  begin(b);
+  ADT_ul_list_destroy(&list, NULL);
+  end(b, OP_DESTROY, n);
+  sink = sum;
+}
+
+/* The concurrent queues, uncontended: append is enqueue and pop dequeue. */
+static void run_ms_queue(struct bench *b, size_t n)
+{
+  struct ADT_ms_queue q;
+  void *data;
+  size_t i;
+
+  if (ADT_ms_queue_init(&q) != 0)
+    return;
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_ms_queue_enqueue(&q, (void *)i);
+  end(b, OP_APPEND, n);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_ms_queue_dequeue(&q, &data);
+  end(b, OP_POP, n);
+  for (i = 0; i < n; i++)
+    ADT_ms_queue_enqueue(&q, (void *)i);
+  begin(b);
+  ADT_ms_queue_destroy(&q, NULL);
+  end(b, OP_DESTROY, n);
+}
+
+struct bench_mpsc_item {
+  long value;
+  struct ADT_mpsc_link link;
+};
+
+static void run_mpsc_queue(struct bench *b, size_t n)
+{
+  struct bench_mpsc_item *items;
+  struct ADT_mpsc_queue q;
+  struct ADT_mpsc_link *link;
+  size_t i;
+
+  items = (struct bench_mpsc_item *)malloc(n * sizeof(struct bench_mpsc_item));
+  if (items == NULL)
+    return;
+  ADT_mpsc_queue_init(&q);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_mpsc_queue_enqueue(&q, &items[i].link);
+  end(b, OP_APPEND, n);
+  begin(b);
+  for (i = 0; i < n; i++)
+    ADT_mpsc_queue_dequeue(&q, &link);
+  end(b, OP_POP, n);
+  free(items);
+}
+
+struct variant {
+  const char *name;
+  void (*run)(struct bench *, size_t);
+};
+
+static const struct variant variants[] = {
+  { "sl_list", &run_sl_malloc },
+  { "sl_list_pooled", &run_sl_pooled },
+  { "sl_ilist", &run_sl_intrusive },
+  { "ul_list", &run_ul },
+  { "ms_queue", &run_ms_queue },
+  { "mpsc_queue", &run_mpsc_queue },
+  { NULL, NULL }
+};
+
+int main(int argc, char **argv)
+{
+  struct bench b;
+  const struct variant *v;
+  const char *only = NULL;
+  size_t max = 10000000, flush_mb = 64, n, reps, r;
+  int c;
+
+  while ((c = getopt(argc, argv, "jn:f:v:")) != -1) {
+    switch (c) {
+    case 'j':
+      json = 1;
+      break;
+    case 'n':
+      max = strtoul(optarg, NULL, 10);
+      break;
+    case 'f':
+      flush_mb = strtoul(optarg, NULL, 10);
+      break;
+    case 'v':
+      only = optarg;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-j] [-n max_size] [-f flush_mb] [-v variant]\n", argv[0]);
+      return 1;
+    }
+  }
+  memset(&b, 0, sizeof(b));
+  b.flush_len = flush_mb << 20;
+  b.flush = (char *)calloc(b.flush_len ? b.flush_len : 1, 1);
+  if (b.flush == NULL)
+    return 1;
+  ADT_set_allocator(&counting);
+
+  if (json)
+    printf("[");
+  else
+    printf("variant,op,size,cache,ns_per_op,allocs_per_op\n");
+  for (v = variants; v->name != NULL; v++) {
+    if (only != NULL && strcmp(only, v->name) != 0)
+      continue;
+    for (n = 10; n <= max; n *= 10) {
+      for (b.cold = 0; b.cold <= 1; b.cold++) {
+        /* Repeat small sizes so each record covers enough operations. */
+        reps = (b.cold ? 100 : 1000000) / n;
+        if (reps == 0)
+          reps = 1;
+        memset(b.ns, 0, sizeof(b.ns));
+        memset(b.allocs, 0, sizeof(b.allocs));
+        memset(b.ops, 0, sizeof(b.ops));
+        for (r = 0; r < reps; r++)
+          (*v->run)(&b, n);
+        report(&b, v->name, n);
+      }
+    }
+  }
+  if (json)
+    printf("\n]\n");
+  free(b.flush);
+  return 0;
+}
@@ -0,0 +1,547 @@
+/*
+ * Contention benchmark for the libadt concurrent queues.
+ *
+ * For every variant, producer threads enqueue timestamped messages as fast
+ * as they can while consumer threads dequeue them, sweeping both counts in
+ * powers of two up to the maximums (-P and -C, default 4 each). The
+ * single consumer queues only run with one consumer, and in the thread
+ * pool the workers are the consumers. Each record has the throughput and
+ * the p50/p99/p99.9/max enqueue to dequeue latency, from a log-linear
+ * histogram exact to within 1/32 of the value, plus cache misses and
+ * context switches where perf counters are available (-1 otherwise). One
+ * record per line as CSV, or a JSON array with -j.
+ *
+ * -p pins producer i to CPU i and consumer j to CPU P + j, modulo the
+ * online CPUs; pool workers are never pinned. Consumers of the polling
+ * queues yield when they find them empty.
+ *
+ * usage: benchqueue [-j] [-p] [-n msgs_per_producer] [-P producers]
+ *                   [-C consumers] [-v variant]
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#ifdef __linux__
+  #include <sys/syscall.h>
+  #include <linux/perf_event.h>
+#endif
+#include "list.h"
+#include "cqueue.h"
+#include "hazard.h"
+#include "tpool.h"
+
+#define SUB_BITS 5
+#define SUB (1 << SUB_BITS)
+#define MAX_SHIFT 36                    /* values from 2^42 ns up are clamped */
+#define NBUCKETS (2 * SUB + MAX_SHIFT * SUB)
+#define MAX_THREADS 64
+
+/* Below 2 * SUB every value has its own bucket; above, SUB per octave. */
+struct hist {
+  unsigned long long count[NBUCKETS];
+  unsigned long long n;
+  uint64_t max;
+};
+
+struct msg {
+  union {
+    struct ADT_mpsc_link mpsc;
+    struct ADT_bq_link bq;
+    struct ADT_task task;
+  } u;
+  uint64_t stamp;                       /* enqueue time, 0 for a stop message */
+};
+
+struct run;
+
+struct variant {
+  const char *name;
+  int single_consumer;
+  void (*init)(struct run *);
+  void (*enqueue)(struct run *, struct msg *);
+  struct msg *(*dequeue)(struct run *);   /* NULL when empty */
+  void (*destroy)(struct run *);
+};
+
+struct run {
+  const struct variant *v;
+  unsigned int producers;
+  unsigned int consumers;
+  size_t n;
+  int pin;
+  atomic_int go;
+  atomic_uint ready;
+  pthread_mutex_t lock;
+  struct ADT_sl_list list;
+  struct ADT_ms_queue ms;
+  struct ADT_mpsc_queue mpsc;
+  struct ADT_bqueue bq;
+  struct ADT_tpool pool;
+  atomic_long remaining;                /* thread pool messages not yet run */
+  atomic_uint slots;
+  struct hist *hists;                   /* one per consumer */
+};
+
+struct worker {
+  struct run *run;
+  unsigned int cpu;
+  struct msg *msgs;
+  struct hist *hist;
+};
+
+static int json;
+static int records;
+static struct run *pool_run;            /* the run whose pool is executing tasks */
+static _Thread_local struct hist *pool_hist;
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static unsigned int bucket(uint64_t v)
+{
+  unsigned int shift;
+
+  if (v < 2 * SUB)
+    return (unsigned int)v;
+  shift = 63 - __builtin_clzll(v) - SUB_BITS;
+  if (shift > MAX_SHIFT)
+    return NBUCKETS - 1;
+  return 2 * SUB + (shift - 1) * SUB + (unsigned int)(v >> shift) - SUB;
+}
+
+/* The lowest value falling in bucket i. */
+static uint64_t bucket_value(unsigned int i)
+{
+  unsigned int shift;
+
+  if (i < 2 * SUB)
+    return i;
+  shift = (i - 2 * SUB) / SUB + 1;
+  return (uint64_t)((i - 2 * SUB) % SUB + SUB) << shift;
+}
+
+static void record(struct hist *h, uint64_t stamp)
+{
+  uint64_t v = now_ns() - stamp;
+
+  h->count[bucket(v)]++;
+  h->n++;
+  if (v > h->max)
+    h->max = v;
+}
+
+static uint64_t percentile(const struct hist *h, double p)
+{
+  unsigned long long want = (unsigned long long)(p * h->n), seen = 0;
+  unsigned int i;
+
+  for (i = 0; i < NBUCKETS; i++) {
+    seen += h->count[i];
+    if (seen > want)
+      return bucket_value(i);
+  }
+  return h->max;
+}
+
+static void pin(unsigned int cpu)
+{
+#ifdef __linux__
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu % (unsigned int)sysconf(_SC_NPROCESSORS_ONLN), &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+/*
+ * perf counters, inherited by the threads created after they are opened
+ * and summed into them as those threads exit.
+ */
+enum counter { CACHE_MISSES, CONTEXT_SWITCHES, NCOUNTERS };
+
+static void counters_open(int *fd)
+{
+#ifdef __linux__
+  struct perf_event_attr attr;
+  int i;
+
+  for (i = 0; i < NCOUNTERS; i++) {
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = (i == CACHE_MISSES) ? PERF_TYPE_HARDWARE : PERF_TYPE_SOFTWARE;
+    attr.config = (i == CACHE_MISSES) ? PERF_COUNT_HW_CACHE_MISSES
+                                      : PERF_COUNT_SW_CONTEXT_SWITCHES;
+    attr.inherit = 1;
+    attr.exclude_kernel = (i == CACHE_MISSES);
+    attr.exclude_hv = 1;
+    fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+#else
+  fd[CACHE_MISSES] = fd[CONTEXT_SWITCHES] = -1;
+#endif
+}
+
+static void counters_close(int *fd, long long *value)
+{
+  int i;
+
+  for (i = 0; i < NCOUNTERS; i++) {
+    value[i] = -1;
+    if (fd[i] < 0)
+      continue;
+    if (read(fd[i], &value[i], sizeof(value[i])) != sizeof(value[i]))
+      value[i] = -1;
+    close(fd[i]);
+  }
+}
+
+/* The mutex wrapped list every variant is compared against. */
+static void sl_init(struct run *r)
+{
+  pthread_mutex_init(&r->lock, NULL);
+  ADT_sl_list_init(&r->list);
+}
+
+static void sl_enqueue(struct run *r, struct msg *m)
+{
+  pthread_mutex_lock(&r->lock);
+  ADT_sl_list_enqueue(&r->list, m);
+  pthread_mutex_unlock(&r->lock);
+}
+
+static struct msg *sl_dequeue(struct run *r)
+{
+  void *data = NULL;
+
+  pthread_mutex_lock(&r->lock);
+  if (ADT_sl_list_length(&r->list) != 0)
+    ADT_sl_list_dequeue(&r->list, &data);
+  pthread_mutex_unlock(&r->lock);
+  return (struct msg *)data;
+}
+
+static void sl_destroy(struct run *r)
+{
+  ADT_sl_list_destroy(&r->list, NULL);
+  pthread_mutex_destroy(&r->lock);
+}
+
+static void ms_init(struct run *r)
+{
+  ADT_ms_queue_init(&r->ms);
+}
+
+static void ms_enqueue(struct run *r, struct msg *m)
+{
+  ADT_ms_queue_enqueue(&r->ms, m);
+}
+
+static struct msg *ms_dequeue(struct run *r)
+{
+  void *data;
+
+  return (ADT_ms_queue_dequeue(&r->ms, &data) == 0) ? (struct msg *)data : NULL;
+}
+
+static void ms_destroy(struct run *r)
+{
+  ADT_ms_queue_destroy(&r->ms, NULL);
+  ADT_hp_drain();
+}
+
+static void mpsc_init(struct run *r)
+{
+  ADT_mpsc_queue_init(&r->mpsc);
+}
+
+static void mpsc_enqueue(struct run *r, struct msg *m)
+{
+  ADT_mpsc_queue_enqueue(&r->mpsc, &m->u.mpsc);
+}
+
+static struct msg *mpsc_dequeue(struct run *r)
+{
+  struct ADT_mpsc_link *link;
+
+  return (ADT_mpsc_queue_dequeue(&r->mpsc, &link) == 0) ? (struct msg *)link : NULL;
+}
+
+static void bq_init(struct run *r)
+{
+  ADT_bqueue_init(&r->bq, 0);
+}
+
+static void bq_enqueue(struct run *r, struct msg *m)
+{
+  ADT_bqueue_enqueue(&r->bq, &m->u.bq);
+}
+
+/* The one consumer sleeps instead of yielding. */
+static struct msg *bq_dequeue(struct run *r)
+{
+  struct ADT_bq_link *link;
+
+  ADT_bqueue_wait(&r->bq, -1);
+  return (ADT_bqueue_dequeue(&r->bq, &link) == 0) ? (struct msg *)link : NULL;
+}
+
+static void bq_destroy(struct run *r)
+{
+  ADT_bqueue_destroy(&r->bq);
+}
+
+static void nothing(struct run *r)
+{
+}
+
+static void pool_task(struct ADT_task *task)
+{
+  struct run *r = pool_run;
+
+  if (pool_hist == NULL)
+    pool_hist = &r->hists[atomic_fetch_add(&r->slots, 1) % r->consumers];
+  record(pool_hist, ((struct msg *)task)->stamp);
+  atomic_fetch_sub_explicit(&r->remaining, 1, memory_order_release);
+}
+
+static void pool_init(struct run *r)
+{
+  pool_run = r;
+  atomic_store(&r->slots, 0);
+  atomic_store(&r->remaining, (long)(r->producers * r->n));
+  ADT_tpool_init(&r->pool, r->consumers);
+}
+
+static void pool_enqueue(struct run *r, struct msg *m)
+{
+  m->u.task.fn = &pool_task;
+  ADT_tpool_submit(&r->pool, &m->u.task);
+}
+
+static void pool_destroy(struct run *r)
+{
+  ADT_tpool_destroy(&r->pool);
+}
+
+static const struct variant variants[] = {
+  { "sl_list_mutex", 0, &sl_init, &sl_enqueue, &sl_dequeue, &sl_destroy },
+  { "ms_queue", 0, &ms_init, &ms_enqueue, &ms_dequeue, &ms_destroy },
+  { "mpsc_queue", 1, &mpsc_init, &mpsc_enqueue, &mpsc_dequeue, &nothing },
+  { "bqueue", 1, &bq_init, &bq_enqueue, &bq_dequeue, &bq_destroy },
+  { "tpool", 0, &pool_init, &pool_enqueue, NULL, &pool_destroy },
+  { NULL, 0, NULL, NULL, NULL, NULL }
+};
+
+static void start(struct worker *w)
+{
+  if (w->run->pin)
+    pin(w->cpu);
+  atomic_fetch_add(&w->run->ready, 1);
+  while (!atomic_load_explicit(&w->run->go, memory_order_acquire))
+    ;
+}
+
+static void *produce(void *arg)
+{
+  struct worker *w = (struct worker *)arg;
+  size_t i;
+
+  start(w);
+  for (i = 0; i < w->run->n; i++) {
+    w->msgs[i].stamp = now_ns();
+    (*w->run->v->enqueue)(w->run, &w->msgs[i]);
+  }
+  return NULL;
+}
+
+/* Runs until it takes a stop message, which the queues hand out last. */
+static void *consume(void *arg)
+{
+  struct worker *w = (struct worker *)arg;
+  struct msg *m;
+
+  start(w);
+  for (;;) {
+    m = (*w->run->v->dequeue)(w->run);
+    if (m == NULL) {
+      sched_yield();
+      continue;
+    }
+    if (m->stamp == 0)
+      return NULL;
+    record(w->hist, m->stamp);
+  }
+}
+
+static void report(struct run *r, double secs, const long long *counter)
+{
+  struct hist total;
+  unsigned int c, i;
+
+  memset(&total, 0, sizeof(total));
+  for (c = 0; c < r->consumers; c++) {
+    for (i = 0; i < NBUCKETS; i++)
+      total.count[i] += r->hists[c].count[i];
+    total.n += r->hists[c].n;
+    if (r->hists[c].max > total.max)
+      total.max = r->hists[c].max;
+  }
+  if (json)
+    printf("%s\n  {\"variant\": \"%s\", \"producers\": %u, \"consumers\": %u, "
+           "\"msgs\": %llu, \"msgs_per_sec\": %.0f, \"p50_ns\": %llu, \"p99_ns\": %llu, "
+           "\"p999_ns\": %llu, \"max_ns\": %llu, \"cache_misses\": %lld, "
+           "\"context_switches\": %lld}",
+           records ? "," : "", r->v->name, r->producers, r->consumers, total.n,
+           total.n / secs, (unsigned long long)percentile(&total, 0.5),
+           (unsigned long long)percentile(&total, 0.99),
+           (unsigned long long)percentile(&total, 0.999), (unsigned long long)total.max,
+           counter[CACHE_MISSES], counter[CONTEXT_SWITCHES]);
+  else
+    printf("%s,%u,%u,%llu,%.0f,%llu,%llu,%llu,%llu,%lld,%lld\n", r->v->name, r->producers,
+           r->consumers, total.n, total.n / secs, (unsigned long long)percentile(&total, 0.5),
+           (unsigned long long)percentile(&total, 0.99),
+           (unsigned long long)percentile(&total, 0.999), (unsigned long long)total.max,
+           counter[CACHE_MISSES], counter[CONTEXT_SWITCHES]);
+  records++;
+  fflush(stdout);
+}
+
+static int run(struct run *r)
+{
+  struct worker w[2 * MAX_THREADS];
+  pthread_t threads[2 * MAX_THREADS];
+  struct msg *msgs, *stops;
+  unsigned int nthreads = 0, i;
+  long long counter[NCOUNTERS];
+  int fd[NCOUNTERS];
+  double begin, secs;
+
+  msgs = (struct msg *)malloc(r->producers * r->n * sizeof(struct msg));
+  stops = (struct msg *)calloc(r->consumers, sizeof(struct msg));
+  r->hists = (struct hist *)calloc(r->consumers, sizeof(struct hist));
+  if (msgs == NULL || stops == NULL || r->hists == NULL) {
+    free(msgs);
+    free(stops);
+    free(r->hists);
+    return -1;
+  }
+  atomic_store(&r->go, 0);
+  atomic_store(&r->ready, 0);
+  counters_open(fd);
+  (*r->v->init)(r);
+  for (i = 0; i < r->producers; i++, nthreads++) {
+    w[nthreads].run = r;
+    w[nthreads].cpu = i;
+    w[nthreads].msgs = msgs + i * r->n;
+    pthread_create(&threads[nthreads], NULL, &produce, &w[nthreads]);
+  }
+  for (i = 0; r->v->dequeue != NULL && i < r->consumers; i++, nthreads++) {
+    w[nthreads].run = r;
+    w[nthreads].cpu = r->producers + i;
+    w[nthreads].hist = &r->hists[i];
+    pthread_create(&threads[nthreads], NULL, &consume, &w[nthreads]);
+  }
+  while (atomic_load(&r->ready) < nthreads)
+    sched_yield();
+  begin = now_ns();
+  atomic_store_explicit(&r->go, 1, memory_order_release);
+
+  for (i = 0; i < r->producers; i++)
+    pthread_join(threads[i], NULL);
+  if (r->v->dequeue != NULL) {
+    for (i = 0; i < r->consumers; i++)
+      (*r->v->enqueue)(r, &stops[i]);
+    for (i = r->producers; i < nthreads; i++)
+      pthread_join(threads[i], NULL);
+  } else {
+    while (atomic_load_explicit(&r->remaining, memory_order_acquire) > 0)
+      sched_yield();
+  }
+  secs = (now_ns() - begin) / 1e9;
+  (*r->v->destroy)(r);
+  counters_close(fd, counter);
+  report(r, secs, counter);
+  free(msgs);
+  free(stops);
+  free(r->hists);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  struct run r;
+  const struct variant *v;
+  const char *only = NULL;
+  unsigned int max_producers = 4, max_consumers = 4;
+  int c;
+
+  memset(&r, 0, sizeof(r));
+  r.n = 100000;
+  while ((c = getopt(argc, argv, "jpn:P:C:v:")) != -1) {
+    switch (c) {
+    case 'j':
+      json = 1;
+      break;
+    case 'p':
+      r.pin = 1;
+      break;
+    case 'n':
+      r.n = strtoul(optarg, NULL, 10);
+      break;
+    case 'P':
+      max_producers = (unsigned int)strtoul(optarg, NULL, 10);
+      break;
+    case 'C':
+      max_consumers = (unsigned int)strtoul(optarg, NULL, 10);
+      break;
+    case 'v':
+      only = optarg;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-j] [-p] [-n msgs_per_producer] [-P producers] "
+              "[-C consumers] [-v variant]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (max_producers == 0 || max_producers > MAX_THREADS ||
+      max_consumers == 0 || max_consumers > MAX_THREADS) {
+    fprintf(stderr, "%s: producers and consumers must be 1 to %d\n", argv[0], MAX_THREADS);
+    return 1;
+  }
+
+  if (json)
+    printf("[");
+  else
+    printf("variant,producers,consumers,msgs,msgs_per_sec,p50_ns,p99_ns,p999_ns,max_ns,"
+           "cache_misses,context_switches\n");
+  for (v = variants; v->name != NULL; v++) {
+    if (only != NULL && strcmp(only, v->name) != 0)
+      continue;
+    r.v = v;
+    for (r.producers = 1; r.producers <= max_producers; r.producers *= 2) {
+      for (r.consumers = 1; r.consumers <= (v->single_consumer ? 1 : max_consumers);
+           r.consumers *= 2) {
+        if (run(&r) != 0) {
+          fprintf(stderr, "%s: out of memory\n", argv[0]);
+          return 1;
+        }
+      }
+    }
+  }
+  if (json)
+    printf("\n]\n");
+  return 0;
+}
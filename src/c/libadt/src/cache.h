@@ -0,0 +1,27 @@
+#ifndef _ADT_CACHE_H
+#define _ADT_CACHE_H
+
+/*******************************************************************************
+ * Cache geometry
+ */
+
+/* Keeps producer and consumer ends of a queue off each other's cache line. */
+#define ADT_CACHE_LINE 64
+
+/*
+ * Start pulling the line holding addr into cache without waiting for it.
+ * Traversals stay ADT_PREFETCH_DISTANCE nodes ahead of the node being
+ * visited.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define ADT_prefetch(addr) __builtin_prefetch(addr)
+#else
+#define ADT_prefetch(addr) ((void)(addr))
+#endif
+
+#ifndef ADT_PREFETCH_DISTANCE
+#define ADT_PREFETCH_DISTANCE 4
+#endif
+
+
+#endif
@@ -0,0 +1,491 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+  #include <linux/futex.h>
+  #include <sys/eventfd.h>
+  #include <sys/syscall.h>
+#endif
+#include "cqueue.h"
+#include "hazard.h"
+
+/* Polls of an empty ADT_bqueue before its consumer goes to sleep. */
+#define ADT_BQ_SPINS 128
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ADT_cpu_relax() __builtin_ia32_pause()
+#else
+#define ADT_cpu_relax() ((void)0)
+#endif
+
+/*
+ * Return a new initialized MPMC queue.
+ * Pre: q is a pointer to a newly created ADT_ms_queue.
+ * Post: q is empty. Nodes come from the library-wide allocator.
+ * Returns: 0 on success or -1 if the sentinel node cannot be allocated.
+ */
+int
+ADT_ms_queue_init(struct ADT_ms_queue *q)
+{
+  return ADT_ms_queue_init_alloc(q, ADT_get_allocator());
+}
+
+/*
+ * Return a new initialized MPMC queue whose nodes come from alloc.
+ * Pre: q is a pointer to a newly created ADT_ms_queue, and alloc is
+ *      thread-safe and outlives the queue and its retired nodes.
+ * Returns: 0 on success or -1 if the sentinel node cannot be allocated.
+ */
+int
+ADT_ms_queue_init_alloc(struct ADT_ms_queue *q, const struct ADT_allocator *alloc)
+{
+  struct ADT_ms_node *node;
+
+  node = (struct ADT_ms_node *)ADT_alloc(alloc, sizeof(struct ADT_ms_node));
+  if (node == NULL)
+    return -1;
+  atomic_init(&node->next, NULL);
+  node->data = NULL;
+  atomic_init(&q->head, node);
+  atomic_init(&q->tail, node);
+  q->alloc = alloc;
+  return 0;
+}
+
+/*
+ * Remove all items from q and call the designated destroy fn to free them.
+ * Pre: q must be an initialized ADT_ms_queue which no other thread is
+ *      using, and destroy a valid function for freeing queue data or NULL.
+ * Post: all nodes including the sentinel are freed. Nodes retired by other
+ *       threads are reclaimed by those threads' hazard pointer records.
+ */
+void
+ADT_ms_queue_destroy(struct ADT_ms_queue *q, void (*destroy)(void *))
+{
+  struct ADT_ms_node *node = atomic_load(&q->head), *next;
+
+  /* The head is the sentinel; its data has already been dequeued. */
+  next = atomic_load(&node->next);
+  ADT_free(q->alloc, node);
+  while (next != NULL) {
+    node = next;
+    next = atomic_load(&node->next);
+    if (destroy != NULL)
+      (*destroy)(node->data);
+    ADT_free(q->alloc, node);
+  }
+  atomic_store(&q->head, NULL);
+  atomic_store(&q->tail, NULL);
+}
+
+/*
+ * Insert data at the tail of q. Safe to call from any number of threads.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_ms_queue_enqueue(struct ADT_ms_queue *q, void *data)
+{
+  struct ADT_hp_rec *rec = ADT_hp_get();
+  struct ADT_ms_node *node, *tail, *next;
+
+  if (rec == NULL)
+    return -1;
+  node = (struct ADT_ms_node *)ADT_alloc(q->alloc, sizeof(struct ADT_ms_node));
+  if (node == NULL)
+    return -1;
+  node->data = data;
+  atomic_init(&node->next, NULL);
+  for (;;) {
+    tail = (struct ADT_ms_node *)ADT_hp_protect(rec, 0, (void *_Atomic *)&q->tail);
+    next = atomic_load(&tail->next);
+    if (tail != atomic_load(&q->tail))
+      continue;
+    if (next != NULL) {
+      /* Another enqueue linked its node but has not swung tail yet. */
+      atomic_compare_exchange_strong(&q->tail, &tail, next);
+      continue;
+    }
+    if (atomic_compare_exchange_strong(&tail->next, &next, node))
+      break;
+  }
+  atomic_compare_exchange_strong(&q->tail, &tail, node);
+  ADT_hp_clear(rec, 0);
+  return 0;
+}
+
+/*
+ * Remove data from the head of q. Safe to call from any number of threads.
+ * Post: on success data points to the oldest item in q.
+ * Returns: 0 on success or -1 if q is empty.
+ */
+int
+ADT_ms_queue_dequeue(struct ADT_ms_queue *q, void **data)
+{
+  struct ADT_hp_rec *rec = ADT_hp_get();
+  struct ADT_ms_node *head, *tail, *next;
+
+  if (rec == NULL)
+    return -1;
+  for (;;) {
+    head = (struct ADT_ms_node *)ADT_hp_protect(rec, 0, (void *_Atomic *)&q->head);
+    tail = atomic_load(&q->tail);
+    next = (struct ADT_ms_node *)ADT_hp_protect(rec, 1, (void *_Atomic *)&head->next);
+    if (head != atomic_load(&q->head))
+      continue;
+    if (next == NULL) {
+      ADT_hp_clear(rec, 0);
+      ADT_hp_clear(rec, 1);
+      return -1;
+    }
+    if (head == tail) {
+      atomic_compare_exchange_strong(&q->tail, &tail, next);
+      continue;
+    }
+    /* next becomes the new sentinel, so its data must be read first. */
+    *data = next->data;
+    if (atomic_compare_exchange_strong(&q->head, &head, next))
+      break;
+  }
+  ADT_hp_clear(rec, 0);
+  ADT_hp_clear(rec, 1);
+  ADT_hp_retire(rec, head, q->alloc);
+  return 0;
+}
+
+/*
+ * Return a new initialized MPSC queue.
+ * Pre: q is a pointer to a newly created ADT_mpsc_queue.
+ * Post: q is empty; its embedded stub link is the only one on it.
+ */
+void
+ADT_mpsc_queue_init(struct ADT_mpsc_queue *q)
+{
+  atomic_init(&q->stub.next, NULL);
+  atomic_init(&q->head, &q->stub);
+  q->tail = &q->stub;
+}
+
+/*
+ * Link link in at the end of q. Safe to call from any number of threads.
+ * Pre: link must not currently be on any queue.
+ */
+void
+ADT_mpsc_queue_enqueue(struct ADT_mpsc_queue *q, struct ADT_mpsc_link *link)
+{
+  struct ADT_mpsc_link *prev;
+
+  atomic_store_explicit(&link->next, NULL, memory_order_relaxed);
+  prev = atomic_exchange_explicit(&q->head, link, memory_order_acq_rel);
+  atomic_store_explicit(&prev->next, link, memory_order_release);
+}
+
+/*
+ * Unlink the oldest link of q. Only one thread may dequeue at a time.
+ * Post: on success link points to the unlinked link, which the caller owns.
+ * Returns: 0 on success or -1 if q is empty. -1 is also returned while a
+ *          producer is between its exchange and its link; retry later.
+ */
+int
+ADT_mpsc_queue_dequeue(struct ADT_mpsc_queue *q, struct ADT_mpsc_link **link)
+{
+  struct ADT_mpsc_link *tail = q->tail, *next, *head;
+
+  next = atomic_load_explicit(&tail->next, memory_order_acquire);
+  if (tail == &q->stub) {
+    if (next == NULL)
+      return -1;
+    q->tail = next;
+    tail = next;
+    next = atomic_load_explicit(&next->next, memory_order_acquire);
+  }
+  if (next != NULL) {
+    q->tail = next;
+    *link = tail;
+    return 0;
+  }
+  head = atomic_load_explicit(&q->head, memory_order_acquire);
+  if (tail != head)
+    return -1;
+  /* tail is the last link: put the stub behind it so tail can be taken. */
+  ADT_mpsc_queue_enqueue(q, &q->stub);
+  next = atomic_load_explicit(&tail->next, memory_order_acquire);
+  if (next == NULL)
+    return -1;
+  q->tail = next;
+  *link = tail;
+  return 0;
+}
+
+/*
+ * Return a new initialized blocking queue.
+ * Pre: q is a pointer to a newly created ADT_bqueue. flags is 0 or
+ *      ADT_BQ_EVENTFD to have the queue signal an eventfd.
+ * Post: q is empty.
+ * Returns: 0 on success or -1 with errno set if the eventfd cannot be
+ *          created, or ENOSYS where there is no eventfd.
+ */
+int
+ADT_bqueue_init(struct ADT_bqueue *q, int flags)
+{
+  q->efd = -1;
+  if (flags & ADT_BQ_EVENTFD) {
+#ifdef __linux__
+    q->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (q->efd < 0)
+      return -1;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+  }
+  atomic_init(&q->pending, NULL);
+  atomic_init(&q->seq, 0);
+  atomic_init(&q->waiters, 0);
+  q->batch = NULL;
+#ifndef __linux__
+  pthread_mutex_init(&q->lock, NULL);
+  pthread_cond_init(&q->wake, NULL);
+#endif
+  return 0;
+}
+
+/*
+ * Release q and its eventfd. Links still on q are left to their owner.
+ * Pre: q must be a pointer to an initialized ADT_bqueue nobody is using.
+ */
+void
+ADT_bqueue_destroy(struct ADT_bqueue *q)
+{
+  if (q->efd >= 0)
+    close(q->efd);
+  q->efd = -1;
+#ifndef __linux__
+  pthread_mutex_destroy(&q->lock);
+  pthread_cond_destroy(&q->wake);
+#endif
+}
+
+/* Wake the consumer sleeping in ADT_bqueue_wait. */
+static void
+ADT_bq_wake(struct ADT_bqueue *q)
+{
+#ifdef __linux__
+  atomic_fetch_add(&q->seq, 1);
+  syscall(SYS_futex, (uint32_t *)&q->seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+  pthread_mutex_lock(&q->lock);
+  atomic_fetch_add(&q->seq, 1);
+  pthread_cond_broadcast(&q->wake);
+  pthread_mutex_unlock(&q->lock);
+#endif
+}
+
+/*
+ * Sleep until q->seq moves on from seen, deadline passes or, on Linux, a
+ * spurious wakeup. Returns: -1 if deadline has passed, else 0.
+ */
+static int
+ADT_bq_sleep(struct ADT_bqueue *q, unsigned int seen, const struct timespec *deadline)
+{
+#ifdef __linux__
+  struct timespec now, rel, *timeout = NULL;
+
+  if (deadline != NULL) {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    rel.tv_sec = deadline->tv_sec - now.tv_sec;
+    rel.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+    if (rel.tv_nsec < 0) {
+      rel.tv_sec--;
+      rel.tv_nsec += 1000000000L;
+    }
+    if (rel.tv_sec < 0)
+      return -1;
+    timeout = &rel;
+  }
+  syscall(SYS_futex, (uint32_t *)&q->seq, FUTEX_WAIT_PRIVATE, seen, timeout, NULL, 0);
+  return 0;
+#else
+  int rc = 0;
+
+  pthread_mutex_lock(&q->lock);
+  while (rc == 0 && atomic_load(&q->seq) == seen) {
+    if (deadline == NULL)
+      pthread_cond_wait(&q->wake, &q->lock);
+    else if (pthread_cond_timedwait(&q->wake, &q->lock, deadline) == ETIMEDOUT)
+      rc = -1;
+  }
+  pthread_mutex_unlock(&q->lock);
+  return rc;
+#endif
+}
+
+/*
+ * Push link onto q. Safe to call from any number of threads; costs a
+ * system call only while the consumer sleeps, or for the eventfd when q
+ * had nothing pending.
+ * Pre: link must not currently be on any queue.
+ */
+void
+ADT_bqueue_enqueue(struct ADT_bqueue *q, struct ADT_bq_link *link)
+{
+  struct ADT_bq_link *prev = atomic_load_explicit(&q->pending, memory_order_relaxed);
+#ifdef __linux__
+  uint64_t one = 1;
+#endif
+
+  do {
+    link->next = prev;
+  } while (!atomic_compare_exchange_weak(&q->pending, &prev, link));
+#ifdef __linux__
+  if (prev == NULL && q->efd >= 0 && write(q->efd, &one, sizeof(one)) < 0) {
+    /* Only fails when the counter is saturated, so it is readable anyway. */
+  }
+#endif
+  /* Pairs with the waiter's increment before it rechecks q. */
+  if (atomic_load(&q->waiters) > 0)
+    ADT_bq_wake(q);
+}
+
+/* Take the pending chain, oldest link first. */
+static struct ADT_bq_link *
+ADT_bq_take(struct ADT_bqueue *q)
+{
+  struct ADT_bq_link *chain, *next, *fifo = NULL;
+
+  chain = atomic_exchange_explicit(&q->pending, NULL, memory_order_acquire);
+  for (; chain != NULL; chain = next) {
+    next = chain->next;
+    chain->next = fifo;
+    fifo = chain;
+  }
+  return fifo;
+}
+
+/*
+ * Unlink the oldest link of q without blocking. Only one thread may
+ * dequeue at a time.
+ * Post: on success link points to the unlinked link, which the caller owns.
+ * Returns: 0 on success or -1 if q is empty.
+ */
+int
+ADT_bqueue_dequeue(struct ADT_bqueue *q, struct ADT_bq_link **link)
+{
+  if (q->batch == NULL) {
+    q->batch = ADT_bq_take(q);
+    if (q->batch == NULL)
+      return -1;
+  }
+  *link = q->batch;
+  q->batch = q->batch->next;
+  return 0;
+}
+
+/*
+ * Unlink every link of q at once, with a single exchange for everything
+ * enqueued since the last call. Only one thread may dequeue at a time.
+ * Returns: the oldest link, chained through next in enqueue order to a
+ *          NULL terminated end, or NULL if q is empty.
+ */
+struct ADT_bq_link *
+ADT_bqueue_dequeue_all(struct ADT_bqueue *q)
+{
+  struct ADT_bq_link *first = q->batch, *last;
+
+  q->batch = NULL;
+  if (first == NULL)
+    return ADT_bq_take(q);
+  for (last = first; last->next != NULL; last = last->next)
+    ;
+  last->next = ADT_bq_take(q);
+  return first;
+}
+
+static inline int
+ADT_bq_ready(struct ADT_bqueue *q)
+{
+  return q->batch != NULL || atomic_load(&q->pending) != NULL;
+}
+
+/*
+ * Block the consumer until q has a link to dequeue, spinning briefly
+ * before it sleeps. timeout_ms bounds the wait as for poll: negative waits
+ * forever and 0 just checks.
+ * Pre: only the dequeuing thread may wait on q.
+ * Returns: 0 once q is not empty or -1 with errno ETIMEDOUT.
+ */
+int
+ADT_bqueue_wait(struct ADT_bqueue *q, int timeout_ms)
+{
+  struct timespec deadline;
+  unsigned int seen;
+  int i, rc;
+
+  for (i = 0; i < ADT_BQ_SPINS && timeout_ms != 0; i++) {
+    if (ADT_bq_ready(q))
+      return 0;
+    ADT_cpu_relax();
+  }
+  if (timeout_ms == 0) {
+    if (ADT_bq_ready(q))
+      return 0;
+    errno = ETIMEDOUT;
+    return -1;
+  }
+  if (timeout_ms > 0) {
+#ifdef __linux__
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+#else
+    clock_gettime(CLOCK_REALTIME, &deadline);
+#endif
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+  }
+  for (;;) {
+    seen = atomic_load(&q->seq);
+    atomic_fetch_add(&q->waiters, 1);
+    if (ADT_bq_ready(q)) {
+      atomic_fetch_sub(&q->waiters, 1);
+      return 0;
+    }
+    rc = ADT_bq_sleep(q, seen, (timeout_ms > 0) ? &deadline : NULL);
+    atomic_fetch_sub(&q->waiters, 1);
+    if (ADT_bq_ready(q))
+      return 0;
+    if (rc != 0) {
+      errno = ETIMEDOUT;
+      return -1;
+    }
+  }
+}
+
+/*
+ * Return the eventfd of q for the caller's event loop to poll, or -1 if q
+ * was initialized without ADT_BQ_EVENTFD. q keeps ownership of it.
+ */
+int
+ADT_bqueue_eventfd(struct ADT_bqueue *q)
+{
+  return q->efd;
+}
+
+/*
+ * Reset the eventfd of q after it polled readable. Call it before draining
+ * q, so an enqueue racing with the drain leaves the eventfd readable again.
+ */
+void
+ADT_bqueue_eventfd_ack(struct ADT_bqueue *q)
+{
+#ifdef __linux__
+  uint64_t count;
+
+  if (q->efd >= 0 && read(q->efd, &count, sizeof(count)) < 0) {
+    /* EAGAIN: nothing was signalled. */
+  }
+#endif
+}
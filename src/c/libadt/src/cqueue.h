@@ -0,0 +1,106 @@
+#ifndef _ADT_CQUEUE_H
+#define _ADT_CQUEUE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#ifndef __linux__
+  #include <pthread.h>
+#endif
+#include "alloc.h"
+#include "cache.h"
+
+/*******************************************************************************
+ * Lock-free multi producer, multi consumer queue (Michael & Scott)
+ *
+ * Thread-safe counterpart of ADT_sl_list_enqueue/ADT_sl_list_dequeue.
+ * Dequeued nodes are retired through the hazard pointer domain and only go
+ * back to the queue's allocator, which must be thread-safe, once no other
+ * thread can still be reading them.
+ */
+
+struct ADT_ms_node {
+  struct ADT_ms_node *_Atomic next;
+  void *data;
+};
+
+struct ADT_ms_queue {
+  _Alignas(ADT_CACHE_LINE) struct ADT_ms_node *_Atomic head;
+  _Alignas(ADT_CACHE_LINE) struct ADT_ms_node *_Atomic tail;
+  const struct ADT_allocator *alloc;    /* node source */
+};
+
+int ADT_ms_queue_init(struct ADT_ms_queue *);
+int ADT_ms_queue_init_alloc(struct ADT_ms_queue *, const struct ADT_allocator *);
+void ADT_ms_queue_destroy(struct ADT_ms_queue *, void (*destroy)(void *));
+int ADT_ms_queue_enqueue(struct ADT_ms_queue *, void *);
+int ADT_ms_queue_dequeue(struct ADT_ms_queue *, void **);
+
+/*******************************************************************************
+ * Intrusive multi producer, single consumer queue (Vyukov)
+ *
+ * Producers never block each other: an enqueue is one atomic exchange. The
+ * caller embeds a struct ADT_mpsc_link in its own structure. Ownership of a
+ * link passes back to the consumer as soon as it is dequeued, since no
+ * producer touches a link once its successor is published, so no deferred
+ * reclamation is needed.
+ */
+
+struct ADT_mpsc_link {
+  struct ADT_mpsc_link *_Atomic next;
+};
+
+struct ADT_mpsc_queue {
+  _Alignas(ADT_CACHE_LINE) struct ADT_mpsc_link *_Atomic head;  /* producers */
+  _Alignas(ADT_CACHE_LINE) struct ADT_mpsc_link *tail;          /* consumer */
+  struct ADT_mpsc_link stub;
+};
+
+void ADT_mpsc_queue_init(struct ADT_mpsc_queue *);
+void ADT_mpsc_queue_enqueue(struct ADT_mpsc_queue *, struct ADT_mpsc_link *);
+int ADT_mpsc_queue_dequeue(struct ADT_mpsc_queue *, struct ADT_mpsc_link **);
+
+/*******************************************************************************
+ * Blocking multi producer, single consumer queue
+ *
+ * An intrusive queue the consumer can sleep on instead of polling. An
+ * enqueue pushes the link onto a pending chain with one compare and swap,
+ * and the consumer takes the whole chain with one exchange, reversing it
+ * into enqueue order; ADT_bqueue_dequeue hands out such a batch a link at
+ * a time. ADT_bqueue_wait spins briefly, then sleeps on a futex (a condition
+ * variable off Linux) that enqueues only touch while a consumer is asleep.
+ *
+ * With ADT_BQ_EVENTFD the queue also owns an eventfd, which becomes
+ * readable when an enqueue finds the pending chain empty, so an epoll or
+ * io_uring loop can drive the consumer: on readiness call
+ * ADT_bqueue_eventfd_ack, then drain with ADT_bqueue_dequeue_all.
+ */
+
+#define ADT_BQ_EVENTFD 1                /* init flags */
+
+struct ADT_bq_link {
+  struct ADT_bq_link *next;
+};
+
+struct ADT_bqueue {
+  _Alignas(ADT_CACHE_LINE) struct ADT_bq_link *_Atomic pending;  /* producers */
+  atomic_uint seq;                      /* futex word, bumped to wake */
+  atomic_int waiters;
+  int efd;                              /* eventfd or -1 */
+  _Alignas(ADT_CACHE_LINE) struct ADT_bq_link *batch;           /* consumer */
+#ifndef __linux__
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+#endif
+};
+
+int ADT_bqueue_init(struct ADT_bqueue *, int);
+void ADT_bqueue_destroy(struct ADT_bqueue *);
+void ADT_bqueue_enqueue(struct ADT_bqueue *, struct ADT_bq_link *);
+int ADT_bqueue_dequeue(struct ADT_bqueue *, struct ADT_bq_link **);
+struct ADT_bq_link *ADT_bqueue_dequeue_all(struct ADT_bqueue *);
+int ADT_bqueue_wait(struct ADT_bqueue *, int);
+int ADT_bqueue_eventfd(struct ADT_bqueue *);
+void ADT_bqueue_eventfd_ack(struct ADT_bqueue *);
+
+
+#endif
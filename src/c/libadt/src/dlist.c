@@ -0,0 +1,449 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "dlist.h"
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+/*
+ * Return a new initialized Double Linked List.
+ * Pre: list is a pointer to a newly created ADT_dl_list.
+ * Post: list's head and tail will be set to NULL. The length
+ * list will be zero. Nodes come from the library-wide allocator.
+ */
+void
+ADT_dl_list_init(struct ADT_dl_list *list)
+{
+  ADT_dl_list_init_alloc(list, ADT_get_allocator());
+}
+
+/*
+ * Return a new initialized Double Linked List whose nodes come from alloc.
+ * Pre: list is a pointer to a newly created ADT_dl_list, and alloc must
+ *      outlive the list.
+ */
+void
+ADT_dl_list_init_alloc(struct ADT_dl_list *list, const struct ADT_allocator *alloc)
+{
+  list->head = NULL;
+  list->tail = NULL;
+  list->len = 0;
+  list->alloc = alloc;
+}
+
+/*
+ * Return a new initialized Double Linked List whose nodes come from pool.
+ * Pre: list is a pointer to a newly created ADT_dl_list, and pool is an
+ *      ADT_pool initialized with ADT_dl_pool_init. The pool may be shared
+ *      with other lists and must outlive all of them.
+ */
+void
+ADT_dl_list_init_pooled(struct ADT_dl_list *list, struct ADT_pool *pool)
+{
+  ADT_dl_list_init_alloc(list, &pool->allocator);
+}
+
+/*
+ * Initialize pool for handing out ADT_dl_node structures, per_chunk nodes
+ * to a chunk.
+ * Returns: 0 on success or -1 if per_chunk is zero.
+ */
+int
+ADT_dl_pool_init(struct ADT_pool *pool, unsigned int per_chunk)
+{
+  return ADT_pool_init(pool, sizeof(struct ADT_dl_node), per_chunk);
+}
+
+/*
+ * Remove all items from list and call the designated destroy fn
+ * to free list data.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure,
+ *      and destroy must be valid function for freeing list data or NULL
+ *      if the list does not own its data.
+ * Post: list nodes are all destroyed. list head and tail are set
+ *       to NULL.
+ */
+void
+ADT_dl_list_destroy(struct ADT_dl_list *list, void (*destroy)(void *))
+{
+  struct ADT_dl_node *node;
+
+  if (destroy == NULL && list->alloc->free == NULL)
+    list->head = NULL;
+  while (list->head != NULL) {
+    node = list->head;
+    list->head = node->next;
+    if (destroy != NULL)
+      (*destroy)(node->data);
+    ADT_canary_check(node);
+    ADT_poison(node);
+    ADT_free(list->alloc, node);
+  }
+  list->tail = NULL;
+  list->len = 0;
+}
+
+static struct ADT_dl_node *
+ADT_dl_node_alloc(struct ADT_dl_list *list, void *data)
+{
+  struct ADT_dl_node *node;
+
+  node = (struct ADT_dl_node *)ADT_alloc(list->alloc, sizeof(struct ADT_dl_node));
+  if (node != NULL) {
+    node->data = data;
+    ADT_canary_arm(node);
+  }
+  return node;
+}
+
+/* Link node in between prev and next, either of which may be NULL. */
+static void
+ADT_dl_list_link(struct ADT_dl_list *list, struct ADT_dl_node *prev,
+                 struct ADT_dl_node *node, struct ADT_dl_node *next)
+{
+  node->prev = prev;
+  node->next = next;
+  if (prev != NULL)
+    prev->next = node;
+  else
+    list->head = node;
+  if (next != NULL)
+    next->prev = node;
+  else
+    list->tail = node;
+  list->len++;
+}
+
+static void
+ADT_dl_list_unlink(struct ADT_dl_list *list, struct ADT_dl_node *node)
+{
+  ADT_canary_check(node);
+  if (node->prev != NULL)
+    node->prev->next = node->next;
+  else
+    list->head = node->next;
+  if (node->next != NULL)
+    node->next->prev = node->prev;
+  else
+    list->tail = node->prev;
+  list->len--;
+}
+
+/*
+ * Insert data at the head of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure.
+ * Post: data is the first element of list, and the list length will be
+ *       increased by one.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_dl_list_push(struct ADT_dl_list *list, void *data)
+{
+  struct ADT_dl_node *node = ADT_dl_node_alloc(list, data);
+
+  if (node == NULL)
+    return -1;
+  ADT_dl_list_link(list, NULL, node, list->head);
+  return 0;
+}
+
+/*
+ * Insert data at the end of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure.
+ * Post: data is the last element of list, and the list length will be
+ *       increased by one.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_dl_list_append(struct ADT_dl_list *list, void *data)
+{
+  struct ADT_dl_node *node = ADT_dl_node_alloc(list, data);
+
+  if (node == NULL)
+    return -1;
+  ADT_dl_list_link(list, list->tail, node, NULL);
+  return 0;
+}
+
+/*
+ * Remove the head of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure with
+ *      at least one element.
+ * Post: data points to the data of the former head, which is freed.
+ */
+void
+ADT_dl_list_pop(struct ADT_dl_list *list, void **data)
+{
+  ADT_check(list->len != 0, "pop from an empty list");
+  ADT_dl_list_remove(list, list->head, data);
+}
+
+/*
+ * Remove the tail of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure with
+ *      at least one element.
+ * Post: data points to the data of the former tail, which is freed.
+ */
+void
+ADT_dl_list_pop_tail(struct ADT_dl_list *list, void **data)
+{
+  ADT_check(list->len != 0, "pop from an empty list");
+  ADT_dl_list_remove(list, list->tail, data);
+}
+
+/*
+ * Insert data directly after loc.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure, and
+ *      loc *must* be a pointer to an actual node of list.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_dl_list_insert_after(struct ADT_dl_list *list, struct ADT_dl_node *loc, void *data)
+{
+  struct ADT_dl_node *node = ADT_dl_node_alloc(list, data);
+
+  ADT_canary_check(loc);
+  if (node == NULL)
+    return -1;
+  ADT_dl_list_link(list, loc, node, loc->next);
+  return 0;
+}
+
+/*
+ * Insert data directly before loc.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure, and
+ *      loc *must* be a pointer to an actual node of list.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_dl_list_insert_before(struct ADT_dl_list *list, struct ADT_dl_node *loc, void *data)
+{
+  struct ADT_dl_node *node = ADT_dl_node_alloc(list, data);
+
+  ADT_canary_check(loc);
+  if (node == NULL)
+    return -1;
+  ADT_dl_list_link(list, loc->prev, node, loc);
+  return 0;
+}
+
+/*
+ * Remove node from list in constant time.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure, and
+ *      node *must* be a pointer to an actual node of list.
+ * Post: data, unless NULL, points to the data of node, which is freed.
+ */
+void
+ADT_dl_list_remove(struct ADT_dl_list *list, struct ADT_dl_node *node, void **data)
+{
+  ADT_dl_list_unlink(list, node);
+  if (data != NULL)
+    *data = node->data;
+  ADT_poison(node);
+  ADT_free(list->alloc, node);
+}
+
+/*
+ * Make node the head of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure, and
+ *      node *must* be a pointer to an actual node of list.
+ */
+void
+ADT_dl_list_move_to_front(struct ADT_dl_list *list, struct ADT_dl_node *node)
+{
+  if (node == list->head)
+    return;
+  ADT_dl_list_unlink(list, node);
+  ADT_dl_list_link(list, NULL, node, list->head);
+}
+
+/*
+ * Make node the tail of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure, and
+ *      node *must* be a pointer to an actual node of list.
+ */
+void
+ADT_dl_list_move_to_back(struct ADT_dl_list *list, struct ADT_dl_node *node)
+{
+  if (node == list->tail)
+    return;
+  ADT_dl_list_unlink(list, node);
+  ADT_dl_list_link(list, list->tail, node, NULL);
+}
+
+/*
+ * Return the number of elements in list.
+ * Pre: list must be a pointer to an initialized ADT_dl_list structure.
+ */
+unsigned int
+ADT_dl_list_length(struct ADT_dl_list *list)
+{
+  return list->len;
+}
+
+/*
+ * Return a new initialized Intrusive Double Linked List.
+ * Pre: list is a pointer to a newly created ADT_dl_ilist.
+ * Post: list's head and tail will be set to NULL. The length
+ * list will be zero.
+ */
+void
+ADT_dl_ilist_init(struct ADT_dl_ilist *list)
+{
+  list->head = NULL;
+  list->tail = NULL;
+  list->len = 0;
+}
+
+static void
+ADT_dl_ilist_link(struct ADT_dl_ilist *list, struct ADT_dl_link *prev,
+                  struct ADT_dl_link *link, struct ADT_dl_link *next)
+{
+  link->prev = prev;
+  link->next = next;
+  if (prev != NULL)
+    prev->next = link;
+  else
+    list->head = link;
+  if (next != NULL)
+    next->prev = link;
+  else
+    list->tail = link;
+  list->len++;
+}
+
+/*
+ * Link link in at the head of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_ilist structure, and
+ *      link must not currently be on any list.
+ */
+void
+ADT_dl_ilist_push(struct ADT_dl_ilist *list, struct ADT_dl_link *link)
+{
+  ADT_dl_ilist_link(list, NULL, link, list->head);
+}
+
+/*
+ * Link link in at the end of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_ilist structure, and
+ *      link must not currently be on any list.
+ */
+void
+ADT_dl_ilist_append(struct ADT_dl_ilist *list, struct ADT_dl_link *link)
+{
+  ADT_dl_ilist_link(list, list->tail, link, NULL);
+}
+
+/*
+ * Unlink the head of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_ilist structure with
+ *      at least one element.
+ * Post: link points to the former head, whose links are cleared.
+ */
+void
+ADT_dl_ilist_pop(struct ADT_dl_ilist *list, struct ADT_dl_link **link)
+{
+  ADT_check(list->len != 0, "pop from an empty list");
+  *link = list->head;
+  ADT_dl_ilist_remove(list, *link);
+}
+
+/*
+ * Unlink the tail of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_ilist structure with
+ *      at least one element.
+ * Post: link points to the former tail, whose links are cleared.
+ */
+void
+ADT_dl_ilist_pop_tail(struct ADT_dl_ilist *list, struct ADT_dl_link **link)
+{
+  ADT_check(list->len != 0, "pop from an empty list");
+  *link = list->tail;
+  ADT_dl_ilist_remove(list, *link);
+}
+
+/*
+ * Link link in directly after loc.
+ * Pre: list must be a pointer to an initialized ADT_dl_ilist structure, loc
+ *      *must* be a link of list, and link must not be on any list.
+ */
+void
+ADT_dl_ilist_insert_after(struct ADT_dl_ilist *list, struct ADT_dl_link *loc,
+                          struct ADT_dl_link *link)
+{
+  ADT_dl_ilist_link(list, loc, link, loc->next);
+}
+
+/*
+ * Link link in directly before loc.
+ * Pre: list must be a pointer to an initialized ADT_dl_ilist structure, loc
+ *      *must* be a link of list, and link must not be on any list.
+ */
+void
+ADT_dl_ilist_insert_before(struct ADT_dl_ilist *list, struct ADT_dl_link *loc,
+                           struct ADT_dl_link *link)
+{
+  ADT_dl_ilist_link(list, loc->prev, link, loc);
+}
+
+/*
+ * Unlink link from list in constant time.
+ * Pre: list must be a pointer to an initialized ADT_dl_ilist structure, and
+ *      link *must* be a link of list.
+ * Post: link is off the list and its links are cleared.
+ */
+void
+ADT_dl_ilist_remove(struct ADT_dl_ilist *list, struct ADT_dl_link *link)
+{
+  /* Removal clears the links, so a link removed twice is caught here. */
+  ADT_check(link->prev != NULL || list->head == link, "remove of a link not on the list");
+  if (link->prev != NULL)
+    link->prev->next = link->next;
+  else
+    list->head = link->next;
+  if (link->next != NULL)
+    link->next->prev = link->prev;
+  else
+    list->tail = link->prev;
+  link->next = NULL;
+  link->prev = NULL;
+  list->len--;
+}
+
+/*
+ * Make link the head of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_ilist structure, and
+ *      link *must* be a link of list.
+ */
+void
+ADT_dl_ilist_move_to_front(struct ADT_dl_ilist *list, struct ADT_dl_link *link)
+{
+  if (link == list->head)
+    return;
+  ADT_dl_ilist_remove(list, link);
+  ADT_dl_ilist_link(list, NULL, link, list->head);
+}
+
+/*
+ * Make link the tail of list.
+ * Pre: list must be a pointer to an initialized ADT_dl_ilist structure, and
+ *      link *must* be a link of list.
+ */
+void
+ADT_dl_ilist_move_to_back(struct ADT_dl_ilist *list, struct ADT_dl_link *link)
+{
+  if (link == list->tail)
+    return;
+  ADT_dl_ilist_remove(list, link);
+  ADT_dl_ilist_link(list, list->tail, link, NULL);
+}
+
+/*
+ * Return the number of links in list.
+ * Pre: list must be a pointer to an initialized ADT_dl_ilist structure.
+ */
+unsigned int
+ADT_dl_ilist_length(struct ADT_dl_ilist *list)
+{
+  return list->len;
+}
@@ -0,0 +1,95 @@
+#ifndef _ADT_DLIST_H
+#define _ADT_DLIST_H
+
+#include "alloc.h"
+#include "harden.h"
+#include "pool.h"
+#include "list.h"
+
+/*******************************************************************************
+ * Double linked list
+ *
+ * Every node also links to its predecessor, so a node known to the caller
+ * can be removed or moved to either end in constant time. head->prev and
+ * tail->next are NULL.
+ */
+
+struct ADT_dl_node {
+  struct ADT_dl_node *next;
+  struct ADT_dl_node *prev;
+  void *data;
+#if ADT_HARDEN > 1
+  uintptr_t canary;
+#endif
+};
+
+struct ADT_dl_list {
+  struct ADT_dl_node *head;
+  struct ADT_dl_node *tail;
+  unsigned int len;
+  const struct ADT_allocator *alloc;    /* node source */
+};
+
+void ADT_dl_list_init(struct ADT_dl_list *);
+void ADT_dl_list_init_alloc(struct ADT_dl_list *, const struct ADT_allocator *);
+void ADT_dl_list_init_pooled(struct ADT_dl_list *, struct ADT_pool *);
+int ADT_dl_pool_init(struct ADT_pool *, unsigned int);
+void ADT_dl_list_destroy(struct ADT_dl_list *, void (*destroy)(void *));
+int ADT_dl_list_push(struct ADT_dl_list *, void *);
+int ADT_dl_list_append(struct ADT_dl_list *, void *);
+void ADT_dl_list_pop(struct ADT_dl_list *, void **);
+void ADT_dl_list_pop_tail(struct ADT_dl_list *, void **);
+int ADT_dl_list_insert_after(struct ADT_dl_list *, struct ADT_dl_node *, void *);
+int ADT_dl_list_insert_before(struct ADT_dl_list *, struct ADT_dl_node *, void *);
+void ADT_dl_list_remove(struct ADT_dl_list *, struct ADT_dl_node *, void **);
+void ADT_dl_list_move_to_front(struct ADT_dl_list *, struct ADT_dl_node *);
+void ADT_dl_list_move_to_back(struct ADT_dl_list *, struct ADT_dl_node *);
+unsigned int ADT_dl_list_length(struct ADT_dl_list *);
+#define ADT_dl_list_enqueue(list, data) ADT_dl_list_append(list, data)
+#define ADT_dl_list_dequeue(list, data) ADT_dl_list_pop(list, data)
+#define ADT_dl_list_foreach(list, node) \
+  for ((node) = (list)->head; (node) != NULL; (node) = (node)->next)
+#define ADT_dl_list_foreach_reverse(list, node) \
+  for ((node) = (list)->tail; (node) != NULL; (node) = (node)->prev)
+
+/*******************************************************************************
+ * Intrusive double linked list
+ *
+ * As the intrusive single linked list: the caller embeds a struct
+ * ADT_dl_link and no operation allocates. ADT_dl_ilist_entry maps a link
+ * back to the structure containing it.
+ */
+
+#define ADT_dl_ilist_entry(link, type, member) ADT_container_of(link, type, member)
+
+struct ADT_dl_link {
+  struct ADT_dl_link *next;
+  struct ADT_dl_link *prev;
+};
+
+struct ADT_dl_ilist {
+  struct ADT_dl_link *head;
+  struct ADT_dl_link *tail;
+  unsigned int len;
+};
+
+void ADT_dl_ilist_init(struct ADT_dl_ilist *);
+void ADT_dl_ilist_push(struct ADT_dl_ilist *, struct ADT_dl_link *);
+void ADT_dl_ilist_append(struct ADT_dl_ilist *, struct ADT_dl_link *);
+void ADT_dl_ilist_pop(struct ADT_dl_ilist *, struct ADT_dl_link **);
+void ADT_dl_ilist_pop_tail(struct ADT_dl_ilist *, struct ADT_dl_link **);
+void ADT_dl_ilist_insert_after(struct ADT_dl_ilist *, struct ADT_dl_link *, struct ADT_dl_link *);
+void ADT_dl_ilist_insert_before(struct ADT_dl_ilist *, struct ADT_dl_link *, struct ADT_dl_link *);
+void ADT_dl_ilist_remove(struct ADT_dl_ilist *, struct ADT_dl_link *);
+void ADT_dl_ilist_move_to_front(struct ADT_dl_ilist *, struct ADT_dl_link *);
+void ADT_dl_ilist_move_to_back(struct ADT_dl_ilist *, struct ADT_dl_link *);
+unsigned int ADT_dl_ilist_length(struct ADT_dl_ilist *);
+#define ADT_dl_ilist_enqueue(list, link) ADT_dl_ilist_append(list, link)
+#define ADT_dl_ilist_dequeue(list, link) ADT_dl_ilist_pop(list, link)
+#define ADT_dl_ilist_foreach(list, link) \
+  for ((link) = (list)->head; (link) != NULL; (link) = (link)->next)
+#define ADT_dl_ilist_foreach_reverse(list, link) \
+  for ((link) = (list)->tail; (link) != NULL; (link) = (link)->prev)
+
+
+#endif
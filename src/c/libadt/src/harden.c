@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "harden.h"
+
+static void (*ADT_harden_handler)(const char *, const char *, int) = NULL;
+
+/*
+ * Report a failed check and abort: through the handler set with
+ * ADT_set_harden_handler if there is one, e.g. to log to a fleet's
+ * collector, else on stderr.
+ */
+void
+ADT_harden_fail(const char *what, const char *file, int line)
+{
+  if (ADT_harden_handler != NULL)
+    (*ADT_harden_handler)(what, file, line);
+  else
+    fprintf(stderr, "libadt: %s (%s:%d)\n", what, file, line);
+  abort();
+}
+
+/*
+ * Have handler report failed checks before the process aborts, or restore
+ * the stderr report with NULL. The process aborts once handler returns.
+ */
+void
+ADT_set_harden_handler(void (*handler)(const char *, const char *, int))
+{
+  ADT_harden_handler = handler;
+}
@@ -0,0 +1,64 @@
+#ifndef _ADT_HARDEN_H
+#define _ADT_HARDEN_H
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+/*******************************************************************************
+ * Hardened checks
+ *
+ * ADT_HARDEN picks how far the linked lists defend against misuse, at
+ * compile time (make HARDEN=n; make clean first when switching):
+ *
+ *   0  the default: preconditions are plain asserts, compiled out with
+ *      NDEBUG, leaving the usual fast path.
+ *   1  preconditions are checked even with NDEBUG. A violation, such as
+ *      popping an empty list or removing after the tail, calls
+ *      ADT_harden_fail instead of running into undefined behavior.
+ *   2  as 1, and every ADT_sl_node and ADT_dl_node also carries a canary
+ *      derived from its address. The canary is checked whenever a node
+ *      comes back from the caller or is freed. Freed nodes are poisoned,
+ *      which catches use after pop, double removal and stray writes over
+ *      a node.
+ *
+ * Level 2 changes the node layout, so all of the library and its users
+ * must be built at the same level.
+ */
+
+#ifndef ADT_HARDEN
+#define ADT_HARDEN 0
+#endif
+
+#define ADT_POISON_BYTE 0xa5
+#define ADT_CANARY_KEY ((uintptr_t)0x5ca1ab1e0ddba11ULL)
+
+#if ADT_HARDEN > 0
+#define ADT_check(cond, what) \
+  ((cond) ? (void)0 : ADT_harden_fail(what, __FILE__, __LINE__))
+#else
+#define ADT_check(cond, what) assert(cond)
+#endif
+
+#if ADT_HARDEN > 1
+#define ADT_canary(node) ((uintptr_t)(node) ^ ADT_CANARY_KEY)
+#define ADT_canary_arm(node) ((node)->canary = ADT_canary(node))
+#define ADT_canary_check(node) \
+  ADT_check((node)->canary == ADT_canary(node), "freed or corrupt node")
+/* Fill a node about to be freed with poison, its canary with a dead one. */
+#define ADT_poison(node) \
+  (memset((node), ADT_POISON_BYTE, sizeof(*(node))), (node)->canary = ~ADT_canary(node))
+#else
+#define ADT_canary_arm(node) ((void)0)
+#define ADT_canary_check(node) ((void)0)
+#define ADT_poison(node) ((void)0)
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((noreturn))
+#endif
+void ADT_harden_fail(const char *, const char *, int);
+void ADT_set_harden_handler(void (*handler)(const char *, const char *, int));
+
+
+#endif
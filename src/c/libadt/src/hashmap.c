@@ -0,0 +1,429 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "hashmap.h"
+#ifdef __SSE2__
+  #include <emmintrin.h>
+#endif
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+/* Control bytes: full slots hold 7 hash bits, so only these are negative. */
+#define ADT_HM_EMPTY ((signed char)-128)
+#define ADT_HM_DELETED ((signed char)-2)
+
+/*
+ * Group matching. Each returns a bitmask with bit i set when control byte
+ * i of the group starting at g matches. Groups are always ADT_HM_GROUP
+ * aligned within the table, so a probe never reads past its end.
+ */
+
+#ifdef __SSE2__
+
+static inline unsigned int
+ADT_hm_match(const signed char *g, signed char h2)
+{
+  __m128i ctrl = _mm_loadu_si128((const __m128i *)g);
+
+  return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+}
+
+/* Empty or deleted, the bytes with the sign bit set. */
+static inline unsigned int
+ADT_hm_match_free(const signed char *g)
+{
+  return (unsigned int)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)g));
+}
+
+#else
+
+static inline unsigned int
+ADT_hm_match(const signed char *g, signed char h2)
+{
+  unsigned int i, bits = 0;
+
+  for (i = 0; i < ADT_HM_GROUP; i++)
+    bits |= (unsigned int)(g[i] == h2) << i;
+  return bits;
+}
+
+static inline unsigned int
+ADT_hm_match_free(const signed char *g)
+{
+  unsigned int i, bits = 0;
+
+  for (i = 0; i < ADT_HM_GROUP; i++)
+    bits |= (unsigned int)(g[i] < 0) << i;
+  return bits;
+}
+
+#endif
+
+#define ADT_hm_match_empty(g) ADT_hm_match(g, ADT_HM_EMPTY)
+
+/* Scramble a caller hash so both its halves below are well distributed. */
+static inline size_t
+ADT_hm_mix(const struct ADT_hashmap *map, const void *key)
+{
+  uint64_t h = (uint64_t)(*map->hash)(key) * UINT64_C(0x9e3779b97f4a7c15);
+
+  return (size_t)(h ^ (h >> 32));
+}
+
+#define ADT_hm_h1(h) ((h) >> 7)
+#define ADT_hm_h2(h) ((signed char)((h) & 0x7f))
+
+/* Largest number of entries a table of capacity cap holds. */
+#define ADT_hm_max_load(cap) ((cap) - (cap) / 8)
+
+/*
+ * Return a new initialized, empty Hash Map hashing keys with hash and
+ * comparing them with equal. No memory is allocated until the first insert
+ * or reserve. Tables come from the library-wide allocator.
+ * Pre: map is a pointer to a newly created ADT_hashmap.
+ */
+void
+ADT_hashmap_init(struct ADT_hashmap *map, size_t (*hash)(const void *),
+                 int (*equal)(const void *, const void *))
+{
+  ADT_hashmap_init_alloc(map, hash, equal, ADT_get_allocator());
+}
+
+/*
+ * Return a new initialized, empty Hash Map whose tables come from alloc.
+ * Pre: map is a pointer to a newly created ADT_hashmap, and alloc must
+ *      outlive the map.
+ */
+void
+ADT_hashmap_init_alloc(struct ADT_hashmap *map, size_t (*hash)(const void *),
+                       int (*equal)(const void *, const void *),
+                       const struct ADT_allocator *alloc)
+{
+  map->ctrl = NULL;
+  map->slots = NULL;
+  map->mask = 0;
+  map->len = 0;
+  map->growth_left = 0;
+  map->hash = hash;
+  map->equal = equal;
+  map->alloc = alloc;
+}
+
+/*
+ * Remove every entry of map, calling destroy_key and destroy_value on its
+ * key and value where they are not NULL, and release the table.
+ * Pre: map must be a pointer to an initialized ADT_hashmap structure.
+ * Post: map is empty and may be reused.
+ */
+void
+ADT_hashmap_destroy(struct ADT_hashmap *map, void (*destroy_key)(void *),
+                    void (*destroy_value)(void *))
+{
+  size_t i;
+
+  if (map->ctrl == NULL)
+    return;
+  if (destroy_key != NULL || destroy_value != NULL) {
+    for (i = 0; i <= map->mask; i++) {
+      if (map->ctrl[i] < 0)
+        continue;
+      if (destroy_key != NULL)
+        (*destroy_key)(map->slots[i].key);
+      if (destroy_value != NULL)
+        (*destroy_value)(map->slots[i].value);
+    }
+  }
+  ADT_free(map->alloc, map->ctrl);
+  ADT_hashmap_init_alloc(map, map->hash, map->equal, map->alloc);
+}
+
+/*
+ * Return the index of key's slot, or -1 when key is not in map.
+ * Probing visits aligned groups in triangular order, which covers every
+ * group of a power of two table, and stops at the first group that has an
+ * empty slot: key would have gone there.
+ */
+static long
+ADT_hm_lookup(const struct ADT_hashmap *map, const void *key, size_t h)
+{
+  size_t pos = ADT_hm_h1(h) & map->mask & ~(size_t)(ADT_HM_GROUP - 1), step = 0;
+  const signed char *g;
+  unsigned int bits;
+  size_t i;
+
+  if (map->len == 0)
+    return -1;
+  for (;;) {
+    g = map->ctrl + pos;
+    for (bits = ADT_hm_match(g, ADT_hm_h2(h)); bits != 0; bits &= bits - 1) {
+      i = pos + __builtin_ctz(bits);
+      if ((*map->equal)(map->slots[i].key, key))
+        return (long)i;
+    }
+    if (ADT_hm_match_empty(g) != 0)
+      return -1;
+    step += ADT_HM_GROUP;
+    pos = (pos + step) & map->mask;
+  }
+}
+
+/* Return the first empty or deleted slot on the probe sequence of h. */
+static size_t
+ADT_hm_find_free(const struct ADT_hashmap *map, size_t h)
+{
+  size_t pos = ADT_hm_h1(h) & map->mask & ~(size_t)(ADT_HM_GROUP - 1), step = 0;
+  unsigned int bits;
+
+  for (;;) {
+    bits = ADT_hm_match_free(map->ctrl + pos);
+    if (bits != 0)
+      return pos + __builtin_ctz(bits);
+    step += ADT_HM_GROUP;
+    pos = (pos + step) & map->mask;
+  }
+}
+
+/*
+ * Rebuild map with room for at least n entries, or for its current ones if
+ * that is more, which also clears out deleted slots.
+ * Pre: map must be a pointer to an initialized ADT_hashmap structure.
+ * Returns: 0 on success or -1 on an allocation error, map is then unchanged.
+ */
+int
+ADT_hashmap_rehash(struct ADT_hashmap *map, size_t n)
+{
+  struct ADT_hashmap old = *map;
+  size_t cap = ADT_HM_GROUP, i, j, h;
+  char *block;
+
+  if (n < map->len)
+    n = map->len;
+  if (n == 0) {
+    ADT_hashmap_destroy(map, NULL, NULL);
+    return 0;
+  }
+  while (ADT_hm_max_load(cap) < n)
+    cap *= 2;
+  block = (char *)ADT_alloc(map->alloc, cap * (1 + sizeof(struct ADT_hm_slot)));
+  if (block == NULL)
+    return -1;
+  map->ctrl = (signed char *)block;
+  map->slots = (struct ADT_hm_slot *)(block + cap);
+  memset(map->ctrl, ADT_HM_EMPTY, cap);
+  map->mask = cap - 1;
+  map->growth_left = ADT_hm_max_load(cap) - map->len;
+  if (old.ctrl == NULL)
+    return 0;
+  for (i = 0; i <= old.mask; i++) {
+    if (old.ctrl[i] < 0)
+      continue;
+    h = ADT_hm_mix(map, old.slots[i].key);
+    j = ADT_hm_find_free(map, h);
+    map->ctrl[j] = ADT_hm_h2(h);
+    map->slots[j] = old.slots[i];
+  }
+  ADT_free(map->alloc, old.ctrl);
+  return 0;
+}
+
+/*
+ * Make room for n entries in map, so inserts up to that many do not rehash.
+ * Pre: map must be a pointer to an initialized ADT_hashmap structure.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_hashmap_reserve(struct ADT_hashmap *map, size_t n)
+{
+  if (n <= map->len || n - map->len <= map->growth_left)
+    return 0;
+  return ADT_hashmap_rehash(map, n);
+}
+
+/* Grow for one more entry: double when full, rebuild in place when the
+ * room went to deleted slots. */
+static int
+ADT_hm_grow(struct ADT_hashmap *map)
+{
+  return ADT_hashmap_rehash(map, 2 * map->len + 1);
+}
+
+/*
+ * Map key to value. If an equal key is in map already its value is
+ * replaced; the key stored first is kept.
+ * Pre: map must be a pointer to an initialized ADT_hashmap structure.
+ * Returns: 0 if key was added, 1 if its value was replaced, or -1 on an
+ *          allocation error.
+ */
+int
+ADT_hashmap_insert(struct ADT_hashmap *map, void *key, void *value)
+{
+  size_t h = ADT_hm_mix(map, key), i;
+  long found = ADT_hm_lookup(map, key, h);
+
+  if (found >= 0) {
+    map->slots[found].value = value;
+    return 1;
+  }
+  if (map->ctrl == NULL && ADT_hm_grow(map) != 0)
+    return -1;
+  i = ADT_hm_find_free(map, h);
+  if (map->ctrl[i] == ADT_HM_EMPTY) {
+    if (map->growth_left == 0) {
+      if (ADT_hm_grow(map) != 0)
+        return -1;
+      i = ADT_hm_find_free(map, h);
+    }
+    map->growth_left--;
+  }
+  map->ctrl[i] = ADT_hm_h2(h);
+  map->slots[i].key = key;
+  map->slots[i].value = value;
+  map->len++;
+  return 0;
+}
+
+/*
+ * Insert the n pairs keys[i], values[i] into map, sizing the table for all
+ * of them up front.
+ * Pre: map must be a pointer to an initialized ADT_hashmap structure.
+ * Returns: 0 on success or -1 on an allocation error, before anything is
+ *          inserted.
+ */
+int
+ADT_hashmap_insert_n(struct ADT_hashmap *map, void **keys, void **values, size_t n)
+{
+  size_t i;
+
+  if (ADT_hashmap_reserve(map, map->len + n) != 0)
+    return -1;
+  for (i = 0; i < n; i++)
+    ADT_hashmap_insert(map, keys[i], values[i]);
+  return 0;
+}
+
+/*
+ * Look key up in map.
+ * Pre: map must be a pointer to an initialized ADT_hashmap structure.
+ * Post: on success value, unless NULL, points to the value for key.
+ * Returns: 0 if key is in map or -1 if not.
+ */
+int
+ADT_hashmap_find(struct ADT_hashmap *map, const void *key, void **value)
+{
+  long i = ADT_hm_lookup(map, key, ADT_hm_mix(map, key));
+
+  if (i < 0)
+    return -1;
+  if (value != NULL)
+    *value = map->slots[i].value;
+  return 0;
+}
+
+/*
+ * Remove key from map.
+ * Pre: map must be a pointer to an initialized ADT_hashmap structure.
+ * Post: on success stored_key and value, unless NULL, point to the key and
+ *       value that were in map, so the caller can release them.
+ * Returns: 0 if key was in map or -1 if not.
+ * Note: A slot whose group still has an empty slot cannot be on any longer
+ *       probe sequence, so it becomes empty again instead of deleted.
+ */
+int
+ADT_hashmap_remove(struct ADT_hashmap *map, const void *key, void **stored_key, void **value)
+{
+  long i = ADT_hm_lookup(map, key, ADT_hm_mix(map, key));
+
+  if (i < 0)
+    return -1;
+  if (stored_key != NULL)
+    *stored_key = map->slots[i].key;
+  if (value != NULL)
+    *value = map->slots[i].value;
+  if (ADT_hm_match_empty(map->ctrl + (i & ~(long)(ADT_HM_GROUP - 1))) != 0) {
+    map->ctrl[i] = ADT_HM_EMPTY;
+    map->growth_left++;
+  } else {
+    map->ctrl[i] = ADT_HM_DELETED;
+  }
+  map->len--;
+  return 0;
+}
+
+/*
+ * Step through the entries of map in table order. Start with *pos at 0;
+ * every call returns the entry at or after *pos and moves *pos past it.
+ * Pre: map must be a pointer to an initialized ADT_hashmap structure, not
+ *      inserted into since iteration started.
+ * Returns: 0 with key and value, unless NULL, set, or -1 at the end.
+ */
+int
+ADT_hashmap_next(struct ADT_hashmap *map, size_t *pos, void **key, void **value)
+{
+  size_t i;
+
+  if (map->ctrl == NULL)
+    return -1;
+  for (i = *pos; i <= map->mask; i++) {
+    if (map->ctrl[i] >= 0) {
+      if (key != NULL)
+        *key = map->slots[i].key;
+      if (value != NULL)
+        *value = map->slots[i].value;
+      *pos = i + 1;
+      return 0;
+    }
+  }
+  *pos = i;
+  return -1;
+}
+
+/*
+ * Return the number of entries in map.
+ * Pre: map must be a pointer to an initialized ADT_hashmap structure.
+ */
+size_t
+ADT_hashmap_length(struct ADT_hashmap *map)
+{
+  return map->len;
+}
+
+/*
+ * Return the number of slots in map's table; it holds up to 7/8 of that.
+ * Pre: map must be a pointer to an initialized ADT_hashmap structure.
+ */
+size_t
+ADT_hashmap_capacity(struct ADT_hashmap *map)
+{
+  return (map->ctrl == NULL) ? 0 : map->mask + 1;
+}
+
+size_t
+ADT_hash_ptr(const void *key)
+{
+  return (size_t)(uintptr_t)key;
+}
+
+int
+ADT_equal_ptr(const void *a, const void *b)
+{
+  return a == b;
+}
+
+/* FNV-1a. */
+size_t
+ADT_hash_str(const void *key)
+{
+  const unsigned char *s = (const unsigned char *)key;
+  uint64_t h = UINT64_C(0xcbf29ce484222325);
+
+  while (*s != '\0')
+    h = (h ^ *s++) * UINT64_C(0x100000001b3);
+  return (size_t)h;
+}
+
+int
+ADT_equal_str(const void *a, const void *b)
+{
+  return strcmp((const char *)a, (const char *)b) == 0;
+}
@@ -0,0 +1,66 @@
+#ifndef _ADT_HASHMAP_H
+#define _ADT_HASHMAP_H
+
+#include <stddef.h>
+#include "alloc.h"
+
+/*******************************************************************************
+ * Open addressing hash map
+ *
+ * Swiss table layout: alongside the slots is one control byte per slot,
+ * either empty, deleted, or the low 7 bits of a full slot's hash. A lookup
+ * probes groups of ADT_HM_GROUP control bytes, comparing the whole group
+ * against the 7 hash bits at once (with SSE2 where available), and only
+ * calls equal for slots whose bits match. The table is kept at most 7/8
+ * full and doubles in capacity as needed.
+ *
+ * Keys and values are not copied. The hash fn need not mix its bits well,
+ * the map scrambles every hash before use.
+ */
+
+#define ADT_HM_GROUP 16
+
+struct ADT_hm_slot {
+  void *key;
+  void *value;
+};
+
+struct ADT_hashmap {
+  signed char *ctrl;            /* capacity control bytes */
+  struct ADT_hm_slot *slots;
+  size_t mask;                  /* capacity minus one, capacity 0 until first insert */
+  size_t len;
+  size_t growth_left;           /* inserts into empty slots before a rehash */
+  size_t (*hash)(const void *);
+  int (*equal)(const void *, const void *);
+  const struct ADT_allocator *alloc;
+};
+
+void ADT_hashmap_init(struct ADT_hashmap *, size_t (*hash)(const void *),
+                      int (*equal)(const void *, const void *));
+void ADT_hashmap_init_alloc(struct ADT_hashmap *, size_t (*hash)(const void *),
+                            int (*equal)(const void *, const void *),
+                            const struct ADT_allocator *);
+void ADT_hashmap_destroy(struct ADT_hashmap *, void (*destroy_key)(void *),
+                         void (*destroy_value)(void *));
+int ADT_hashmap_reserve(struct ADT_hashmap *, size_t);
+int ADT_hashmap_rehash(struct ADT_hashmap *, size_t);
+int ADT_hashmap_insert(struct ADT_hashmap *, void *, void *);
+int ADT_hashmap_insert_n(struct ADT_hashmap *, void **, void **, size_t);
+int ADT_hashmap_find(struct ADT_hashmap *, const void *, void **);
+int ADT_hashmap_remove(struct ADT_hashmap *, const void *, void **, void **);
+int ADT_hashmap_next(struct ADT_hashmap *, size_t *, void **, void **);
+size_t ADT_hashmap_length(struct ADT_hashmap *);
+size_t ADT_hashmap_capacity(struct ADT_hashmap *);
+
+/*
+ * Ready made hash and equal fns for pointer identity and C strings.
+ */
+
+size_t ADT_hash_ptr(const void *);
+int ADT_equal_ptr(const void *, const void *);
+size_t ADT_hash_str(const void *);
+int ADT_equal_str(const void *, const void *);
+
+
+#endif
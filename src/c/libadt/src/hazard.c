@@ -0,0 +1,219 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include "hazard.h"
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+/* Spare retirements allowed per published slot before a scan is forced. */
+#define ADT_HP_SCAN_FACTOR 2
+#define ADT_HP_MIN_RETIRED 64
+
+static struct ADT_hp_rec *_Atomic ADT_hp_head = NULL;
+static atomic_uint ADT_hp_nrecs = 0;
+
+static pthread_once_t ADT_hp_once = PTHREAD_ONCE_INIT;
+static pthread_key_t ADT_hp_key;
+static _Thread_local struct ADT_hp_rec *ADT_hp_self = NULL;
+
+static void ADT_hp_scan(struct ADT_hp_rec *);
+
+static void
+ADT_hp_release(void *ptr)
+{
+  struct ADT_hp_rec *rec = (struct ADT_hp_rec *)ptr;
+  int i;
+
+  for (i = 0; i < ADT_HP_SLOTS; i++)
+    atomic_store(&rec->hp[i], NULL);
+  ADT_hp_scan(rec);
+  atomic_store(&rec->active, 0);
+}
+
+static void
+ADT_hp_key_init(void)
+{
+  pthread_key_create(&ADT_hp_key, &ADT_hp_release);
+}
+
+/*
+ * Return the calling thread's hazard pointer record, claiming an idle record
+ * or publishing a new one on first use.
+ * Post: the record is released automatically when the thread exits.
+ * Returns: the record, or NULL if a new record could not be allocated.
+ */
+struct ADT_hp_rec *
+ADT_hp_get(void)
+{
+  struct ADT_hp_rec *rec;
+  int idle;
+  int i;
+
+  if (ADT_hp_self != NULL)
+    return ADT_hp_self;
+  pthread_once(&ADT_hp_once, &ADT_hp_key_init);
+  for (rec = atomic_load(&ADT_hp_head); rec != NULL; rec = rec->next) {
+    idle = 0;
+    if (atomic_load(&rec->active) == 0 &&
+        atomic_compare_exchange_strong(&rec->active, &idle, 1))
+      break;
+  }
+  if (rec == NULL) {
+    rec = (struct ADT_hp_rec *)malloc(sizeof(struct ADT_hp_rec));
+    if (rec == NULL)
+      return NULL;
+    for (i = 0; i < ADT_HP_SLOTS; i++)
+      atomic_init(&rec->hp[i], NULL);
+    atomic_init(&rec->active, 1);
+    rec->retired = NULL;
+    rec->nretired = 0;
+    rec->cap = 0;
+    rec->next = atomic_load(&ADT_hp_head);
+    while (!atomic_compare_exchange_weak(&ADT_hp_head, &rec->next, rec))
+      ;
+    atomic_fetch_add(&ADT_hp_nrecs, 1);
+  }
+  pthread_setspecific(ADT_hp_key, rec);
+  ADT_hp_self = rec;
+  return rec;
+}
+
+/*
+ * Load the pointer at src and publish it in slot of rec, repeating until the
+ * published value is still current.
+ * Post: the returned node cannot be reclaimed until the slot is cleared or
+ *       reused.
+ */
+void *
+ADT_hp_protect(struct ADT_hp_rec *rec, int slot, void *_Atomic *src)
+{
+  void *ptr, *cur = atomic_load(src);
+
+  do {
+    ptr = cur;
+    atomic_store(&rec->hp[slot], ptr);
+    cur = atomic_load(src);
+  } while (cur != ptr);
+  return ptr;
+}
+
+void
+ADT_hp_clear(struct ADT_hp_rec *rec, int slot)
+{
+  atomic_store_explicit(&rec->hp[slot], NULL, memory_order_release);
+}
+
+static int
+ADT_hp_ptr_cmp(const void *a, const void *b)
+{
+  const char *x = *(char * const *)a, *y = *(char * const *)b;
+
+  return (x > y) - (x < y);
+}
+
+/*
+ * Hand every retired node of rec which no record protects back to its
+ * allocator. Protected nodes stay retired.
+ */
+static void
+ADT_hp_scan(struct ADT_hp_rec *rec)
+{
+  struct ADT_hp_rec *first, *other;
+  void **hazards;
+  void *ptr;
+  unsigned int nhazards = 0, max = 0, i, kept = 0;
+  int j;
+
+  if (rec->nretired == 0)
+    return;
+  /*
+   * Records published after this snapshot belong to threads which can only
+   * reach nodes still linked into a structure, so they can be ignored.
+   */
+  first = atomic_load(&ADT_hp_head);
+  for (other = first; other != NULL; other = other->next)
+    max += ADT_HP_SLOTS;
+  hazards = (void **)malloc(max * sizeof(void *));
+  if (hazards == NULL)
+    return;
+  for (other = first; other != NULL; other = other->next) {
+    for (j = 0; j < ADT_HP_SLOTS; j++) {
+      ptr = atomic_load(&other->hp[j]);
+      if (ptr != NULL)
+        hazards[nhazards++] = ptr;
+    }
+  }
+  qsort(hazards, nhazards, sizeof(void *), &ADT_hp_ptr_cmp);
+  for (i = 0; i < rec->nretired; i++) {
+    ptr = rec->retired[i].ptr;
+    if (bsearch(&ptr, hazards, nhazards, sizeof(void *), &ADT_hp_ptr_cmp) != NULL)
+      rec->retired[kept++] = rec->retired[i];
+    else
+      ADT_free(rec->retired[i].alloc, ptr);
+  }
+  rec->nretired = kept;
+  free(hazards);
+}
+
+/*
+ * Retire ptr, which has been unlinked from a shared structure and will be
+ * returned to alloc once no hazard pointer refers to it.
+ * Pre: rec is the calling thread's record and ptr is no longer reachable
+ *      from the structure.
+ */
+void
+ADT_hp_retire(struct ADT_hp_rec *rec, void *ptr, const struct ADT_allocator *alloc)
+{
+  struct ADT_hp_retired *grown;
+  unsigned int threshold;
+
+  if (alloc->free == NULL)
+    return;
+  while (rec->nretired == rec->cap) {
+    grown = (struct ADT_hp_retired *)realloc(rec->retired,
+                                             2 * (rec->cap + ADT_HP_MIN_RETIRED) *
+                                             sizeof(struct ADT_hp_retired));
+    if (grown != NULL) {
+      rec->retired = grown;
+      rec->cap = 2 * (rec->cap + ADT_HP_MIN_RETIRED);
+      break;
+    }
+    /* Out of memory: wait for readers to move off our retired nodes. */
+    ADT_hp_scan(rec);
+    if (rec->nretired == rec->cap)
+      sched_yield();
+  }
+  rec->retired[rec->nretired].ptr = ptr;
+  rec->retired[rec->nretired].alloc = alloc;
+  rec->nretired++;
+  threshold = ADT_HP_SCAN_FACTOR * ADT_HP_SLOTS * atomic_load(&ADT_hp_nrecs);
+  if (rec->nretired >= threshold + ADT_HP_MIN_RETIRED)
+    ADT_hp_scan(rec);
+}
+
+/*
+ * Reclaim every node which is not currently protected and was retired by
+ * the calling thread or by a thread which has exited, e.g. before
+ * destroying the allocator those nodes came from.
+ * Note: nodes retired by other running threads stay with their records;
+ *       those threads must drain or exit first.
+ */
+void
+ADT_hp_drain(void)
+{
+  struct ADT_hp_rec *rec;
+  int idle;
+
+  if (ADT_hp_self != NULL)
+    ADT_hp_scan(ADT_hp_self);
+  /* Claim each idle record while scanning it so no thread adopts it meanwhile. */
+  for (rec = atomic_load(&ADT_hp_head); rec != NULL; rec = rec->next) {
+    idle = 0;
+    if (atomic_load(&rec->active) == 0 &&
+        atomic_compare_exchange_strong(&rec->active, &idle, 1)) {
+      ADT_hp_scan(rec);
+      atomic_store(&rec->active, 0);
+    }
+  }
+}
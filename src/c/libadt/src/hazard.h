@@ -0,0 +1,47 @@
+#ifndef _ADT_HAZARD_H
+#define _ADT_HAZARD_H
+
+#include <stdatomic.h>
+#include "alloc.h"
+
+/*******************************************************************************
+ * Hazard pointers
+ *
+ * Safe memory reclamation for the lock-free structures. A thread publishes
+ * the nodes it is about to dereference in its record's slots, and nodes
+ * unlinked from a structure are retired rather than freed. A retired node
+ * is only handed back to its allocator once no slot in any record holds it,
+ * so a node cannot be recycled under a reader and ABA cannot occur.
+ *
+ * There is one process-wide domain. Each thread gets a record on first use
+ * and gives it back when it exits; retirements still protected at that
+ * point stay with the idle record. ADT_hp_drain reclaims what the calling
+ * thread and exited threads retired, but not what threads still running
+ * hold, so before an allocator goes away every thread that retired into it
+ * must have drained or exited.
+ */
+
+#define ADT_HP_SLOTS 2
+
+struct ADT_hp_retired {
+  void *ptr;
+  const struct ADT_allocator *alloc;
+};
+
+struct ADT_hp_rec {
+  void *_Atomic hp[ADT_HP_SLOTS];
+  atomic_int active;
+  struct ADT_hp_rec *next;      /* fixed once the record is published */
+  struct ADT_hp_retired *retired;
+  unsigned int nretired;
+  unsigned int cap;
+};
+
+struct ADT_hp_rec *ADT_hp_get(void);
+void *ADT_hp_protect(struct ADT_hp_rec *, int, void *_Atomic *);
+void ADT_hp_clear(struct ADT_hp_rec *, int);
+void ADT_hp_retire(struct ADT_hp_rec *, void *, const struct ADT_allocator *);
+void ADT_hp_drain(void);
+
+
+#endif
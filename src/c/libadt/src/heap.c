@@ -0,0 +1,459 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "heap.h"
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+#define ADT_HEAP_INITIAL_CAP 16
+
+#define ADT_heap_parent(i) (((i) - 1) / ADT_HEAP_ARITY)
+#define ADT_heap_child(i) (ADT_HEAP_ARITY * (i) + 1)
+
+/*
+ * Return a new initialized 4-ary heap ordered by cmp.
+ * Pre: heap is a pointer to a newly created ADT_heap.
+ * Post: heap is empty and holds no memory. The array comes from the
+ *       library-wide allocator.
+ */
+void
+ADT_heap_init(struct ADT_heap *heap, int (*cmp)(const void *, const void *, void *),
+              void *ctx)
+{
+  ADT_heap_init_alloc(heap, cmp, ctx, ADT_get_allocator());
+}
+
+/*
+ * Return a new initialized 4-ary heap ordered by cmp whose array comes
+ * from alloc.
+ * Pre: heap is a pointer to a newly created ADT_heap, and alloc must
+ *      outlive the heap.
+ */
+void
+ADT_heap_init_alloc(struct ADT_heap *heap, int (*cmp)(const void *, const void *, void *),
+                    void *ctx, const struct ADT_allocator *alloc)
+{
+  heap->items = NULL;
+  heap->len = 0;
+  heap->cap = 0;
+  heap->cmp = cmp;
+  heap->ctx = ctx;
+  heap->alloc = alloc;
+}
+
+/*
+ * Release heap, calling destroy on every element unless it is NULL.
+ * Pre: heap must be a pointer to an initialized ADT_heap structure.
+ * Post: heap is empty and may be reused.
+ */
+void
+ADT_heap_destroy(struct ADT_heap *heap, void (*destroy)(void *))
+{
+  size_t i;
+
+  if (destroy != NULL) {
+    for (i = 0; i < heap->len; i++)
+      (*destroy)(heap->items[i]);
+  }
+  if (heap->items != NULL)
+    ADT_free(heap->alloc, heap->items);
+  ADT_heap_init_alloc(heap, heap->cmp, heap->ctx, heap->alloc);
+}
+
+/*
+ * Make sure heap has room for n elements without growing.
+ * Pre: heap must be a pointer to an initialized ADT_heap structure.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_heap_reserve(struct ADT_heap *heap, size_t n)
+{
+  size_t cap = (heap->cap != 0) ? heap->cap : ADT_HEAP_INITIAL_CAP;
+  void **items;
+
+  if (n <= heap->cap)
+    return 0;
+  while (cap < n)
+    cap *= 2;
+  if (cap > (size_t)-1 / sizeof(void *))
+    return -1;
+  items = (void **)ADT_alloc(heap->alloc, cap * sizeof(void *));
+  if (items == NULL)
+    return -1;
+  if (heap->items != NULL) {
+    memcpy(items, heap->items, heap->len * sizeof(void *));
+    ADT_free(heap->alloc, heap->items);
+  }
+  heap->items = items;
+  heap->cap = cap;
+  return 0;
+}
+
+/* Move data up from the hole at i until its parent comes first. */
+static void
+ADT_heap_sift_up(struct ADT_heap *heap, size_t i, void *data)
+{
+  size_t parent;
+
+  while (i > 0) {
+    parent = ADT_heap_parent(i);
+    if ((*heap->cmp)(data, heap->items[parent], heap->ctx) >= 0)
+      break;
+    heap->items[i] = heap->items[parent];
+    i = parent;
+  }
+  heap->items[i] = data;
+}
+
+/* Move data down from the hole at i until it comes before all its children. */
+static void
+ADT_heap_sift_down(struct ADT_heap *heap, size_t i, void *data)
+{
+  size_t child, best, end;
+
+  for (;;) {
+    child = ADT_heap_child(i);
+    if (child >= heap->len)
+      break;
+    end = (child + ADT_HEAP_ARITY < heap->len) ? child + ADT_HEAP_ARITY : heap->len;
+    for (best = child++; child < end; child++) {
+      if ((*heap->cmp)(heap->items[child], heap->items[best], heap->ctx) < 0)
+        best = child;
+    }
+    if ((*heap->cmp)(heap->items[best], data, heap->ctx) >= 0)
+      break;
+    heap->items[i] = heap->items[best];
+    i = best;
+  }
+  heap->items[i] = data;
+}
+
+/*
+ * Insert data into heap.
+ * Pre: heap must be a pointer to an initialized ADT_heap structure.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_heap_push(struct ADT_heap *heap, void *data)
+{
+  if (heap->len == heap->cap && ADT_heap_reserve(heap, heap->len + 1) != 0)
+    return -1;
+  ADT_heap_sift_up(heap, heap->len++, data);
+  return 0;
+}
+
+/*
+ * Insert items[0] through items[n - 1] into heap. A batch at least as large
+ * as the heap is added by rebuilding it bottom up in O(n + len), smaller
+ * ones one at a time.
+ * Pre: heap must be a pointer to an initialized ADT_heap structure.
+ * Returns: 0 on success or -1 on an allocation error, in which case heap
+ *          is unchanged.
+ */
+int
+ADT_heap_push_n(struct ADT_heap *heap, void **items, size_t n)
+{
+  size_t i;
+
+  if (n > (size_t)-1 - heap->len || ADT_heap_reserve(heap, heap->len + n) != 0)
+    return -1;
+  if (n < heap->len) {
+    for (i = 0; i < n; i++)
+      ADT_heap_sift_up(heap, heap->len++, items[i]);
+    return 0;
+  }
+  memcpy(heap->items + heap->len, items, n * sizeof(void *));
+  heap->len += n;
+  if (heap->len < 2)
+    return 0;
+  for (i = ADT_heap_parent(heap->len - 1) + 1; i-- > 0;)
+    ADT_heap_sift_down(heap, i, heap->items[i]);
+  return 0;
+}
+
+/*
+ * Remove the first element of heap.
+ * Pre: heap must be a pointer to an initialized ADT_heap structure.
+ * Post: on success data points to the removed element.
+ * Returns: 0 on success or -1 if heap is empty.
+ */
+int
+ADT_heap_pop(struct ADT_heap *heap, void **data)
+{
+  if (heap->len == 0)
+    return -1;
+  *data = heap->items[0];
+  if (--heap->len > 0)
+    ADT_heap_sift_down(heap, 0, heap->items[heap->len]);
+  return 0;
+}
+
+/*
+ * Look at the first element of heap without removing it.
+ * Pre: heap must be a pointer to an initialized ADT_heap structure.
+ * Returns: 0 on success or -1 if heap is empty.
+ */
+int
+ADT_heap_peek(struct ADT_heap *heap, void **data)
+{
+  if (heap->len == 0)
+    return -1;
+  *data = heap->items[0];
+  return 0;
+}
+
+/*
+ * Return the number of elements in heap.
+ * Pre: heap must be a pointer to an initialized ADT_heap structure.
+ */
+size_t
+ADT_heap_length(struct ADT_heap *heap)
+{
+  return heap->len;
+}
+
+/*
+ * Return a new initialized pairing heap ordered by cmp.
+ * Pre: heap is a pointer to a newly created ADT_pheap.
+ * Post: heap is empty. Nodes come from the library-wide allocator.
+ */
+void
+ADT_pheap_init(struct ADT_pheap *heap, int (*cmp)(const void *, const void *, void *),
+               void *ctx)
+{
+  ADT_pheap_init_alloc(heap, cmp, ctx, ADT_get_allocator());
+}
+
+/*
+ * Return a new initialized pairing heap ordered by cmp whose nodes come
+ * from alloc, e.g. the allocator of an ADT_pool of ADT_pheap_node.
+ * Pre: heap is a pointer to a newly created ADT_pheap, and alloc must
+ *      outlive the heap.
+ */
+void
+ADT_pheap_init_alloc(struct ADT_pheap *heap, int (*cmp)(const void *, const void *, void *),
+                     void *ctx, const struct ADT_allocator *alloc)
+{
+  heap->root = NULL;
+  heap->len = 0;
+  heap->cmp = cmp;
+  heap->ctx = ctx;
+  heap->alloc = alloc;
+}
+
+/*
+ * Release every node of heap, calling destroy on its data unless it is
+ * NULL.
+ * Pre: heap must be a pointer to an initialized ADT_pheap structure.
+ * Post: heap is empty and may be reused; all its nodes are invalid.
+ */
+void
+ADT_pheap_destroy(struct ADT_pheap *heap, void (*destroy)(void *))
+{
+  struct ADT_pheap_node *todo = heap->root, *node, *last;
+
+  /* Splice each node's children in ahead of the rest, visiting every node once. */
+  while (todo != NULL) {
+    node = todo;
+    todo = node->next;
+    if (node->child != NULL) {
+      for (last = node->child; last->next != NULL; last = last->next)
+        ;
+      last->next = todo;
+      todo = node->child;
+    }
+    if (destroy != NULL)
+      (*destroy)(node->data);
+    ADT_free(heap->alloc, node);
+  }
+  heap->root = NULL;
+  heap->len = 0;
+}
+
+/* Link roots a and b, either may be NULL, returning the root that comes first. */
+static struct ADT_pheap_node *
+ADT_pheap_link(struct ADT_pheap *heap, struct ADT_pheap_node *a, struct ADT_pheap_node *b)
+{
+  struct ADT_pheap_node *t;
+
+  if (a == NULL)
+    return b;
+  if (b == NULL)
+    return a;
+  if ((*heap->cmp)(b->data, a->data, heap->ctx) < 0) {
+    t = a;
+    a = b;
+    b = t;
+  }
+  b->prev = a;
+  b->next = a->child;
+  if (a->child != NULL)
+    a->child->prev = b;
+  a->child = b;
+  return a;
+}
+
+/*
+ * Combine a list of siblings into one tree: link them in pairs left to
+ * right, then fold the pairs into one right to left.
+ */
+static struct ADT_pheap_node *
+ADT_pheap_pair(struct ADT_pheap *heap, struct ADT_pheap_node *first)
+{
+  struct ADT_pheap_node *a, *b, *next, *pairs = NULL, *root = NULL;
+
+  while (first != NULL) {
+    a = first;
+    b = a->next;
+    next = (b != NULL) ? b->next : NULL;
+    a->next = a->prev = NULL;
+    if (b != NULL) {
+      b->next = b->prev = NULL;
+      a = ADT_pheap_link(heap, a, b);
+    }
+    /* Stack the pairs through next, so they come back right to left. */
+    a->next = pairs;
+    pairs = a;
+    first = next;
+  }
+  while (pairs != NULL) {
+    a = pairs;
+    pairs = a->next;
+    a->next = NULL;
+    root = ADT_pheap_link(heap, a, root);
+  }
+  return root;
+}
+
+/* Detach the subtree rooted at node, which is not the root, from its parent. */
+static void
+ADT_pheap_cut(struct ADT_pheap_node *node)
+{
+  if (node->prev->child == node)
+    node->prev->child = node->next;
+  else
+    node->prev->next = node->next;
+  if (node->next != NULL)
+    node->next->prev = node->prev;
+  node->next = NULL;
+  node->prev = NULL;
+}
+
+/*
+ * Insert data into heap in constant time.
+ * Pre: heap must be a pointer to an initialized ADT_pheap structure.
+ * Returns: the node holding data, or NULL on an allocation error.
+ */
+struct ADT_pheap_node *
+ADT_pheap_insert(struct ADT_pheap *heap, void *data)
+{
+  struct ADT_pheap_node *node;
+
+  node = (struct ADT_pheap_node *)ADT_alloc(heap->alloc, sizeof(struct ADT_pheap_node));
+  if (node == NULL)
+    return NULL;
+  node->child = NULL;
+  node->next = NULL;
+  node->prev = NULL;
+  node->data = data;
+  heap->root = ADT_pheap_link(heap, heap->root, node);
+  heap->len++;
+  return node;
+}
+
+/*
+ * Remove the first element of heap.
+ * Pre: heap must be a pointer to an initialized ADT_pheap structure.
+ * Post: on success data points to the removed element, and its node is
+ *       released.
+ * Returns: 0 on success or -1 if heap is empty.
+ */
+int
+ADT_pheap_pop(struct ADT_pheap *heap, void **data)
+{
+  struct ADT_pheap_node *root = heap->root;
+
+  if (root == NULL)
+    return -1;
+  *data = root->data;
+  heap->root = ADT_pheap_pair(heap, root->child);
+  heap->len--;
+  ADT_free(heap->alloc, root);
+  return 0;
+}
+
+/*
+ * Look at the first element of heap without removing it.
+ * Pre: heap must be a pointer to an initialized ADT_pheap structure.
+ * Returns: 0 on success or -1 if heap is empty.
+ */
+int
+ADT_pheap_peek(struct ADT_pheap *heap, void **data)
+{
+  if (heap->root == NULL)
+    return -1;
+  *data = heap->root->data;
+  return 0;
+}
+
+/*
+ * Restore heap order after the key of node's data changed to come earlier,
+ * in constant time.
+ * Pre: heap must be a pointer to an initialized ADT_pheap structure and
+ *      node a node of heap whose data does not now come later than before.
+ */
+void
+ADT_pheap_decrease_key(struct ADT_pheap *heap, struct ADT_pheap_node *node)
+{
+  if (node == heap->root)
+    return;
+  ADT_pheap_cut(node);
+  heap->root = ADT_pheap_link(heap, heap->root, node);
+}
+
+/*
+ * Remove node from heap, wherever it is.
+ * Pre: heap must be a pointer to an initialized ADT_pheap structure and
+ *      node a node of heap.
+ * Post: data points to node's data and node is released.
+ */
+void
+ADT_pheap_remove(struct ADT_pheap *heap, struct ADT_pheap_node *node, void **data)
+{
+  if (node == heap->root) {
+    ADT_pheap_pop(heap, data);
+    return;
+  }
+  *data = node->data;
+  ADT_pheap_cut(node);
+  heap->root = ADT_pheap_link(heap, heap->root, ADT_pheap_pair(heap, node->child));
+  heap->len--;
+  ADT_free(heap->alloc, node);
+}
+
+/*
+ * Move every element of src into dst in constant time.
+ * Pre: dst and src must be pointers to distinct initialized ADT_pheap
+ *      structures with the same ordering and allocator.
+ * Post: src is empty. Nodes of src keep serving as handles, now into dst.
+ */
+void
+ADT_pheap_meld(struct ADT_pheap *dst, struct ADT_pheap *src)
+{
+  assert(dst != src && dst->alloc == src->alloc);
+  dst->root = ADT_pheap_link(dst, dst->root, src->root);
+  dst->len += src->len;
+  src->root = NULL;
+  src->len = 0;
+}
+
+/*
+ * Return the number of elements in heap.
+ * Pre: heap must be a pointer to an initialized ADT_pheap structure.
+ */
+size_t
+ADT_pheap_length(struct ADT_pheap *heap)
+{
+  return heap->len;
+}
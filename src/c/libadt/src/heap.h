@@ -0,0 +1,85 @@
+#ifndef _ADT_HEAP_H
+#define _ADT_HEAP_H
+
+#include <stddef.h>
+#include "alloc.h"
+
+/*******************************************************************************
+ * Priority queues
+ *
+ * Both order data by a caller comparator cmp(a, b, ctx), negative when a
+ * comes first, and pop the first element: with a numeric comparison that
+ * is a min-heap.
+ */
+
+/*******************************************************************************
+ * 4-ary heap
+ *
+ * An implicit heap in one array of data pointers. Each element has four
+ * children, so the tree is half as deep as a binary heap and the children
+ * a pop compares sit in one or two cache lines. push and pop are
+ * O(log n); push_n heapifies a batch in O(n).
+ */
+
+#define ADT_HEAP_ARITY 4
+
+struct ADT_heap {
+  void **items;
+  size_t len;
+  size_t cap;
+  int (*cmp)(const void *, const void *, void *);
+  void *ctx;
+  const struct ADT_allocator *alloc;    /* array source */
+};
+
+void ADT_heap_init(struct ADT_heap *, int (*cmp)(const void *, const void *, void *), void *);
+void ADT_heap_init_alloc(struct ADT_heap *, int (*cmp)(const void *, const void *, void *),
+                         void *, const struct ADT_allocator *);
+void ADT_heap_destroy(struct ADT_heap *, void (*destroy)(void *));
+int ADT_heap_reserve(struct ADT_heap *, size_t);
+int ADT_heap_push(struct ADT_heap *, void *);
+int ADT_heap_push_n(struct ADT_heap *, void **, size_t);
+int ADT_heap_pop(struct ADT_heap *, void **);
+int ADT_heap_peek(struct ADT_heap *, void **);
+size_t ADT_heap_length(struct ADT_heap *);
+
+/*******************************************************************************
+ * Pairing heap
+ *
+ * A heap ordered tree in which every node links to its first child and its
+ * next sibling. insert and meld are O(1) and pop is O(log n) amortized,
+ * pairing up the root's children in two passes. insert returns the node
+ * holding data, which stays valid until that element leaves the heap and
+ * serves as a handle: after making an element's key come earlier, call
+ * ADT_pheap_decrease_key on its node, in O(1), or ADT_pheap_remove it.
+ */
+
+struct ADT_pheap_node {
+  struct ADT_pheap_node *child;
+  struct ADT_pheap_node *next;          /* next sibling */
+  struct ADT_pheap_node *prev;          /* previous sibling, or parent of a first child */
+  void *data;
+};
+
+struct ADT_pheap {
+  struct ADT_pheap_node *root;
+  size_t len;
+  int (*cmp)(const void *, const void *, void *);
+  void *ctx;
+  const struct ADT_allocator *alloc;    /* node source */
+};
+
+void ADT_pheap_init(struct ADT_pheap *, int (*cmp)(const void *, const void *, void *), void *);
+void ADT_pheap_init_alloc(struct ADT_pheap *, int (*cmp)(const void *, const void *, void *),
+                          void *, const struct ADT_allocator *);
+void ADT_pheap_destroy(struct ADT_pheap *, void (*destroy)(void *));
+struct ADT_pheap_node *ADT_pheap_insert(struct ADT_pheap *, void *);
+int ADT_pheap_pop(struct ADT_pheap *, void **);
+int ADT_pheap_peek(struct ADT_pheap *, void **);
+void ADT_pheap_decrease_key(struct ADT_pheap *, struct ADT_pheap_node *);
+void ADT_pheap_remove(struct ADT_pheap *, struct ADT_pheap_node *, void **);
+void ADT_pheap_meld(struct ADT_pheap *, struct ADT_pheap *);
+size_t ADT_pheap_length(struct ADT_pheap *);
+
+
+#endif
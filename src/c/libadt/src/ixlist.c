@@ -0,0 +1,414 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "ixlist.h"
+#include "harden.h"
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+#define ADT_IX_INITIAL_CAP 16
+/* Slots can number up to ADT_IX_NIL - 1, leaving NIL free as the end mark. */
+#define ADT_IX_MAX_CAP (ADT_IX_NIL - 1)
+
+/* Grow a block owned by the allocator in list->ctx by copying it over. */
+static int
+ADT_ix_alloc_grow(struct ADT_ix_list *list, uint32_t cap)
+{
+  const struct ADT_allocator *alloc = (const struct ADT_allocator *)list->ctx;
+  struct ADT_ix_header *hdr;
+
+  hdr = (struct ADT_ix_header *)ADT_alloc(alloc, sizeof(struct ADT_ix_header) +
+                                          (size_t)cap * list->slot_size);
+  if (hdr == NULL)
+    return -1;
+  memcpy(hdr, list->hdr, sizeof(struct ADT_ix_header) + (size_t)list->hdr->used * list->slot_size);
+  ADT_free(alloc, list->hdr);
+  hdr->cap = cap;
+  list->hdr = hdr;
+  return 0;
+}
+
+/*
+ * Return a new initialized Index Linked List of void * data whose block
+ * comes from the library-wide allocator.
+ * Pre: list is a pointer to a newly created ADT_ix_list.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_ix_list_init(struct ADT_ix_list *list)
+{
+  return ADT_ix_list_init_alloc(list, 0, ADT_get_allocator());
+}
+
+/*
+ * Return a new initialized Index Linked List whose slots hold size bytes
+ * of data inline, for use with the _inline operations.
+ * Pre: list is a pointer to a newly created ADT_ix_list.
+ * Returns: 0 on success or -1 if size is 0 or on an allocation error.
+ */
+int
+ADT_ix_list_init_inline(struct ADT_ix_list *list, size_t size)
+{
+  if (size == 0)
+    return -1;
+  return ADT_ix_list_init_alloc(list, size, ADT_get_allocator());
+}
+
+/*
+ * Return a new initialized Index Linked List whose block comes from alloc,
+ * holding size bytes inline per slot, or a void * if size is 0.
+ * Pre: list is a pointer to a newly created ADT_ix_list, and alloc must
+ *      outlive the list.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_ix_list_init_alloc(struct ADT_ix_list *list, size_t size, const struct ADT_allocator *alloc)
+{
+  struct ADT_ix_header *hdr;
+  uint32_t flags = (size != 0) ? ADT_IX_INLINE : 0;
+
+  if (size == 0)
+    size = sizeof(void *);
+  if (size > UINT32_MAX / 2)
+    return -1;
+  list->slot_size = ADT_IX_SLOT_SIZE(size);
+  hdr = (struct ADT_ix_header *)ADT_alloc(alloc, sizeof(struct ADT_ix_header) +
+                                          ADT_IX_INITIAL_CAP * list->slot_size);
+  if (hdr == NULL)
+    return -1;
+  hdr->head = ADT_IX_NIL;
+  hdr->tail = ADT_IX_NIL;
+  hdr->free = ADT_IX_NIL;
+  hdr->len = 0;
+  hdr->cap = ADT_IX_INITIAL_CAP;
+  hdr->used = 0;
+  hdr->payload = (uint32_t)size;
+  hdr->flags = flags;
+  list->hdr = hdr;
+  list->grow = &ADT_ix_alloc_grow;
+  list->ctx = (void *)alloc;
+  return 0;
+}
+
+/*
+ * Make list a view of the existing block hdr, e.g. one copied or mapped in
+ * from elsewhere. grow enlarges the block when it fills, or is NULL for a
+ * block of fixed size.
+ * Pre: list is a pointer to a newly created ADT_ix_list and hdr heads a
+ *      block of hdr->cap slots.
+ * Returns: 0 on success or -1 if the header is inconsistent.
+ */
+int
+ADT_ix_list_attach(struct ADT_ix_list *list, struct ADT_ix_header *hdr,
+                   int (*grow)(struct ADT_ix_list *, uint32_t), void *ctx)
+{
+  if (hdr->payload == 0 || hdr->payload > UINT32_MAX / 2 || hdr->used > hdr->cap ||
+      hdr->len > hdr->used || hdr->cap > ADT_IX_MAX_CAP ||
+      (hdr->head == ADT_IX_NIL) != (hdr->len == 0) ||
+      (hdr->head != ADT_IX_NIL && (hdr->head >= hdr->used || hdr->tail >= hdr->used)) ||
+      (hdr->free != ADT_IX_NIL && hdr->free >= hdr->used))
+    return -1;
+  list->hdr = hdr;
+  list->slot_size = ADT_IX_SLOT_SIZE(hdr->payload);
+  list->grow = grow;
+  list->ctx = ctx;
+  return 0;
+}
+
+/*
+ * Release list and its block, calling destroy on the data of every element
+ * of a void * list unless destroy is NULL.
+ * Pre: list must be a pointer to an initialized ADT_ix_list structure whose
+ *      block it owns, i.e. not attached.
+ * Post: the list is invalid until initialized again.
+ */
+void
+ADT_ix_list_destroy(struct ADT_ix_list *list, void (*destroy)(void *))
+{
+  if (destroy != NULL && !(list->hdr->flags & ADT_IX_INLINE)) {
+    uint32_t ix;
+
+    ADT_ix_list_foreach(list, ix)
+      (*destroy)(ADT_ix_list_get(list, ix));
+  }
+  ADT_free((const struct ADT_allocator *)list->ctx, list->hdr);
+  list->hdr = NULL;
+}
+
+/*
+ * Make sure list has room for n elements without growing.
+ * Pre: list must be a pointer to an initialized ADT_ix_list structure.
+ * Returns: 0 on success or -1 if the block cannot grow that far.
+ */
+int
+ADT_ix_list_reserve(struct ADT_ix_list *list, uint32_t n)
+{
+  uint32_t cap = list->hdr->cap;
+
+  if (n <= cap)
+    return 0;
+  if (list->grow == NULL || n > ADT_IX_MAX_CAP)
+    return -1;
+  if (cap == 0)
+    cap = 1;
+  while (cap < n)
+    cap = (cap > ADT_IX_MAX_CAP / 2) ? ADT_IX_MAX_CAP : 2 * cap;
+  return (*list->grow)(list, cap);
+}
+
+/* Take a slot off the free list, or a fresh one, growing the block if needed. */
+static uint32_t
+ADT_ix_slot_alloc(struct ADT_ix_list *list)
+{
+  struct ADT_ix_header *hdr = list->hdr;
+  uint32_t ix;
+
+  if (hdr->free != ADT_IX_NIL) {
+    ix = hdr->free;
+    hdr->free = ADT_ix_next(list, ix);
+    return ix;
+  }
+  if (hdr->used == hdr->cap) {
+    if (hdr->cap == ADT_IX_MAX_CAP || ADT_ix_list_reserve(list, hdr->cap + 1) != 0)
+      return ADT_IX_NIL;
+    hdr = list->hdr;
+  }
+  return hdr->used++;
+}
+
+static void
+ADT_ix_slot_free(struct ADT_ix_list *list, uint32_t ix)
+{
+  ADT_ix_next(list, ix) = list->hdr->free;
+  list->hdr->free = ix;
+}
+
+/* Link slot ix in after prev, or at the head if prev is NIL. */
+static void
+ADT_ix_link_after(struct ADT_ix_list *list, uint32_t prev, uint32_t ix)
+{
+  struct ADT_ix_header *hdr = list->hdr;
+
+  if (prev == ADT_IX_NIL) {
+    ADT_ix_next(list, ix) = hdr->head;
+    hdr->head = ix;
+    if (hdr->len == 0)
+      hdr->tail = ix;
+  } else {
+    ADT_ix_next(list, ix) = ADT_ix_next(list, prev);
+    ADT_ix_next(list, prev) = ix;
+    if (prev == hdr->tail)
+      hdr->tail = ix;
+  }
+  hdr->len++;
+}
+
+/* Unlink the slot after prev, or the head if prev is NIL, and return it. */
+static uint32_t
+ADT_ix_unlink_after(struct ADT_ix_list *list, uint32_t prev)
+{
+  struct ADT_ix_header *hdr = list->hdr;
+  uint32_t ix;
+
+  if (prev == ADT_IX_NIL) {
+    ix = hdr->head;
+    hdr->head = ADT_ix_next(list, ix);
+  } else {
+    ix = ADT_ix_next(list, prev);
+    ADT_ix_next(list, prev) = ADT_ix_next(list, ix);
+  }
+  if (ix == hdr->tail)
+    hdr->tail = prev;
+  hdr->len--;
+  return ix;
+}
+
+/* Store size bytes from src in a new slot linked after prev. */
+static int
+ADT_ix_insert(struct ADT_ix_list *list, uint32_t prev, const void *src)
+{
+  uint32_t ix = ADT_ix_slot_alloc(list);
+
+  if (ix == ADT_IX_NIL)
+    return -1;
+  memcpy(ADT_ix_payload(list, ix), src, list->hdr->payload);
+  ADT_ix_link_after(list, prev, ix);
+  return 0;
+}
+
+static void
+ADT_ix_remove(struct ADT_ix_list *list, uint32_t prev, void *dst)
+{
+  uint32_t ix = ADT_ix_unlink_after(list, prev);
+
+  memcpy(dst, ADT_ix_payload(list, ix), list->hdr->payload);
+  ADT_ix_slot_free(list, ix);
+}
+
+/*
+ * Insert data at the head of list.
+ * Pre: list must be a pointer to an initialized void * ADT_ix_list.
+ * Returns: 0 on success or -1 if the block could not grow.
+ */
+int
+ADT_ix_list_push(struct ADT_ix_list *list, void *data)
+{
+  assert(!(list->hdr->flags & ADT_IX_INLINE));
+  return ADT_ix_insert(list, ADT_IX_NIL, &data);
+}
+
+/*
+ * Insert data at the end of list.
+ * Pre: list must be a pointer to an initialized void * ADT_ix_list.
+ * Returns: 0 on success or -1 if the block could not grow.
+ */
+int
+ADT_ix_list_append(struct ADT_ix_list *list, void *data)
+{
+  assert(!(list->hdr->flags & ADT_IX_INLINE));
+  return ADT_ix_insert(list, list->hdr->tail, &data);
+}
+
+/*
+ * Remove the head of list.
+ * Pre: list must be a pointer to an initialized void * ADT_ix_list with at
+ *      least one element.
+ * Post: data points to the data of the former head, whose slot is recycled.
+ */
+void
+ADT_ix_list_pop(struct ADT_ix_list *list, void **data)
+{
+  assert(!(list->hdr->flags & ADT_IX_INLINE));
+  ADT_check(list->hdr->len != 0, "pop from an empty list");
+  ADT_ix_remove(list, ADT_IX_NIL, data);
+}
+
+/*
+ * Insert data directly after the element in slot loc.
+ * Pre: list must be a pointer to an initialized void * ADT_ix_list, and loc
+ *      *must* be a slot on the list.
+ * Returns: 0 on success or -1 if the block could not grow.
+ * Note: Growing may move the block, so slot payload pointers taken before
+ *       the call may be invalid after it; slot indices stay valid.
+ */
+int
+ADT_ix_list_insert_after(struct ADT_ix_list *list, uint32_t loc, void *data)
+{
+  assert(!(list->hdr->flags & ADT_IX_INLINE));
+  return ADT_ix_insert(list, loc, &data);
+}
+
+/*
+ * Remove the element after the one in slot loc.
+ * Pre: list must be a pointer to an initialized void * ADT_ix_list, and loc
+ *      *must* be a slot on the list other than its tail.
+ * Post: data points to the removed element's data.
+ */
+void
+ADT_ix_list_remove_after(struct ADT_ix_list *list, uint32_t loc, void **data)
+{
+  assert(!(list->hdr->flags & ADT_IX_INLINE));
+  ADT_check(loc < list->hdr->used && loc != list->hdr->tail, "remove after the tail");
+  ADT_ix_remove(list, loc, data);
+}
+
+/*
+ * Copy the payload at src into a new slot at the head of list.
+ * Pre: list must be a pointer to an initialized inline ADT_ix_list.
+ * Returns: 0 on success or -1 if the block could not grow.
+ */
+int
+ADT_ix_list_push_inline(struct ADT_ix_list *list, const void *src)
+{
+  assert(list->hdr->flags & ADT_IX_INLINE);
+  return ADT_ix_insert(list, ADT_IX_NIL, src);
+}
+
+/*
+ * Copy the payload at src into a new slot at the end of list.
+ * Pre: list must be a pointer to an initialized inline ADT_ix_list.
+ * Returns: 0 on success or -1 if the block could not grow.
+ */
+int
+ADT_ix_list_append_inline(struct ADT_ix_list *list, const void *src)
+{
+  assert(list->hdr->flags & ADT_IX_INLINE);
+  return ADT_ix_insert(list, list->hdr->tail, src);
+}
+
+/*
+ * Remove the head of list, copying its payload to dst.
+ * Pre: list must be a pointer to an initialized inline ADT_ix_list with at
+ *      least one element, and dst must have room for the payload.
+ */
+void
+ADT_ix_list_pop_inline(struct ADT_ix_list *list, void *dst)
+{
+  assert(list->hdr->flags & ADT_IX_INLINE);
+  ADT_check(list->hdr->len != 0, "pop from an empty list");
+  ADT_ix_remove(list, ADT_IX_NIL, dst);
+}
+
+/*
+ * Return the data in slot ix of a void * list.
+ * Pre: list must be a pointer to an initialized void * ADT_ix_list, and ix
+ *      *must* be a slot on the list.
+ */
+void *
+ADT_ix_list_get(struct ADT_ix_list *list, uint32_t ix)
+{
+  void *data;
+
+  memcpy(&data, ADT_ix_payload(list, ix), sizeof(data));
+  return data;
+}
+
+/*
+ * Find the first element of list equal to key: the data pointer itself on a
+ * void * list, or a pointer to payload bytes on an inline one.
+ * Pre: list must be a pointer to an initialized ADT_ix_list structure.
+ * Returns: the element's slot, or ADT_IX_NIL if there is none.
+ * Note: slots sit in link order, not block order, so this walks the links;
+ *       it only saves the comparator call per element.
+ */
+uint32_t
+ADT_ix_list_find(struct ADT_ix_list *list, const void *key)
+{
+  uint32_t ix;
+  size_t payload = list->hdr->payload;
+
+  if (list->hdr->flags & ADT_IX_INLINE) {
+    ADT_ix_list_foreach(list, ix) {
+      if (memcmp(ADT_ix_payload(list, ix), key, payload) == 0)
+        return ix;
+    }
+  } else {
+    ADT_ix_list_foreach(list, ix) {
+      if (memcmp(ADT_ix_payload(list, ix), &key, sizeof(key)) == 0)
+        return ix;
+    }
+  }
+  return ADT_IX_NIL;
+}
+
+/*
+ * Return the number of elements in list.
+ * Pre: list must be a pointer to an initialized ADT_ix_list structure.
+ */
+unsigned int
+ADT_ix_list_length(struct ADT_ix_list *list)
+{
+  return list->hdr->len;
+}
+
+/*
+ * Return the size in bytes of list's block, header included. Copying that
+ * many bytes from list->hdr gives a block ADT_ix_list_attach accepts.
+ * Pre: list must be a pointer to an initialized ADT_ix_list structure.
+ */
+size_t
+ADT_ix_list_size(struct ADT_ix_list *list)
+{
+  return sizeof(struct ADT_ix_header) + (size_t)list->hdr->cap * list->slot_size;
+}
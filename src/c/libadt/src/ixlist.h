@@ -0,0 +1,87 @@
+#ifndef _ADT_IXLIST_H
+#define _ADT_IXLIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "alloc.h"
+
+/*******************************************************************************
+ * Index linked list
+ *
+ * A single linked list whose nodes are slots of one contiguous block and
+ * link to each other by 32-bit slot index. The block starts with an
+ * ADT_ix_header holding every list field, followed by the slots; since
+ * nothing in it is a pointer, the block can be copied, grown or mapped
+ * anywhere and stays a valid list.
+ *
+ * A slot is a 32-bit next index followed by its payload: a void * by
+ * default, making a slot 12 bytes on LP64 against 16 plus allocator
+ * overhead for an ADT_sl_node, or with ADT_ix_list_init_inline a fixed
+ * number of bytes copied in and out of the slot. Payload bytes are not
+ * aligned; read them with memcpy. Removed slots are recycled through a
+ * free list, and the block doubles when it runs out.
+ */
+
+#define ADT_IX_NIL UINT32_MAX
+#define ADT_IX_INLINE 1                 /* header flags */
+/* Bytes per slot for a payload of the given size, keeping next aligned. */
+#define ADT_IX_SLOT_SIZE(payload) \
+  (sizeof(uint32_t) + (((payload) + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1)))
+
+struct ADT_ix_header {
+  uint32_t head;
+  uint32_t tail;
+  uint32_t free;                        /* recycled slots, linked by next */
+  uint32_t len;
+  uint32_t cap;                         /* slots in the block */
+  uint32_t used;                        /* slots handed out so far; the rest are fresh */
+  uint32_t payload;                     /* payload bytes per slot */
+  uint32_t flags;
+};
+
+struct ADT_ix_list {
+  struct ADT_ix_header *hdr;            /* the block */
+  size_t slot_size;
+  /* Resize the block to hold cap slots, updating hdr; -1 if it cannot. */
+  int (*grow)(struct ADT_ix_list *, uint32_t cap);
+  void *ctx;                            /* for grow */
+};
+
+int ADT_ix_list_init(struct ADT_ix_list *);
+int ADT_ix_list_init_inline(struct ADT_ix_list *, size_t);
+int ADT_ix_list_init_alloc(struct ADT_ix_list *, size_t, const struct ADT_allocator *);
+int ADT_ix_list_attach(struct ADT_ix_list *, struct ADT_ix_header *,
+                       int (*grow)(struct ADT_ix_list *, uint32_t), void *);
+void ADT_ix_list_destroy(struct ADT_ix_list *, void (*destroy)(void *));
+int ADT_ix_list_reserve(struct ADT_ix_list *, uint32_t);
+int ADT_ix_list_push(struct ADT_ix_list *, void *);
+int ADT_ix_list_append(struct ADT_ix_list *, void *);
+void ADT_ix_list_pop(struct ADT_ix_list *, void **);
+int ADT_ix_list_insert_after(struct ADT_ix_list *, uint32_t, void *);
+void ADT_ix_list_remove_after(struct ADT_ix_list *, uint32_t, void **);
+int ADT_ix_list_push_inline(struct ADT_ix_list *, const void *);
+int ADT_ix_list_append_inline(struct ADT_ix_list *, const void *);
+void ADT_ix_list_pop_inline(struct ADT_ix_list *, void *);
+void *ADT_ix_list_get(struct ADT_ix_list *, uint32_t);
+uint32_t ADT_ix_list_find(struct ADT_ix_list *, const void *);
+unsigned int ADT_ix_list_length(struct ADT_ix_list *);
+size_t ADT_ix_list_size(struct ADT_ix_list *);
+#define ADT_ix_list_enqueue(list, data) ADT_ix_list_append(list, data)
+#define ADT_ix_list_dequeue(list, data) ADT_ix_list_pop(list, data)
+
+/*
+ * Slot access, mostly for walking a list:
+ *
+ *   ADT_ix_list_foreach(list, ix)
+ *     visit(ADT_ix_list_get(list, ix));
+ */
+
+#define ADT_ix_slot(list, ix) \
+  ((char *)((list)->hdr + 1) + (size_t)(ix) * (list)->slot_size)
+#define ADT_ix_next(list, ix) (*(uint32_t *)ADT_ix_slot(list, ix))
+#define ADT_ix_payload(list, ix) (ADT_ix_slot(list, ix) + sizeof(uint32_t))
+#define ADT_ix_list_foreach(list, ix) \
+  for ((ix) = (list)->hdr->head; (ix) != ADT_IX_NIL; (ix) = ADT_ix_next(list, ix))
+
+
+#endif
@@ -1,133 +1,173 @@
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#undef ADT_INLINE
 #include "list.h"
 #ifdef DMALLOC
   #include "dmalloc.h"
 #endif
 
+/* Emit the out-of-line copies of the hot-path operations. */
+#define ADT_SL_INLINE
+#include "list_inline.h"
+
+/* Enough pending runs of ADT_sl_list_sort for any unsigned int length. */
+#define ADT_SL_SORT_RUNS (8 * sizeof(unsigned int))
+
 /*
  * Return a new initialized Single Linked List.
  * Pre: list is a pointer to a newly created ADT_sl_list.
  * Post: list's head and tail will be set to NULL. The length
- * list will be zero.
+ * list will be zero. Nodes come from the library-wide allocator.
  */
 void
 ADT_sl_list_init(struct ADT_sl_list *list)
+{
+  ADT_sl_list_init_alloc(list, ADT_get_allocator());
+}
+
+/*
+ * Return a new initialized Single Linked List whose nodes come from alloc.
+ * Pre: list is a pointer to a newly created ADT_sl_list, and alloc must
+ *      outlive the list.
+ * Post: list is empty. If alloc has no free function the list never frees
+ *       nodes itself, the allocator's owner reclaims them in bulk.
+ */
+void
+ADT_sl_list_init_alloc(struct ADT_sl_list *list, const struct ADT_allocator *alloc)
 {
   list->head = NULL;
   list->tail = NULL;
   list->len = 0;
+  list->alloc = alloc;
+}
+
+/*
+ * Return a new initialized Single Linked List whose nodes come from pool.
+ * Pre: list is a pointer to a newly created ADT_sl_list, and pool is an
+ *      ADT_pool initialized with ADT_sl_pool_init. The pool may be shared
+ *      with other lists and must outlive all of them.
+ * Post: list is empty, and every node it allocates is taken from and
+ *       returned to pool.
+ */
+void
+ADT_sl_list_init_pooled(struct ADT_sl_list *list, struct ADT_pool *pool)
+{
+  ADT_sl_list_init_alloc(list, &pool->allocator);
+}
+
+/*
+ * Initialize pool for handing out ADT_sl_node structures, per_chunk nodes
+ * to a chunk.
+ * Returns: 0 on success or -1 if per_chunk is zero.
+ */
+int
+ADT_sl_pool_init(struct ADT_pool *pool, unsigned int per_chunk)
+{
+  return ADT_pool_init(pool, sizeof(struct ADT_sl_node), per_chunk);
 }
 
 /*
  * Remove all items from list and call the designated destory fn
  * to free list data.
  * Pre: list must be a pointer to an initialized ADT_sl_list structure,
- *      and destory must be valid function for freeing list data.
+ *      and destory must be valid function for freeing list data or NULL
+ *      if the list does not own its data.
  * Post: list nodes are all destoryed. list head and tail are set
  *       to NULL.
+ * Note: With no destroy fn and an allocator that reclaims in bulk there is
+ *       nothing to do per node, and the list is dropped in constant time.
  */
 void
 ADT_sl_list_destroy(struct ADT_sl_list *list, void (*destroy)(void *))
 {
   void *data = NULL;
 
+  if (destroy == NULL && list->alloc->free == NULL) {
+    ADT_STATS_ADD(nodes_freed, list->len);
+    list->len = 0;
+  }
   while (ADT_sl_list_length(list) != 0) {
     ADT_sl_list_pop(list, (void *)&data);
-    (*destroy)(data);
+    if (destroy != NULL)
+      (*destroy)(data);
   }
   list->head = NULL;
   list->tail = NULL;
 }
 
 /*
- * Insert data at the head of list.
- * Pre: list must be a pointer to an initialized ADT_sl_list structure.
- * Post: data will be located in a node at the head of list, and the
- *       list length will be increased by one.
- * Returns: 0 on success or -1 on a malloc error.
- *
+ * Detach every node of list into r in constant time, leaving the nodes and
+ * the data to be released later by ADT_sl_reclaim_step, so the caller does
+ * not pay for tearing down a long list all at once.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure and r
+ *      a pointer to an ADT_sl_reclaim. destroy may be NULL if the list does
+ *      not own its data.
+ * Post: list is empty and may be used again. r holds the old nodes, or
+ *       none if the allocator reclaims in bulk and there is no destroy fn.
  */
-int
-ADT_sl_list_push(struct ADT_sl_list *list, void *data)
+void
+ADT_sl_list_destroy_deferred(struct ADT_sl_list *list, void (*destroy)(void *),
+                             struct ADT_sl_reclaim *r)
 {
-  struct ADT_sl_node *node = (struct ADT_sl_node *)malloc(sizeof(struct ADT_sl_node));
-
-  if (node == NULL)
-    return -1;
-  if (ADT_sl_list_length(list) == 0) {
-    list->tail = node;
+  r->chain = list->head;
+  r->len = list->len;
+  r->alloc = list->alloc;
+  r->destroy = destroy;
+  if (destroy == NULL && list->alloc->free == NULL) {
+    ADT_STATS_ADD(nodes_freed, list->len);
+    r->chain = NULL;
+    r->len = 0;
   }
-  node->data = data;
-  node->next = list->head;
-  list->head = node;
-  list->len++;
-  return 0;
+  list->head = NULL;
+  list->tail = NULL;
+  list->len = 0;
 }
 
 /*
- * Remove data from the head of list.
- * Pre: list must be a pointer to an initialized ADT_sl_list structure.
- * Post: The node at the head of list is destroyed and data points
- *       to the data previously held in node. List length is reduced
- *       by one.
- * Note: This routine will abort and die if an attempt is made to
- *       pop from an empty list.
+ * Release up to max of the nodes detached into r, calling its destroy fn
+ * on their data, e.g. a bounded slice per event loop turn.
+ * Pre: r must be a pointer to an ADT_sl_reclaim filled by
+ *      ADT_sl_list_destroy_deferred. Its allocator must allow frees from
+ *      the calling thread.
+ * Returns: the number of nodes still to release; 0 once r is done.
  */
-void
-ADT_sl_list_pop(struct ADT_sl_list *list, void **data)
+size_t
+ADT_sl_reclaim_step(struct ADT_sl_reclaim *r, size_t max)
 {
   struct ADT_sl_node *node;
+  size_t n = (max < r->len) ? max : r->len, i;
 
-  assert(ADT_sl_list_length(list) != 0);
-  node = list->head;
-  *data = list->head->data;
-  list->head = node->next;
-  list->len--;
-  free(node);
-  node = NULL;
-}
-
-/*
- * Insert data to the end of list.
- * Pre: list must be a pointer to an initialized ADT_sl_list structure.
- * Post: data will be contained in a node at the end of list. List
- *       length will be increased by one.
- * Returns: 0 on success, or -1 on malloc failure.
- *
- */
-int
-ADT_sl_list_append(struct ADT_sl_list *list, void *data)
-{
-  struct ADT_sl_node *node = NULL;
-
-  if (ADT_sl_list_length(list) == 0) {
-    ADT_sl_list_push(list, data);
-  } else {
-    node = (struct ADT_sl_node *)malloc(sizeof(struct ADT_sl_node));
-    if (node == NULL)
-      return -1;
-    node->data = data;
-    node->next = NULL;
-    list->tail->next = node;
-    list->tail = node;
-    list->len++;
+  for (i = 0; i < n; i++) {
+    node = r->chain;
+    r->chain = node->next;
+    if (r->destroy != NULL)
+      (*r->destroy)(node->data);
+    ADT_STATS_ADD(nodes_freed, 1);
+    ADT_canary_check(node);
+    ADT_poison(node);
+    if (r->alloc->free != NULL)
+      (*r->alloc->free)(r->alloc->ctx, node);
   }
-  return 0;
+  r->len -= n;
+  return r->len;
 }
 
 /*
  * Insert data into list immediately after loc.
  * Pre: list must be a pointer to an initialized ADT_sl_list structure, and loc
  *      *must* be a pointer to an actual node.
- * Returns: 0 on success or -1 on malloc failure.
+ * Returns: 0 on success or -1 on allocation failure.
  *
  */
 int
 ADT_sl_list_insert_after(struct ADT_sl_list *list, struct ADT_sl_node *loc, void *data)
 {
-  struct ADT_sl_node *node = (struct ADT_sl_node *)malloc(sizeof(struct ADT_sl_node));
+  struct ADT_sl_node *node;
 
+  ADT_STATS_BEGIN(ADT_STATS_INSERT);
+  ADT_canary_check(loc);
+  node = ADT_sl_node_alloc(list);
   if (node == NULL)
     return -1;
   if (loc == list->tail) {
@@ -137,6 +177,8 @@ ADT_sl_list_insert_after(struct ADT_sl_list *list, struct ADT_sl_node *loc, void
   node->next = loc->next;
   loc->next = node;
   list->len++;
+  ADT_STATS_LENGTH(list->len);
+  ADT_STATS_END(ADT_STATS_INSERT);
   return 0;
 }
 
@@ -152,16 +194,613 @@ void
 ADT_sl_list_remove_after(struct ADT_sl_list *list, struct ADT_sl_node *loc, void **data)
 {
   struct ADT_sl_node *ptr;
-  assert(loc != list->tail);
+  ADT_STATS_BEGIN(ADT_STATS_REMOVE);
+  ADT_canary_check(loc);
+  ADT_check(loc != list->tail, "remove after the tail");
   ptr = loc->next;
   *data = loc->next->data;
   loc->next = loc->next->next;
-  free(ptr);
+  if (ptr == list->tail)
+    list->tail = loc;
+  ADT_sl_node_free(list, ptr);
+  list->len--;
+  ADT_STATS_END(ADT_STATS_REMOVE);
+}
+
+/*
+ * Start an iteration over list at its head.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure, which
+ *      must not lose nodes while the iteration is in progress.
+ * Post: the first ADT_PREFETCH_DISTANCE nodes and the data of all but the
+ *       last of them have been prefetched.
+ */
+void
+ADT_sl_iter_init(struct ADT_sl_iter *iter, struct ADT_sl_list *list)
+{
+  struct ADT_sl_node *ahead = list->head;
+  int i;
+
+  iter->node = list->head;
+  /* Walking the cursor out stalls once per node, but only this once. */
+  for (i = 1; i < ADT_PREFETCH_DISTANCE && ahead != NULL; i++) {
+    ADT_prefetch(ahead->data);
+    ahead = ahead->next;
+    if (ahead != NULL)
+      ADT_prefetch(ahead);
+  }
+  iter->ahead = ahead;
+}
+
+/*
+ * Call fn(data, ctx) for the data of every node of list, head to tail,
+ * prefetching ahead of the callback.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure, and
+ *      fn must not remove nodes from list.
+ */
+void
+ADT_sl_list_map(struct ADT_sl_list *list, void (*fn)(void *, void *), void *ctx)
+{
+  struct ADT_sl_iter iter;
+  void *data;
+
+  ADT_sl_iter_init(&iter, list);
+  while (ADT_sl_iter_next(&iter, &data) == 0)
+    (*fn)(data, ctx);
+}
+
+/*
+ * Allocate and link a chain of n nodes holding items in order. On failure
+ * the partial chain is released and nothing is returned.
+ */
+static int
+ADT_sl_chain_build(struct ADT_sl_list *list, void **items, size_t n,
+                   struct ADT_sl_node **first, struct ADT_sl_node **last)
+{
+  struct ADT_sl_node *head = NULL, *tail = NULL, *node;
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    node = ADT_sl_node_alloc(list);
+    if (node == NULL) {
+      while (head != NULL) {
+        node = head;
+        head = head->next;
+        ADT_sl_node_free(list, node);
+      }
+      return -1;
+    }
+    node->data = items[i];
+    node->next = NULL;
+    if (tail == NULL)
+      head = node;
+    else
+      tail->next = node;
+    tail = node;
+  }
+  *first = head;
+  *last = tail;
+  return 0;
+}
+
+/*
+ * Insert items[0] through items[n - 1] at the head of list, keeping their
+ * order, so items[0] becomes the new head.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure.
+ * Post: list length is increased by n. head, tail and len are each updated
+ *       once for the whole batch.
+ * Returns: 0 on success or -1 on an allocation error, in which case list
+ *          is unchanged.
+ */
+int
+ADT_sl_list_push_n(struct ADT_sl_list *list, void **items, size_t n)
+{
+  struct ADT_sl_node *first, *last;
+
+  if (n == 0)
+    return 0;
+  if (ADT_sl_chain_build(list, items, n, &first, &last) != 0)
+    return -1;
+  if (list->len == 0)
+    list->tail = last;
+  last->next = list->head;
+  list->head = first;
+  list->len += n;
+  ADT_STATS_LENGTH(list->len);
+  return 0;
+}
+
+/*
+ * Insert items[0] through items[n - 1] at the end of list, in order.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure.
+ * Post: list length is increased by n. head, tail and len are each updated
+ *       once for the whole batch.
+ * Returns: 0 on success or -1 on an allocation error, in which case list
+ *          is unchanged.
+ */
+int
+ADT_sl_list_append_n(struct ADT_sl_list *list, void **items, size_t n)
+{
+  struct ADT_sl_node *first, *last;
+
+  if (n == 0)
+    return 0;
+  if (ADT_sl_chain_build(list, items, n, &first, &last) != 0)
+    return -1;
+  if (list->len == 0)
+    list->head = first;
+  else
+    list->tail->next = first;
+  list->tail = last;
+  list->len += n;
+  ADT_STATS_LENGTH(list->len);
+  return 0;
+}
+
+/*
+ * Remove up to max items from the head of list into out, in order.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure, and
+ *      out must have room for max pointers.
+ * Post: the removed nodes are released together after list is updated.
+ * Returns: the number of items removed, which is less than max only if the
+ *          list ran out. Unlike ADT_sl_list_pop an empty list is not an
+ *          error.
+ */
+size_t
+ADT_sl_list_pop_n(struct ADT_sl_list *list, void **out, size_t max)
+{
+  struct ADT_sl_node *chain = list->head, *node;
+  size_t i, n = (max < list->len) ? max : list->len;
+
+  if (n == 0)
+    return 0;
+  node = chain;
+  for (i = 0; i < n; i++) {
+    out[i] = node->data;
+    node = node->next;
+  }
+  list->head = node;
+  list->len -= n;
+  if (list->len == 0)
+    list->tail = NULL;
+  if (list->alloc->free != NULL) {
+    for (i = 0; i < n; i++) {
+      node = chain;
+      chain = chain->next;
+      ADT_sl_node_free(list, node);
+    }
+  } else {
+    ADT_STATS_ADD(nodes_freed, n);
+  }
+  return n;
+}
+
+/*
+ * Move every node of src to the end of dst in constant time.
+ * Pre: dst and src must be pointers to distinct initialized ADT_sl_list
+ *      structures sharing the same allocator, since nodes change owner.
+ * Post: dst holds its own nodes followed by those of src, and src is empty.
+ */
+void
+ADT_sl_list_splice(struct ADT_sl_list *dst, struct ADT_sl_list *src)
+{
+  assert(dst != src && dst->alloc == src->alloc);
+  if (src->len == 0)
+    return;
+  if (dst->len == 0)
+    dst->head = src->head;
+  else
+    dst->tail->next = src->head;
+  dst->tail = src->tail;
+  dst->len += src->len;
+  src->head = NULL;
+  src->tail = NULL;
+  src->len = 0;
+}
+
+/*
+ * Move every node after loc to the end of out without allocating.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure, loc
+ *      *must* be a pointer to an actual node of list, and out must be a
+ *      distinct initialized ADT_sl_list sharing list's allocator.
+ * Post: loc is the tail of list and the moved suffix ends out.
+ * Note: Relinking is constant time; keeping the lengths right costs one
+ *       walk over the moved suffix.
+ */
+void
+ADT_sl_list_split_after(struct ADT_sl_list *list, struct ADT_sl_node *loc,
+                        struct ADT_sl_list *out)
+{
+  struct ADT_sl_node *node;
+  unsigned int n = 0;
+
+  assert(list != out && list->alloc == out->alloc);
+  ADT_canary_check(loc);
+  if (loc == list->tail)
+    return;
+  for (node = loc->next; node != NULL; node = node->next)
+    n++;
+  if (out->len == 0)
+    out->head = loc->next;
+  else
+    out->tail->next = loc->next;
+  out->tail = list->tail;
+  out->len += n;
+  loc->next = NULL;
+  list->tail = loc;
+  list->len -= n;
+}
+
+/*
+ * Merge the sorted chains a and b, taking from a on ties so the merge is
+ * stable. *tail is set to the last node of the result.
+ */
+static struct ADT_sl_node *
+ADT_sl_chain_merge(struct ADT_sl_node *a, struct ADT_sl_node *a_tail,
+                   struct ADT_sl_node *b, struct ADT_sl_node *b_tail,
+                   int (*cmp)(const void *, const void *, void *), void *ctx,
+                   struct ADT_sl_node **tail)
+{
+  struct ADT_sl_node head, *t = &head;
+
+  while (a != NULL && b != NULL) {
+    if ((*cmp)(a->data, b->data, ctx) <= 0) {
+      t->next = a;
+      a = a->next;
+    } else {
+      t->next = b;
+      b = b->next;
+    }
+    t = t->next;
+  }
+  if (a != NULL) {
+    t->next = a;
+    *tail = a_tail;
+  } else {
+    t->next = b;
+    *tail = (b != NULL) ? b_tail : t;
+  }
+  return head.next;
+}
+
+/*
+ * Sort list in place with cmp(a, b, ctx), which returns less than, equal to
+ * or greater than zero as a sorts before, with or after b. The sort is
+ * stable and only relinks nodes.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure.
+ * Post: list holds the same nodes in sorted order, and tail is its last node.
+ * Note: A bottom-up merge sort that keeps one pending run per power of two,
+ *       so it needs O(log n) stack and never allocates.
+ */
+void
+ADT_sl_list_sort(struct ADT_sl_list *list, int (*cmp)(const void *, const void *, void *),
+                 void *ctx)
+{
+  struct ADT_sl_node *runs[ADT_SL_SORT_RUNS], *tails[ADT_SL_SORT_RUNS];
+  struct ADT_sl_node *node, *next, *carry, *carry_tail;
+  unsigned int i, top = 0;
+
+  if (list->len < 2)
+    return;
+  for (node = list->head; node != NULL; node = next) {
+    next = node->next;
+    node->next = NULL;
+    carry = carry_tail = node;
+    /* runs[i] holds 2^i nodes that all come before carry. */
+    for (i = 0; i < top && runs[i] != NULL; i++) {
+      carry = ADT_sl_chain_merge(runs[i], tails[i], carry, carry_tail, cmp, ctx, &carry_tail);
+      runs[i] = NULL;
+    }
+    if (i == top)
+      top++;
+    runs[i] = carry;
+    tails[i] = carry_tail;
+  }
+  carry = NULL;
+  carry_tail = NULL;
+  for (i = 0; i < top; i++) {
+    if (runs[i] == NULL)
+      continue;
+    if (carry == NULL) {
+      carry = runs[i];
+      carry_tail = tails[i];
+    } else {
+      carry = ADT_sl_chain_merge(runs[i], tails[i], carry, carry_tail, cmp, ctx, &carry_tail);
+    }
+  }
+  list->head = carry;
+  list->tail = carry_tail;
+}
+
+/*
+ * Merge the sorted list src into the sorted list dst.
+ * Pre: dst and src must be pointers to distinct initialized ADT_sl_list
+ *      structures sharing the same allocator, both sorted by cmp.
+ * Post: dst holds the nodes of both in sorted order, those of dst first
+ *       among equals, and src is empty.
+ */
+void
+ADT_sl_list_merge(struct ADT_sl_list *dst, struct ADT_sl_list *src,
+                  int (*cmp)(const void *, const void *, void *), void *ctx)
+{
+  assert(dst != src && dst->alloc == src->alloc);
+  if (src->len == 0)
+    return;
+  if (dst->len == 0) {
+    ADT_sl_list_splice(dst, src);
+    return;
+  }
+  dst->head = ADT_sl_chain_merge(dst->head, dst->tail, src->head, src->tail, cmp, ctx,
+                                 &dst->tail);
+  dst->len += src->len;
+  src->head = NULL;
+  src->tail = NULL;
+  src->len = 0;
+}
+
+/*
+ * Merge the k sorted lists of srcs onto the end of dst.
+ * Pre: dst and the lists of srcs must be distinct initialized ADT_sl_list
+ *      structures sharing the same allocator, and each of srcs sorted by cmp.
+ * Post: the nodes of every list of srcs follow those of dst in sorted order,
+ *       earlier lists first among equals, and every list of srcs is empty.
+ * Note: Lists are merged pairwise, neighbours first, for O(n log k)
+ *       comparisons without allocating.
+ */
+void
+ADT_sl_list_merge_n(struct ADT_sl_list *dst, struct ADT_sl_list **srcs, size_t k,
+                    int (*cmp)(const void *, const void *, void *), void *ctx)
+{
+  size_t i, step;
+
+  if (k == 0)
+    return;
+  for (step = 1; step < k; step *= 2) {
+    for (i = 0; i + step < k; i += 2 * step)
+      ADT_sl_list_merge(srcs[i], srcs[i + step], cmp, ctx);
+  }
+  ADT_sl_list_splice(dst, srcs[0]);
+}
+
+/*
+ * Copy the data pointers of up to max nodes of list, head first, into out
+ * in a single walk.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure, and
+ *      out must have room for max pointers.
+ * Returns: the number of pointers copied, the smaller of max and the list
+ *          length. list is unchanged.
+ */
+size_t
+ADT_sl_list_to_array(struct ADT_sl_list *list, void **out, size_t max)
+{
+  struct ADT_sl_node *node = list->head;
+  size_t i, n = (max < list->len) ? max : list->len;
+
+  for (i = 0; i < n; i++) {
+    out[i] = node->data;
+    node = node->next;
+  }
+  return n;
+}
+
+/*
+ * Describe the data of up to max nodes of list, head first, as iovecs for
+ * writev or sendmsg, so the elements go out without being copied.
+ * size(data, ctx) gives the number of bytes at each data pointer.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure, and
+ *      iov must have room for max entries.
+ * Returns: the number of entries filled, the smaller of max and the list
+ *          length. They point into the elements, so are valid only while
+ *          those are.
+ */
+size_t
+ADT_sl_list_to_iovec(struct ADT_sl_list *list, struct iovec *iov, size_t max,
+                     size_t (*size)(const void *, void *), void *ctx)
+{
+  struct ADT_sl_node *node = list->head;
+  size_t i, n = (max < list->len) ? max : list->len;
+
+  for (i = 0; i < n; i++) {
+    iov[i].iov_base = node->data;
+    iov[i].iov_len = (*size)(node->data, ctx);
+    node = node->next;
+  }
+  return n;
+}
+
+/*
+ * Encode list into buf as a uint32_t element count followed by each
+ * element as a uint32_t length and the bytes codec encodes it to, all in
+ * host byte order. Nothing is written unless the whole encoding fits, so
+ * a call with len 0 measures the buffer to allocate.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure, and
+ *      no element may encode to 4 GiB or more.
+ * Returns: the size of the encoding in bytes, written to buf only if it is
+ *          no more than len.
+ */
+size_t
+ADT_sl_list_serialize(struct ADT_sl_list *list, const struct ADT_sl_codec *codec,
+                      void *buf, size_t len)
+{
+  struct ADT_sl_node *node;
+  size_t total = sizeof(uint32_t), n;
+  char *p = (char *)buf;
+  uint32_t u;
+
+  ADT_sl_list_foreach(list, node)
+    total += sizeof(uint32_t) + (*codec->size)(node->data, codec->ctx);
+  if (total > len)
+    return total;
+  u = list->len;
+  memcpy(p, &u, sizeof(u));
+  p += sizeof(u);
+  ADT_sl_list_foreach(list, node) {
+    n = (*codec->size)(node->data, codec->ctx);
+    assert(n <= UINT32_MAX);
+    u = (uint32_t)n;
+    memcpy(p, &u, sizeof(u));
+    p += sizeof(u);
+    (*codec->encode)(node->data, p, codec->ctx);
+    p += n;
+  }
+  return total;
+}
+
+/*
+ * Decode an encoding made by ADT_sl_list_serialize from the len bytes at
+ * buf, appending the elements codec builds to list.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure.
+ * Post: on failure list is unchanged, and the elements decoded so far are
+ *       passed to destroy unless it is NULL.
+ * Returns: 0 on success or -1 if buf is truncated or malformed, codec
+ *          fails to decode an element or a node cannot be allocated.
+ */
+int
+ADT_sl_list_deserialize(struct ADT_sl_list *list, const struct ADT_sl_codec *codec,
+                        const void *buf, size_t len, void (*destroy)(void *))
+{
+  struct ADT_sl_list tmp;
+  const char *p = (const char *)buf, *end = p + len;
+  uint32_t count, n, i;
+  void *data;
+
+  if (len < sizeof(count))
+    return -1;
+  memcpy(&count, p, sizeof(count));
+  p += sizeof(count);
+  ADT_sl_list_init_alloc(&tmp, list->alloc);
+  for (i = 0; i < count; i++) {
+    if ((size_t)(end - p) < sizeof(n))
+      goto fail;
+    memcpy(&n, p, sizeof(n));
+    p += sizeof(n);
+    if ((size_t)(end - p) < n)
+      goto fail;
+    data = (*codec->decode)(p, n, codec->ctx);
+    if (data == NULL)
+      goto fail;
+    if (ADT_sl_list_append(&tmp, data) != 0) {
+      if (destroy != NULL)
+        (*destroy)(data);
+      goto fail;
+    }
+    p += n;
+  }
+  if (p != end)
+    goto fail;
+  ADT_sl_list_splice(list, &tmp);
+  return 0;
+
+fail:
+  ADT_sl_list_destroy(&tmp, destroy);
+  return -1;
+}
+
+/*
+ * Return a new initialized Intrusive Single Linked List.
+ * Pre: list is a pointer to a newly created ADT_sl_ilist.
+ * Post: list's head and tail will be set to NULL. The length
+ * list will be zero.
+ */
+void
+ADT_sl_ilist_init(struct ADT_sl_ilist *list)
+{
+  list->head = NULL;
+  list->tail = NULL;
+  list->len = 0;
+}
+
+/*
+ * Link link in at the head of list.
+ * Pre: list must be a pointer to an initialized ADT_sl_ilist structure, and
+ *      link must not currently be on any list.
+ * Post: link is the head of list, and the list length is increased by one.
+ */
+void
+ADT_sl_ilist_push(struct ADT_sl_ilist *list, struct ADT_sl_link *link)
+{
+  if (list->len == 0)
+    list->tail = link;
+  link->next = list->head;
+  list->head = link;
+  list->len++;
+}
+
+/*
+ * Unlink the head of list.
+ * Pre: list must be a pointer to an initialized ADT_sl_ilist structure.
+ * Post: link points to the former head of list, which is no longer linked.
+ *       List length is reduced by one.
+ * Note: This routine will abort and die if an attempt is made to
+ *       pop from an empty list.
+ */
+void
+ADT_sl_ilist_pop(struct ADT_sl_ilist *list, struct ADT_sl_link **link)
+{
+  ADT_check(list->len != 0, "pop from an empty list");
+  *link = list->head;
+  list->head = list->head->next;
+  if (--list->len == 0)
+    list->tail = NULL;
+  (*link)->next = NULL;
+}
+
+/*
+ * Link link in at the end of list.
+ * Pre: list must be a pointer to an initialized ADT_sl_ilist structure, and
+ *      link must not currently be on any list.
+ * Post: link is the tail of list, and the list length is increased by one.
+ */
+void
+ADT_sl_ilist_append(struct ADT_sl_ilist *list, struct ADT_sl_link *link)
+{
+  link->next = NULL;
+  if (list->len == 0)
+    list->head = link;
+  else
+    list->tail->next = link;
+  list->tail = link;
+  list->len++;
+}
+
+/*
+ * Link link into list immediately after loc.
+ * Pre: list must be a pointer to an initialized ADT_sl_ilist structure, loc
+ *      *must* be a link on list, and link must not be on any list.
+ */
+void
+ADT_sl_ilist_insert_after(struct ADT_sl_ilist *list, struct ADT_sl_link *loc,
+                          struct ADT_sl_link *link)
+{
+  if (loc == list->tail)
+    list->tail = link;
+  link->next = loc->next;
+  loc->next = link;
+  list->len++;
+}
+
+/*
+ * Unlink the link immediately after loc. Upon completion link points to the
+ * removed link.
+ * Pre: list must be a pointer to an initialized ADT_sl_ilist structure, and
+ *      loc *must* be a link on list.
+ * Notes: This routine will abort and die if loc is the last link in
+ *        list (tail). i.e. There is nothing to remove.
+ */
+void
+ADT_sl_ilist_remove_after(struct ADT_sl_ilist *list, struct ADT_sl_link *loc,
+                          struct ADT_sl_link **link)
+{
+  ADT_check(loc != list->tail, "remove after the tail");
+  *link = loc->next;
+  loc->next = (*link)->next;
+  if (*link == list->tail)
+    list->tail = loc;
+  (*link)->next = NULL;
   list->len--;
 }
 
 unsigned int
-ADT_sl_list_length(struct ADT_sl_list *list)
+ADT_sl_ilist_length(struct ADT_sl_ilist *list)
 {
   return list->len;
 }
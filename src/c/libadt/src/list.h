@@ -1,31 +1,155 @@
 #ifndef _ADT_LIST_H
 #define _ADT_LIST_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include "alloc.h"
+#include "cache.h"
+#include "pool.h"
+#include "harden.h"
+
 /*******************************************************************************
  * Single linked list
+ *
+ * Define ADT_INLINE before including this header to get push, pop, append,
+ * length and ADT_sl_iter_next as static inline functions, so tight loops do not pay a call
+ * through the shared library. libadt exports them either way.
  */
 
 struct ADT_sl_node {
   void *data;
   struct ADT_sl_node *next;
+#if ADT_HARDEN > 1
+  uintptr_t canary;
+#endif
 };
 
 struct ADT_sl_list {
   struct ADT_sl_node *head;
   struct ADT_sl_node *tail;
   unsigned int len;
+  const struct ADT_allocator *alloc;    /* node source */
+};
+
+/* Nodes detached by ADT_sl_list_destroy_deferred, awaiting release. */
+struct ADT_sl_reclaim {
+  struct ADT_sl_node *chain;
+  size_t len;
+  const struct ADT_allocator *alloc;
+  void (*destroy)(void *);
 };
 
 void ADT_sl_list_init(struct ADT_sl_list *);
+void ADT_sl_list_init_alloc(struct ADT_sl_list *, const struct ADT_allocator *);
+void ADT_sl_list_init_pooled(struct ADT_sl_list *, struct ADT_pool *);
+int ADT_sl_pool_init(struct ADT_pool *, unsigned int);
 void ADT_sl_list_destroy(struct ADT_sl_list *, void (*destroy)(void *));
+void ADT_sl_list_destroy_deferred(struct ADT_sl_list *, void (*destroy)(void *),
+                                  struct ADT_sl_reclaim *);
+size_t ADT_sl_reclaim_step(struct ADT_sl_reclaim *, size_t);
+#ifndef ADT_INLINE
 int ADT_sl_list_push(struct ADT_sl_list *, void *);
 void ADT_sl_list_pop(struct ADT_sl_list *, void **);
 int ADT_sl_list_append(struct ADT_sl_list *, void *);
+unsigned int ADT_sl_list_length(struct ADT_sl_list *);
+#endif
 int ADT_sl_list_insert_after(struct ADT_sl_list *, struct ADT_sl_node *, void *);
 void ADT_sl_list_remove_after(struct ADT_sl_list *, struct ADT_sl_node *, void **);
-unsigned int ADT_sl_list_length(struct ADT_sl_list *);
+int ADT_sl_list_push_n(struct ADT_sl_list *, void **, size_t);
+int ADT_sl_list_append_n(struct ADT_sl_list *, void **, size_t);
+size_t ADT_sl_list_pop_n(struct ADT_sl_list *, void **, size_t);
+void ADT_sl_list_splice(struct ADT_sl_list *, struct ADT_sl_list *);
+void ADT_sl_list_split_after(struct ADT_sl_list *, struct ADT_sl_node *, struct ADT_sl_list *);
+void ADT_sl_list_sort(struct ADT_sl_list *, int (*cmp)(const void *, const void *, void *),
+                      void *);
+void ADT_sl_list_merge(struct ADT_sl_list *, struct ADT_sl_list *,
+                       int (*cmp)(const void *, const void *, void *), void *);
+void ADT_sl_list_merge_n(struct ADT_sl_list *, struct ADT_sl_list **, size_t,
+                         int (*cmp)(const void *, const void *, void *), void *);
 #define ADT_sl_list_enqueue(list, data) ADT_sl_list_append(list, data)
 #define ADT_sl_list_dequeue(list, data) ADT_sl_list_pop(list, data)
 
+/*
+ * Bulk export. ADT_sl_list_to_array and ADT_sl_list_to_iovec snapshot the
+ * data pointers in one walk, the latter ready for writev. Serialization
+ * encodes the elements themselves through a caller's codec.
+ */
+
+struct ADT_sl_codec {
+  size_t (*size)(const void *data, void *ctx);       /* bytes data encodes to */
+  void (*encode)(const void *data, void *buf, void *ctx); /* write them to buf */
+  /* Build an element from len bytes at buf, or NULL on error. */
+  void *(*decode)(const void *buf, size_t len, void *ctx);
+  void *ctx;
+};
+
+size_t ADT_sl_list_to_array(struct ADT_sl_list *, void **, size_t);
+size_t ADT_sl_list_to_iovec(struct ADT_sl_list *, struct iovec *, size_t,
+                            size_t (*size)(const void *, void *), void *);
+size_t ADT_sl_list_serialize(struct ADT_sl_list *, const struct ADT_sl_codec *, void *, size_t);
+int ADT_sl_list_deserialize(struct ADT_sl_list *, const struct ADT_sl_codec *, const void *,
+                            size_t, void (*destroy)(void *));
+
+/*
+ * Traversal. ADT_sl_list_foreach is the plain walk; it must not free the
+ * current node. An ADT_sl_iter and ADT_sl_list_map keep a cursor running
+ * ADT_PREFETCH_DISTANCE nodes ahead that prefetches each node, and its data
+ * a step later, once the node has arrived, while the caller works on the
+ * current one.
+ */
+
+#define ADT_sl_list_foreach(list, node) \
+  for ((node) = (list)->head; (node) != NULL; (node) = (node)->next)
+
+struct ADT_sl_iter {
+  struct ADT_sl_node *node;
+  struct ADT_sl_node *ahead;
+};
+
+void ADT_sl_iter_init(struct ADT_sl_iter *, struct ADT_sl_list *);
+#ifndef ADT_INLINE
+int ADT_sl_iter_next(struct ADT_sl_iter *, void **);
+#endif
+void ADT_sl_list_map(struct ADT_sl_list *, void (*fn)(void *, void *), void *);
+
+/*******************************************************************************
+ * Intrusive single linked list
+ *
+ * The caller embeds a struct ADT_sl_link in its own structure and the list
+ * links those directly, so no operation allocates. ADT_sl_ilist_entry maps a
+ * link back to the structure containing it.
+ */
+
+#define ADT_container_of(ptr, type, member) \
+  ((type *)((char *)(ptr) - offsetof(type, member)))
+#define ADT_sl_ilist_entry(link, type, member) ADT_container_of(link, type, member)
+
+struct ADT_sl_link {
+  struct ADT_sl_link *next;
+};
+
+struct ADT_sl_ilist {
+  struct ADT_sl_link *head;
+  struct ADT_sl_link *tail;
+  unsigned int len;
+};
+
+void ADT_sl_ilist_init(struct ADT_sl_ilist *);
+void ADT_sl_ilist_push(struct ADT_sl_ilist *, struct ADT_sl_link *);
+void ADT_sl_ilist_pop(struct ADT_sl_ilist *, struct ADT_sl_link **);
+void ADT_sl_ilist_append(struct ADT_sl_ilist *, struct ADT_sl_link *);
+void ADT_sl_ilist_insert_after(struct ADT_sl_ilist *, struct ADT_sl_link *, struct ADT_sl_link *);
+void ADT_sl_ilist_remove_after(struct ADT_sl_ilist *, struct ADT_sl_link *, struct ADT_sl_link **);
+unsigned int ADT_sl_ilist_length(struct ADT_sl_ilist *);
+#define ADT_sl_ilist_enqueue(list, link) ADT_sl_ilist_append(list, link)
+#define ADT_sl_ilist_dequeue(list, link) ADT_sl_ilist_pop(list, link)
+#define ADT_sl_ilist_foreach(list, link) \
+  for ((link) = (list)->head; (link) != NULL; (link) = (link)->next)
+
+#ifdef ADT_INLINE
+#include "list_inline.h"
+#endif
+
 
 #endif
@@ -0,0 +1,164 @@
+#ifndef _ADT_LIST_INLINE_H
+#define _ADT_LIST_INLINE_H
+
+/*******************************************************************************
+ * Single linked list hot path
+ *
+ * Included by list.h when ADT_INLINE is defined, making these operations
+ * static inline in the including file, and by list.c to build the exported
+ * copies. Do not include it directly.
+ */
+
+#include "harden.h"
+#include "stats.h"
+
+#ifndef ADT_SL_INLINE
+#define ADT_SL_INLINE static inline
+#endif
+
+static inline struct ADT_sl_node *
+ADT_sl_node_alloc(struct ADT_sl_list *list)
+{
+  struct ADT_sl_node *node;
+
+  node = (struct ADT_sl_node *)(*list->alloc->alloc)(list->alloc->ctx, sizeof(struct ADT_sl_node));
+  if (node == NULL)
+    return NULL;
+  ADT_STATS_ADD(nodes_allocated, 1);
+#if ADT_HARDEN > 1
+  ADT_canary_arm(node);
+#endif
+  return node;
+}
+
+static inline void
+ADT_sl_node_free(struct ADT_sl_list *list, struct ADT_sl_node *node)
+{
+  ADT_STATS_ADD(nodes_freed, 1);
+  ADT_canary_check(node);
+  ADT_poison(node);
+  if (list->alloc->free != NULL)
+    (*list->alloc->free)(list->alloc->ctx, node);
+}
+
+ADT_SL_INLINE unsigned int
+ADT_sl_list_length(struct ADT_sl_list *list)
+{
+  return list->len;
+}
+
+/*
+ * Insert data at the head of list.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure.
+ * Post: data will be located in a node at the head of list, and the
+ *       list length will be increased by one.
+ * Returns: 0 on success or -1 on an allocation error.
+ *
+ */
+ADT_SL_INLINE int
+ADT_sl_list_push(struct ADT_sl_list *list, void *data)
+{
+  struct ADT_sl_node *node;
+
+  ADT_STATS_BEGIN(ADT_STATS_PUSH);
+  node = ADT_sl_node_alloc(list);
+  if (node == NULL)
+    return -1;
+  if (ADT_sl_list_length(list) == 0) {
+    list->tail = node;
+  }
+  node->data = data;
+  node->next = list->head;
+  list->head = node;
+  list->len++;
+  ADT_STATS_LENGTH(list->len);
+  ADT_STATS_END(ADT_STATS_PUSH);
+  return 0;
+}
+
+/*
+ * Remove data from the head of list.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure.
+ * Post: The node at the head of list is destroyed and data points
+ *       to the data previously held in node. List length is reduced
+ *       by one.
+ * Note: This routine will abort and die if an attempt is made to
+ *       pop from an empty list.
+ */
+ADT_SL_INLINE void
+ADT_sl_list_pop(struct ADT_sl_list *list, void **data)
+{
+  struct ADT_sl_node *node;
+
+  ADT_STATS_BEGIN(ADT_STATS_POP);
+  ADT_check(ADT_sl_list_length(list) != 0, "pop from an empty list");
+  node = list->head;
+  *data = list->head->data;
+  list->head = node->next;
+  list->len--;
+  ADT_sl_node_free(list, node);
+  node = NULL;
+  ADT_STATS_END(ADT_STATS_POP);
+}
+
+/*
+ * Insert data to the end of list.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure.
+ * Post: data will be contained in a node at the end of list. List
+ *       length will be increased by one.
+ * Returns: 0 on success, or -1 on allocation failure.
+ *
+ */
+ADT_SL_INLINE int
+ADT_sl_list_append(struct ADT_sl_list *list, void *data)
+{
+  struct ADT_sl_node *node = NULL;
+
+  ADT_STATS_BEGIN(ADT_STATS_APPEND);
+  node = ADT_sl_node_alloc(list);
+  if (node == NULL)
+    return -1;
+  node->data = data;
+  node->next = NULL;
+  if (ADT_sl_list_length(list) == 0)
+    list->head = node;
+  else
+    list->tail->next = node;
+  list->tail = node;
+  list->len++;
+  ADT_STATS_LENGTH(list->len);
+  ADT_STATS_END(ADT_STATS_APPEND);
+  return 0;
+}
+
+
+/*
+ * Advance iter.
+ * Post: on success data points to the next element's data.
+ * Returns: 0 on success or -1 once the list is exhausted.
+ */
+ADT_SL_INLINE int
+ADT_sl_iter_next(struct ADT_sl_iter *iter, void **data)
+{
+  struct ADT_sl_node *node = iter->node;
+
+  if (node == NULL)
+    return -1;
+  /*
+   * The cursor's node was prefetched a step ago, so reading its data and
+   * next pointer now should not stall; the node it moves to is only
+   * prefetched, its data waits for the next step.
+   */
+  if (iter->ahead != NULL) {
+    ADT_prefetch(iter->ahead->data);
+    iter->ahead = iter->ahead->next;
+    if (iter->ahead != NULL)
+      ADT_prefetch(iter->ahead);
+  }
+  *data = node->data;
+  iter->node = node->next;
+  return 0;
+}
+
+
+#endif
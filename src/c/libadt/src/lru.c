@@ -0,0 +1,240 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "lru.h"
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+#define ADT_LRU_INITIAL_BUCKETS 16
+#define ADT_LRU_ENTRIES_PER_CHUNK 64
+
+#define ADT_lru_entry_of(l) ADT_dl_ilist_entry(l, struct ADT_lru_entry, link)
+
+/*
+ * Return a new initialized LRU cache holding at most max_entries entries
+ * and max_bytes bytes of value size, either of which may be 0 for no
+ * bound. Keys are hashed and compared with hash and equal, and dropped
+ * values are passed to evict unless it is NULL.
+ * Pre: lru is a pointer to a newly created ADT_lru.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_lru_init(struct ADT_lru *lru, size_t max_entries, size_t max_bytes,
+             size_t (*hash)(const void *), int (*equal)(const void *, const void *),
+             void (*evict)(void *))
+{
+  size_t size = ADT_LRU_INITIAL_BUCKETS * sizeof(struct ADT_lru_entry *);
+
+  lru->alloc = ADT_get_allocator();
+  lru->buckets = (struct ADT_lru_entry **)ADT_alloc(lru->alloc, size);
+  if (lru->buckets == NULL)
+    return -1;
+  memset(lru->buckets, 0, size);
+  lru->mask = ADT_LRU_INITIAL_BUCKETS - 1;
+  ADT_pool_init(&lru->entries, sizeof(struct ADT_lru_entry), ADT_LRU_ENTRIES_PER_CHUNK);
+  ADT_dl_ilist_init(&lru->order);
+  lru->max_entries = max_entries;
+  lru->max_bytes = max_bytes;
+  lru->bytes = 0;
+  lru->hash = hash;
+  lru->equal = equal;
+  lru->evict = evict;
+  memset(&lru->stats, 0, sizeof(lru->stats));
+  return 0;
+}
+
+/*
+ * Drop every entry of lru, passing its value to the evict fn, and release
+ * the cache.
+ * Pre: lru must be a pointer to an initialized ADT_lru structure.
+ */
+void
+ADT_lru_destroy(struct ADT_lru *lru)
+{
+  struct ADT_dl_link *link;
+
+  if (lru->evict != NULL) {
+    ADT_dl_ilist_foreach(&lru->order, link)
+      (*lru->evict)(ADT_lru_entry_of(link)->value);
+  }
+  ADT_pool_destroy(&lru->entries);
+  ADT_free(lru->alloc, lru->buckets);
+  lru->buckets = NULL;
+  ADT_dl_ilist_init(&lru->order);
+  lru->bytes = 0;
+}
+
+/*
+ * Scramble the caller hash of key like ADT_hashmap does, so a hash fn
+ * whose low bits are poor still spreads keys over the buckets.
+ */
+static inline size_t
+ADT_lru_mix(const struct ADT_lru *lru, const void *key)
+{
+  uint64_t h = (uint64_t)(*lru->hash)(key) * UINT64_C(0x9e3779b97f4a7c15);
+
+  return (size_t)(h ^ (h >> 32));
+}
+
+/* Return the slot pointing at the entry for key, or at the NULL ending its chain. */
+static struct ADT_lru_entry **
+ADT_lru_slot(struct ADT_lru *lru, const void *key, size_t hash)
+{
+  struct ADT_lru_entry **slot = &lru->buckets[hash & lru->mask];
+
+  while (*slot != NULL && ((*slot)->hash != hash || !(*lru->equal)((*slot)->key, key)))
+    slot = &(*slot)->chain;
+  return slot;
+}
+
+/* Double the bucket array. Failing to is harmless, chains just get longer. */
+static void
+ADT_lru_grow(struct ADT_lru *lru)
+{
+  size_t n = 2 * (lru->mask + 1), i;
+  struct ADT_lru_entry **buckets, *entry, *next;
+
+  buckets = (struct ADT_lru_entry **)ADT_alloc(lru->alloc, n * sizeof(struct ADT_lru_entry *));
+  if (buckets == NULL)
+    return;
+  memset(buckets, 0, n * sizeof(struct ADT_lru_entry *));
+  for (i = 0; i <= lru->mask; i++) {
+    for (entry = lru->buckets[i]; entry != NULL; entry = next) {
+      next = entry->chain;
+      entry->chain = buckets[entry->hash & (n - 1)];
+      buckets[entry->hash & (n - 1)] = entry;
+    }
+  }
+  ADT_free(lru->alloc, lru->buckets);
+  lru->buckets = buckets;
+  lru->mask = n - 1;
+}
+
+/* Unlink entry from the index and the recency list and free it. */
+static void
+ADT_lru_drop(struct ADT_lru *lru, struct ADT_lru_entry **slot)
+{
+  struct ADT_lru_entry *entry = *slot;
+
+  *slot = entry->chain;
+  ADT_dl_ilist_remove(&lru->order, &entry->link);
+  lru->bytes -= entry->size;
+  ADT_pool_put(&lru->entries, entry);
+}
+
+static int
+ADT_lru_over(struct ADT_lru *lru)
+{
+  return (lru->max_entries != 0 && lru->order.len > lru->max_entries) ||
+         (lru->max_bytes != 0 && lru->bytes > lru->max_bytes);
+}
+
+/*
+ * Look key up in lru.
+ * Pre: lru must be a pointer to an initialized ADT_lru structure.
+ * Post: on a hit value points to the cached value, and its entry becomes
+ *       the most recently used. The hit or miss is counted.
+ * Returns: 0 on a hit or -1 on a miss.
+ */
+int
+ADT_lru_get(struct ADT_lru *lru, const void *key, void **value)
+{
+  struct ADT_lru_entry *entry = *ADT_lru_slot(lru, key, ADT_lru_mix(lru, key));
+
+  if (entry == NULL) {
+    lru->stats.misses++;
+    return -1;
+  }
+  lru->stats.hits++;
+  ADT_dl_ilist_move_to_front(&lru->order, &entry->link);
+  *value = entry->value;
+  return 0;
+}
+
+/*
+ * Cache value of the given size under key as the most recently used entry,
+ * replacing any value already cached under key, then evict least recently
+ * used entries until lru is within its bounds again.
+ * Pre: lru must be a pointer to an initialized ADT_lru structure, and key
+ *      must stay valid while it is cached.
+ * Post: the new entry itself is never evicted, so a value larger than
+ *       max_bytes stays cached on its own.
+ * Returns: 0 on success or -1 on an allocation error, lru is then unchanged.
+ */
+int
+ADT_lru_put(struct ADT_lru *lru, const void *key, void *value, size_t size)
+{
+  size_t hash = ADT_lru_mix(lru, key);
+  struct ADT_lru_entry **slot = ADT_lru_slot(lru, key, hash), *entry = *slot, *last;
+
+  if (entry != NULL) {
+    if (lru->evict != NULL && entry->value != value)
+      (*lru->evict)(entry->value);
+    lru->bytes -= entry->size;
+    ADT_dl_ilist_move_to_front(&lru->order, &entry->link);
+  } else {
+    entry = (struct ADT_lru_entry *)ADT_pool_get(&lru->entries);
+    if (entry == NULL)
+      return -1;
+    entry->hash = hash;
+    entry->chain = NULL;
+    *slot = entry;
+    ADT_dl_ilist_push(&lru->order, &entry->link);
+    lru->stats.inserts++;
+  }
+  entry->key = key;
+  entry->value = value;
+  entry->size = size;
+  lru->bytes += size;
+  while (ADT_lru_over(lru) && lru->order.tail != &entry->link) {
+    last = ADT_lru_entry_of(lru->order.tail);
+    value = last->value;
+    ADT_lru_drop(lru, ADT_lru_slot(lru, last->key, last->hash));
+    lru->stats.evictions++;
+    if (lru->evict != NULL)
+      (*lru->evict)(value);
+  }
+  if (lru->order.len > lru->mask + 1)
+    ADT_lru_grow(lru);
+  return 0;
+}
+
+/*
+ * Take the entry for key out of lru without calling the evict fn.
+ * Pre: lru must be a pointer to an initialized ADT_lru structure.
+ * Post: value, unless NULL, points to the value that was cached.
+ * Returns: 0 if key was cached or -1 if not.
+ */
+int
+ADT_lru_remove(struct ADT_lru *lru, const void *key, void **value)
+{
+  struct ADT_lru_entry **slot = ADT_lru_slot(lru, key, ADT_lru_mix(lru, key));
+
+  if (*slot == NULL)
+    return -1;
+  if (value != NULL)
+    *value = (*slot)->value;
+  ADT_lru_drop(lru, slot);
+  return 0;
+}
+
+/*
+ * Return the number of entries in lru.
+ * Pre: lru must be a pointer to an initialized ADT_lru structure.
+ */
+unsigned int
+ADT_lru_length(struct ADT_lru *lru)
+{
+  return lru->order.len;
+}
+
+/*
+ * Copy the hit, miss, eviction and insert counters of lru to stats.
+ * Pre: lru must be a pointer to an initialized ADT_lru structure.
+ */
+void
+ADT_lru_get_stats(struct ADT_lru *lru, struct ADT_lru_stats *stats)
+{
+  *stats = lru->stats;
+}
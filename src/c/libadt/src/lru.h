@@ -0,0 +1,64 @@
+#ifndef _ADT_LRU_H
+#define _ADT_LRU_H
+
+#include <stddef.h>
+#include "alloc.h"
+#include "pool.h"
+#include "dlist.h"
+
+/*******************************************************************************
+ * LRU cache
+ *
+ * A chained hash index over entries kept in recency order on an intrusive
+ * double linked list, most recently used first. Entries come from a pool
+ * owned by the cache. The cache is bounded by its number of entries, the sum
+ * of the sizes given to ADT_lru_put, or both; a bound of 0 is no bound.
+ *
+ * The cache does not copy keys: a key must stay valid while its entry is
+ * cached, which is simplest when it lives inside its value. Values the cache
+ * drops, by eviction, replacement or ADT_lru_destroy, are passed to the
+ * evict fn, which like a list destroy fn may be NULL.
+ */
+
+struct ADT_lru_entry {
+  struct ADT_dl_link link;              /* recency order */
+  struct ADT_lru_entry *chain;          /* next entry in the same bucket */
+  size_t hash;                          /* mixed, see ADT_lru_mix */
+  const void *key;
+  void *value;
+  size_t size;
+};
+
+struct ADT_lru_stats {
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long evictions;
+  unsigned long inserts;
+};
+
+struct ADT_lru {
+  struct ADT_dl_ilist order;
+  struct ADT_lru_entry **buckets;
+  size_t mask;                          /* bucket count minus one */
+  size_t max_entries;
+  size_t max_bytes;
+  size_t bytes;
+  size_t (*hash)(const void *);
+  int (*equal)(const void *, const void *);
+  void (*evict)(void *);
+  const struct ADT_allocator *alloc;    /* bucket array source */
+  struct ADT_pool entries;
+  struct ADT_lru_stats stats;
+};
+
+int ADT_lru_init(struct ADT_lru *, size_t, size_t, size_t (*hash)(const void *),
+                 int (*equal)(const void *, const void *), void (*evict)(void *));
+void ADT_lru_destroy(struct ADT_lru *);
+int ADT_lru_get(struct ADT_lru *, const void *, void **);
+int ADT_lru_put(struct ADT_lru *, const void *, void *, size_t);
+int ADT_lru_remove(struct ADT_lru *, const void *, void **);
+unsigned int ADT_lru_length(struct ADT_lru *);
+void ADT_lru_get_stats(struct ADT_lru *, struct ADT_lru_stats *);
+
+
+#endif
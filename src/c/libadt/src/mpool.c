@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+#ifdef __linux__
+  #include <sys/syscall.h>
+#endif
+#include "mpool.h"
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+/* Objects each depot carves from a chunk of its pool. */
+#define ADT_MPOOL_PER_CHUNK (4 * ADT_MAG_SIZE)
+
+static void *
+ADT_mpool_alloc(void *ctx, size_t size)
+{
+  struct ADT_mpool *mpool = (struct ADT_mpool *)ctx;
+
+  assert(size <= mpool->size);
+  return ADT_mpool_get(mpool);
+}
+
+static void
+ADT_mpool_free(void *ctx, void *ptr)
+{
+  ADT_mpool_put((struct ADT_mpool *)ctx, ptr);
+}
+
+/* The number of NUMA nodes the host may have, 1 if it cannot tell. */
+static unsigned int
+ADT_mpool_nodes(void)
+{
+  unsigned int v, max = 0;
+#ifdef __linux__
+  FILE *f = fopen("/sys/devices/system/node/possible", "r");
+  int c;
+
+  if (f == NULL)
+    return 1;
+  /* A list of ranges such as 0-3,5. */
+  while (fscanf(f, "%u", &v) == 1) {
+    if (v > max)
+      max = v;
+    c = fgetc(f);
+    if (c != '-' && c != ',')
+      break;
+  }
+  fclose(f);
+#else
+  (void)v;
+#endif
+  return max + 1;
+}
+
+/* The NUMA node the calling thread is running on. */
+static unsigned int
+ADT_mpool_node(void)
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned int cpu, node;
+
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+    return node;
+#endif
+  return 0;
+}
+
+/* Release the cache of an exiting thread, handing its objects to its depot. */
+static void
+ADT_mpool_cache_release(void *arg)
+{
+  struct ADT_mpool_cache *cache = (struct ADT_mpool_cache *)arg;
+  struct ADT_mpool *mpool = cache->mpool;
+  struct ADT_depot *depot = cache->depot;
+  struct ADT_magazine *mags[2], *mag;
+  int i;
+
+  mags[0] = cache->loaded;
+  mags[1] = cache->spare;
+  pthread_mutex_lock(&depot->lock);
+  for (i = 0; i < 2; i++) {
+    mag = mags[i];
+    if (mag->n == ADT_MAG_SIZE) {
+      mag->next = depot->full;
+      depot->full = mag;
+    } else {
+      while (mag->n > 0)
+        ADT_pool_put(&depot->pool, mag->objs[--mag->n]);
+      mag->next = depot->empty;
+      depot->empty = mag;
+    }
+  }
+  pthread_mutex_unlock(&depot->lock);
+  pthread_mutex_lock(&mpool->lock);
+  if (cache->prev != NULL)
+    cache->prev->next = cache->next;
+  else
+    mpool->caches = cache->next;
+  if (cache->next != NULL)
+    cache->next->prev = cache->prev;
+  pthread_mutex_unlock(&mpool->lock);
+  ADT_free(mpool->backing, cache);
+}
+
+/* Return the calling thread's cache, creating it on first use; NULL if it cannot. */
+static struct ADT_mpool_cache *
+ADT_mpool_cache(struct ADT_mpool *mpool)
+{
+  struct ADT_mpool_cache *cache;
+
+  cache = (struct ADT_mpool_cache *)pthread_getspecific(mpool->key);
+  if (cache != NULL)
+    return cache;
+  cache = (struct ADT_mpool_cache *)ADT_alloc(mpool->backing, sizeof(*cache));
+  if (cache == NULL)
+    return NULL;
+  cache->loaded = (struct ADT_magazine *)ADT_alloc(mpool->backing, sizeof(struct ADT_magazine));
+  cache->spare = (struct ADT_magazine *)ADT_alloc(mpool->backing, sizeof(struct ADT_magazine));
+  if (cache->loaded == NULL || cache->spare == NULL)
+    goto fail;
+  cache->loaded->n = 0;
+  cache->spare->n = 0;
+  cache->depot = &mpool->depots[ADT_mpool_node() % mpool->ndepots];
+  cache->mpool = mpool;
+  cache->prev = NULL;
+  if (pthread_setspecific(mpool->key, cache) != 0)
+    goto fail;
+  pthread_mutex_lock(&mpool->lock);
+  cache->next = mpool->caches;
+  if (cache->next != NULL)
+    cache->next->prev = cache;
+  mpool->caches = cache;
+  pthread_mutex_unlock(&mpool->lock);
+  return cache;
+
+fail:
+  if (cache->loaded != NULL)
+    ADT_free(mpool->backing, cache->loaded);
+  if (cache->spare != NULL)
+    ADT_free(mpool->backing, cache->spare);
+  ADT_free(mpool->backing, cache);
+  return NULL;
+}
+
+/*
+ * Initialize an empty concurrent pool handing out objects of size bytes.
+ * Pre: mpool is a pointer to a newly created ADT_mpool and size is non
+ *      zero. ndepots is the number of depots, or 0 for one per NUMA node.
+ * Post: mpool holds no objects; each thread gets its magazines on first use.
+ * Returns: 0 on success or -1 if size is zero or an allocation fails.
+ */
+int
+ADT_mpool_init(struct ADT_mpool *mpool, size_t size, unsigned int ndepots)
+{
+  unsigned int i;
+
+  if (size == 0)
+    return -1;
+  if (ndepots == 0)
+    ndepots = ADT_mpool_nodes();
+  mpool->depots = (struct ADT_depot *)aligned_alloc(ADT_CACHE_LINE,
+                                                    ndepots * sizeof(struct ADT_depot));
+  if (mpool->depots == NULL)
+    return -1;
+  if (pthread_key_create(&mpool->key, &ADT_mpool_cache_release) != 0) {
+    free(mpool->depots);
+    return -1;
+  }
+  for (i = 0; i < ndepots; i++) {
+    pthread_mutex_init(&mpool->depots[i].lock, NULL);
+    mpool->depots[i].full = NULL;
+    mpool->depots[i].empty = NULL;
+    ADT_pool_init(&mpool->depots[i].pool, size, ADT_MPOOL_PER_CHUNK);
+  }
+  mpool->size = mpool->depots[0].pool.size;
+  mpool->ndepots = ndepots;
+  pthread_mutex_init(&mpool->lock, NULL);
+  mpool->caches = NULL;
+  mpool->backing = ADT_get_allocator();
+  mpool->allocator.alloc = &ADT_mpool_alloc;
+  mpool->allocator.free = &ADT_mpool_free;
+  mpool->allocator.ctx = mpool;
+  return 0;
+}
+
+static void
+ADT_magazine_free_all(struct ADT_mpool *mpool, struct ADT_magazine *mag)
+{
+  struct ADT_magazine *next;
+
+  for (; mag != NULL; mag = next) {
+    next = mag->next;
+    ADT_free(mpool->backing, mag);
+  }
+}
+
+/*
+ * Release every object, magazine and cache of mpool.
+ * Pre: mpool must be a pointer to an initialized ADT_mpool which no thread
+ *      is using any more, and nothing may still reference its objects.
+ *      Nodes retired through hazard pointers must have been drained with
+ *      ADT_hp_drain after the other threads that retired them exited.
+ * Post: all objects are invalid and mpool must be initialized again to be
+ *       reused.
+ */
+void
+ADT_mpool_destroy(struct ADT_mpool *mpool)
+{
+  struct ADT_mpool_cache *cache;
+  unsigned int i;
+
+  /* Threads still alive no longer run the release when they exit. */
+  pthread_key_delete(mpool->key);
+  while (mpool->caches != NULL) {
+    cache = mpool->caches;
+    mpool->caches = cache->next;
+    ADT_free(mpool->backing, cache->loaded);
+    ADT_free(mpool->backing, cache->spare);
+    ADT_free(mpool->backing, cache);
+  }
+  for (i = 0; i < mpool->ndepots; i++) {
+    ADT_magazine_free_all(mpool, mpool->depots[i].full);
+    ADT_magazine_free_all(mpool, mpool->depots[i].empty);
+    ADT_pool_destroy(&mpool->depots[i].pool);
+    pthread_mutex_destroy(&mpool->depots[i].lock);
+  }
+  pthread_mutex_destroy(&mpool->lock);
+  free(mpool->depots);
+  mpool->depots = NULL;
+}
+
+/*
+ * Take an object from mpool, from the calling thread's magazines if they
+ * hold any, else a full magazine or a batch of new objects from its depot.
+ * Pre: mpool must be a pointer to an initialized ADT_mpool.
+ * Returns: a pointer to size bytes of uninitialized memory or NULL on an
+ *          allocation error.
+ */
+void *
+ADT_mpool_get(struct ADT_mpool *mpool)
+{
+  struct ADT_mpool_cache *cache = ADT_mpool_cache(mpool);
+  struct ADT_magazine *mag;
+  struct ADT_depot *depot;
+  void *obj;
+
+  if (cache == NULL) {
+    depot = &mpool->depots[0];
+    pthread_mutex_lock(&depot->lock);
+    obj = ADT_pool_get(&depot->pool);
+    pthread_mutex_unlock(&depot->lock);
+    return obj;
+  }
+  mag = cache->loaded;
+  if (mag->n > 0)
+    return mag->objs[--mag->n];
+  /* The spare is always either empty or full. */
+  if (cache->spare->n > 0) {
+    cache->loaded = cache->spare;
+    cache->spare = mag;
+    mag = cache->loaded;
+    return mag->objs[--mag->n];
+  }
+  depot = cache->depot;
+  pthread_mutex_lock(&depot->lock);
+  if (depot->full != NULL) {
+    cache->spare->next = depot->empty;
+    depot->empty = cache->spare;
+    cache->spare = mag;
+    mag = depot->full;
+    depot->full = mag->next;
+    cache->loaded = mag;
+  } else {
+    while (mag->n < ADT_MAG_SIZE / 2) {
+      obj = ADT_pool_get(&depot->pool);
+      if (obj == NULL)
+        break;
+      mag->objs[mag->n++] = obj;
+    }
+  }
+  pthread_mutex_unlock(&depot->lock);
+  if (mag->n == 0)
+    return NULL;
+  return mag->objs[--mag->n];
+}
+
+/*
+ * Return obj to mpool. It goes into the calling thread's magazines, which
+ * trade a full magazine for an empty one at the depot once both are full.
+ * Pre: mpool must be a pointer to an initialized ADT_mpool and obj must have
+ *      been handed out by that same pool, on any thread.
+ */
+void
+ADT_mpool_put(struct ADT_mpool *mpool, void *obj)
+{
+  struct ADT_mpool_cache *cache = ADT_mpool_cache(mpool);
+  struct ADT_magazine *mag, *empty;
+  struct ADT_depot *depot;
+
+  assert(obj != NULL);
+  if (cache == NULL) {
+    depot = &mpool->depots[0];
+    pthread_mutex_lock(&depot->lock);
+    ADT_pool_put(&depot->pool, obj);
+    pthread_mutex_unlock(&depot->lock);
+    return;
+  }
+  mag = cache->loaded;
+  if (mag->n < ADT_MAG_SIZE) {
+    mag->objs[mag->n++] = obj;
+    return;
+  }
+  if (cache->spare->n == 0) {
+    cache->loaded = cache->spare;
+    cache->spare = mag;
+    cache->loaded->objs[cache->loaded->n++] = obj;
+    return;
+  }
+  depot = cache->depot;
+  pthread_mutex_lock(&depot->lock);
+  empty = depot->empty;
+  if (empty != NULL)
+    depot->empty = empty->next;
+  else
+    empty = (struct ADT_magazine *)ADT_alloc(mpool->backing, sizeof(struct ADT_magazine));
+  if (empty == NULL) {
+    ADT_pool_put(&depot->pool, obj);
+    pthread_mutex_unlock(&depot->lock);
+    return;
+  }
+  cache->spare->next = depot->full;
+  depot->full = cache->spare;
+  pthread_mutex_unlock(&depot->lock);
+  cache->spare = mag;
+  empty->n = 0;
+  empty->objs[empty->n++] = obj;
+  cache->loaded = empty;
+}
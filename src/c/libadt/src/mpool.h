@@ -0,0 +1,66 @@
+#ifndef _ADT_MPOOL_H
+#define _ADT_MPOOL_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "alloc.h"
+#include "cache.h"
+#include "pool.h"
+
+/*******************************************************************************
+ * Concurrent object pool with per-thread magazines
+ *
+ * A fixed size pool any number of threads may share, e.g. as the node
+ * allocator of an ADT_ms_queue. Each thread caches objects in two
+ * magazines of ADT_MAG_SIZE, a loaded one and a spare, so it gets and puts
+ * objects without touching shared memory; only when both are empty or both
+ * full does it swap a whole magazine with a depot under the depot's lock.
+ * A producer freeing nodes a consumer allocates thus moves them between
+ * cores a magazine at a time instead of bouncing one freelist line.
+ *
+ * There is one depot per NUMA node, and a thread uses the depot of the node
+ * it first touches the pool from, so magazines stay node local. A thread's
+ * magazines go back to its depot when it exits.
+ */
+
+#define ADT_MAG_SIZE 64
+
+struct ADT_magazine {
+  struct ADT_magazine *next;
+  unsigned int n;
+  void *objs[ADT_MAG_SIZE];
+};
+
+struct ADT_depot {
+  _Alignas(ADT_CACHE_LINE) pthread_mutex_t lock;
+  struct ADT_magazine *full;
+  struct ADT_magazine *empty;
+  struct ADT_pool pool;                 /* carves new objects */
+};
+
+struct ADT_mpool_cache {
+  struct ADT_magazine *loaded;
+  struct ADT_magazine *spare;
+  struct ADT_depot *depot;
+  struct ADT_mpool *mpool;
+  struct ADT_mpool_cache *next, *prev;  /* every live cache, for destroy */
+};
+
+struct ADT_mpool {
+  size_t size;
+  unsigned int ndepots;
+  struct ADT_depot *depots;
+  pthread_key_t key;                    /* the calling thread's cache */
+  pthread_mutex_t lock;                 /* caches */
+  struct ADT_mpool_cache *caches;
+  const struct ADT_allocator *backing;  /* magazines and caches */
+  struct ADT_allocator allocator;       /* get/put as an ADT_allocator */
+};
+
+int ADT_mpool_init(struct ADT_mpool *, size_t, unsigned int);
+void ADT_mpool_destroy(struct ADT_mpool *);
+void *ADT_mpool_get(struct ADT_mpool *);
+void ADT_mpool_put(struct ADT_mpool *, void *);
+
+
+#endif
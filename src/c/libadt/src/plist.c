@@ -0,0 +1,340 @@
+#ifdef __linux__
+  #define _GNU_SOURCE                   /* mremap */
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "plist.h"
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+#define ADT_PLIST_INITIAL_CAP 16
+#define ADT_PLIST_BLOCK_OFFSET sizeof(struct ADT_plist_header)
+
+#define ADT_plist_hdr(plist) ((struct ADT_plist_header *)(plist)->map)
+#define ADT_plist_ix(plist) \
+  ((struct ADT_ix_header *)((plist)->map + ADT_PLIST_BLOCK_OFFSET))
+
+static size_t
+ADT_plist_file_size(size_t payload, uint32_t cap)
+{
+  return ADT_PLIST_BLOCK_OFFSET + sizeof(struct ADT_ix_header) +
+         (size_t)cap * ADT_IX_SLOT_SIZE(payload);
+}
+
+/* Map size bytes of the file, replacing any current mapping. */
+static int
+ADT_plist_map(struct ADT_plist *plist, size_t size)
+{
+  void *map;
+
+  if (plist->map == NULL)
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, plist->fd, 0);
+  else {
+#ifdef __linux__
+    map = mremap(plist->map, plist->map_size, size, MREMAP_MAYMOVE);
+#else
+    munmap(plist->map, plist->map_size);
+    plist->map = NULL;
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, plist->fd, 0);
+#endif
+  }
+  if (map == MAP_FAILED)
+    return -1;
+  plist->map = (char *)map;
+  plist->map_size = size;
+  return 0;
+}
+
+/* ADT_ix_list grow hook: extend the file and map the larger block. */
+static int
+ADT_plist_grow(struct ADT_ix_list *list, uint32_t cap)
+{
+  struct ADT_plist *plist = (struct ADT_plist *)list->ctx;
+  size_t size = ADT_plist_file_size(list->hdr->payload, cap);
+
+  if (ftruncate(plist->fd, (off_t)size) != 0 || ADT_plist_map(plist, size) != 0)
+    return -1;
+  list->hdr = ADT_plist_ix(plist);
+  list->hdr->cap = cap;
+  return 0;
+}
+
+/*
+ * Rebuild len and tail of a dirty file by walking from head, and drop a
+ * free list that does not check out, which at worst leaks its slots.
+ * Returns: 0 on success or -1 if the list itself is broken.
+ */
+static int
+ADT_plist_repair(struct ADT_plist *plist)
+{
+  struct ADT_ix_header *ix = ADT_plist_ix(plist);
+  struct ADT_ix_list list;
+  uint32_t i, n, last;
+
+  list.hdr = ix;
+  list.slot_size = ADT_IX_SLOT_SIZE(ix->payload);
+  last = ADT_IX_NIL;
+  for (i = ix->head, n = 0; i != ADT_IX_NIL; i = ADT_ix_next(&list, i), n++) {
+    if (i >= ix->used || n >= ix->used)
+      return -1;
+    last = i;
+  }
+  ix->len = n;
+  ix->tail = last;
+  for (i = ix->free; i != ADT_IX_NIL; i = ADT_ix_next(&list, i), n++) {
+    if (i >= ix->used || n >= ix->used) {
+      ix->free = ADT_IX_NIL;
+      break;
+    }
+  }
+  return 0;
+}
+
+/* Check an existing file's headers against its size and payload. */
+static int
+ADT_plist_check(struct ADT_plist *plist, size_t payload)
+{
+  struct ADT_plist_header *hdr = ADT_plist_hdr(plist);
+  struct ADT_ix_header *ix = ADT_plist_ix(plist);
+
+  if (memcmp(hdr->magic, ADT_PLIST_MAGIC, sizeof(ADT_PLIST_MAGIC)) != 0 ||
+      hdr->version != ADT_PLIST_VERSION || hdr->header_size != ADT_PLIST_BLOCK_OFFSET ||
+      !(ix->flags & ADT_IX_INLINE) || ix->payload == 0 ||
+      (payload != 0 && ix->payload != payload) || ix->used > ix->cap ||
+      plist->map_size < ADT_plist_file_size(ix->payload, ix->cap))
+    return -1;
+  return 0;
+}
+
+/* Whether slot index i of ix is ADT_IX_NIL or one handed out. */
+#define ADT_plist_valid_ix(ix, i) ((i) == ADT_IX_NIL || (i) < (ix)->used)
+
+/*
+ * Check that the list fields of an existing file only index slots in use,
+ * after any repair, so walking the list stays inside the mapping.
+ */
+static int
+ADT_plist_check_links(struct ADT_plist *plist)
+{
+  struct ADT_ix_header *ix = ADT_plist_ix(plist);
+
+  if (!ADT_plist_valid_ix(ix, ix->head) || !ADT_plist_valid_ix(ix, ix->tail) ||
+      !ADT_plist_valid_ix(ix, ix->free))
+    return -1;
+  return 0;
+}
+
+/*
+ * Open the persistent list in the file at path, creating it for payloads
+ * of the given size if it does not exist. An existing list is reattached
+ * as it was left; payload may then be 0 to accept the file's own.
+ * Pre: plist is a pointer to a newly created ADT_plist, and no other
+ *      ADT_plist has the file open.
+ * Returns: 0 on success or -1 with errno set; EINVAL means the file is not
+ *          a persistent list of this version and payload, EUCLEAN that its
+ *          list is beyond repair.
+ */
+int
+ADT_plist_open(struct ADT_plist *plist, const char *path, size_t payload)
+{
+  struct ADT_plist_header *hdr;
+  struct ADT_ix_header *ix;
+  struct stat st;
+  size_t size;
+  int err;
+
+  plist->map = NULL;
+  plist->map_size = 0;
+  plist->fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (plist->fd < 0)
+    return -1;
+  if (fstat(plist->fd, &st) != 0)
+    goto fail;
+  if (st.st_size == 0) {
+    if (payload == 0 || payload > UINT32_MAX / 2) {
+      errno = EINVAL;
+      goto fail;
+    }
+    size = ADT_plist_file_size(payload, ADT_PLIST_INITIAL_CAP);
+    if (ftruncate(plist->fd, (off_t)size) != 0 || ADT_plist_map(plist, size) != 0)
+      goto fail;
+    hdr = ADT_plist_hdr(plist);
+    memset(hdr, 0, sizeof(*hdr));
+    memcpy(hdr->magic, ADT_PLIST_MAGIC, sizeof(ADT_PLIST_MAGIC));
+    hdr->version = ADT_PLIST_VERSION;
+    hdr->header_size = ADT_PLIST_BLOCK_OFFSET;
+    ix = ADT_plist_ix(plist);
+    ix->head = ADT_IX_NIL;
+    ix->tail = ADT_IX_NIL;
+    ix->free = ADT_IX_NIL;
+    ix->len = 0;
+    ix->cap = ADT_PLIST_INITIAL_CAP;
+    ix->used = 0;
+    ix->payload = (uint32_t)payload;
+    ix->flags = ADT_IX_INLINE;
+  } else {
+    if ((size_t)st.st_size < ADT_plist_file_size(1, 0) ||
+        ADT_plist_map(plist, (size_t)st.st_size) != 0)
+      goto invalid;
+    if (ADT_plist_check(plist, payload) != 0)
+      goto invalid;
+    if (ADT_plist_hdr(plist)->state != ADT_PLIST_CLEAN && ADT_plist_repair(plist) != 0) {
+      errno = EUCLEAN;
+      goto fail;
+    }
+    if (ADT_plist_check_links(plist) != 0)
+      goto invalid;
+  }
+  if (ADT_ix_list_attach(&plist->list, ADT_plist_ix(plist), &ADT_plist_grow, plist) != 0)
+    goto invalid;
+  return 0;
+
+invalid:
+  errno = EINVAL;
+fail:
+  err = errno;
+  if (plist->map != NULL)
+    munmap(plist->map, plist->map_size);
+  close(plist->fd);
+  errno = err;
+  return -1;
+}
+
+/*
+ * Write every change to plist out to disk, waiting until it is there.
+ * Pre: plist must be a pointer to an open ADT_plist.
+ * Returns: 0 on success or -1 with errno set.
+ */
+int
+ADT_plist_sync(struct ADT_plist *plist)
+{
+  if (msync(plist->map, plist->map_size, MS_SYNC) != 0)
+    return -1;
+  return fsync(plist->fd);
+}
+
+/*
+ * Sync any changes to disk, mark the file clean, unmap it and close it.
+ * The clean mark itself is left to the page cache: it can only reach the
+ * disk after the slots it vouches for. If the sync fails the file stays
+ * dirty, to be repaired when next opened.
+ * Pre: plist must be a pointer to an open ADT_plist.
+ * Returns: 0 on success or -1 with errno set.
+ */
+int
+ADT_plist_close(struct ADT_plist *plist)
+{
+  int rc = 0;
+
+  if (ADT_plist_hdr(plist)->state != ADT_PLIST_CLEAN) {
+    if (ADT_plist_sync(plist) == 0)
+      ADT_plist_hdr(plist)->state = ADT_PLIST_CLEAN;
+    else
+      rc = -1;
+  }
+  if (munmap(plist->map, plist->map_size) != 0)
+    rc = -1;
+  if (close(plist->fd) != 0)
+    rc = -1;
+  plist->map = NULL;
+  plist->fd = -1;
+  return rc;
+}
+
+/* Write the page holding the headers out to disk, waiting until it is there. */
+static int
+ADT_plist_sync_header(struct ADT_plist *plist)
+{
+  return msync(plist->map, (size_t)sysconf(_SC_PAGESIZE), MS_SYNC);
+}
+
+/*
+ * Sync plist, then mark it clean and consistent at a new generation and
+ * sync that mark, so a crash before the next change reopens without a
+ * repair walk. The slots reach the disk first: msync writes pages in no
+ * particular order, and a clean mark must never get there ahead of them.
+ * Pre: plist must be a pointer to an open ADT_plist.
+ * Returns: 0 on success or -1 with errno set; the file then stays dirty.
+ */
+int
+ADT_plist_checkpoint(struct ADT_plist *plist)
+{
+  struct ADT_plist_header *hdr = ADT_plist_hdr(plist);
+
+  if (ADT_plist_sync(plist) != 0)
+    return -1;
+  hdr->generation++;
+  hdr->state = ADT_PLIST_CLEAN;
+  return ADT_plist_sync_header(plist);
+}
+
+/*
+ * Mark the file dirty before the first change since opening or a checkpoint,
+ * syncing the mark so that no changed slot can reach the disk under a clean
+ * header.
+ * Returns: 0 on success or -1 with errno set.
+ */
+static inline int
+ADT_plist_touch(struct ADT_plist *plist)
+{
+  if (ADT_plist_hdr(plist)->state != ADT_PLIST_DIRTY) {
+    ADT_plist_hdr(plist)->state = ADT_PLIST_DIRTY;
+    return ADT_plist_sync_header(plist);
+  }
+  return 0;
+}
+
+/*
+ * Copy the payload at src into a new element at the head of plist.
+ * Pre: plist must be a pointer to an open ADT_plist.
+ * Returns: 0 on success or -1 if the file could not grow or be marked dirty.
+ */
+int
+ADT_plist_push(struct ADT_plist *plist, const void *src)
+{
+  if (ADT_plist_touch(plist) != 0)
+    return -1;
+  return ADT_ix_list_push_inline(&plist->list, src);
+}
+
+/*
+ * Copy the payload at src into a new element at the end of plist.
+ * Pre: plist must be a pointer to an open ADT_plist.
+ * Returns: 0 on success or -1 if the file could not grow or be marked dirty.
+ */
+int
+ADT_plist_append(struct ADT_plist *plist, const void *src)
+{
+  if (ADT_plist_touch(plist) != 0)
+    return -1;
+  return ADT_ix_list_append_inline(&plist->list, src);
+}
+
+/*
+ * Remove the head of plist, copying its payload to dst.
+ * Pre: plist must be a pointer to an open ADT_plist with at least one
+ *      element, and dst must have room for the payload.
+ * Note: the pop happens even if the dirty mark cannot be synced.
+ */
+void
+ADT_plist_pop(struct ADT_plist *plist, void *dst)
+{
+  (void)ADT_plist_touch(plist);
+  ADT_ix_list_pop_inline(&plist->list, dst);
+}
+
+/*
+ * Return the number of elements in plist.
+ * Pre: plist must be a pointer to an open ADT_plist.
+ */
+unsigned int
+ADT_plist_length(struct ADT_plist *plist)
+{
+  return ADT_ix_list_length(&plist->list);
+}
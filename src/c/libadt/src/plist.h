@@ -0,0 +1,64 @@
+#ifndef _ADT_PLIST_H
+#define _ADT_PLIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ixlist.h"
+
+/*******************************************************************************
+ * Persistent list
+ *
+ * An inline payload ADT_ix_list whose block is a shared mapping of a file,
+ * so the list outlives the process. Reopening the file reattaches the list
+ * in constant time and it carries on where it stopped, e.g. a queue keeps
+ * draining. The file is a versioned ADT_plist_header followed by the index
+ * list block, in host byte order:
+ *
+ *   ADT_plist_header | ADT_ix_header | slot 0 | slot 1 | ...
+ *
+ * Writes reach the file through the page cache, so a process crash loses
+ * nothing. ADT_plist_sync, ADT_plist_checkpoint and ADT_plist_close push
+ * them to the disk for a machine crash. A file not closed or checkpointed
+ * since its last change is marked dirty, and opening it walks the list
+ * once to repair a length or tail left behind by an interrupted operation.
+ * The first change after opening a clean file or a checkpoint syncs the
+ * dirty mark before touching any slot, so it costs one page write per
+ * checkpoint interval.
+ */
+
+#define ADT_PLIST_MAGIC "ADTPLST"
+#define ADT_PLIST_VERSION 1
+
+#define ADT_PLIST_CLEAN 0               /* header states */
+#define ADT_PLIST_DIRTY 1
+
+struct ADT_plist_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t header_size;                 /* bytes up to the ADT_ix_header */
+  uint64_t generation;                  /* checkpoints so far */
+  uint32_t state;
+  uint32_t reserved;
+};
+
+struct ADT_plist {
+  int fd;
+  char *map;
+  size_t map_size;
+  struct ADT_ix_list list;
+};
+
+int ADT_plist_open(struct ADT_plist *, const char *, size_t);
+int ADT_plist_close(struct ADT_plist *);
+int ADT_plist_sync(struct ADT_plist *);
+int ADT_plist_checkpoint(struct ADT_plist *);
+int ADT_plist_push(struct ADT_plist *, const void *);
+int ADT_plist_append(struct ADT_plist *, const void *);
+void ADT_plist_pop(struct ADT_plist *, void *);
+unsigned int ADT_plist_length(struct ADT_plist *);
+#define ADT_plist_enqueue(plist, src) ADT_plist_append(plist, src)
+#define ADT_plist_dequeue(plist, dst) ADT_plist_pop(plist, dst)
+#define ADT_plist_foreach(plist, ix) ADT_ix_list_foreach(&(plist)->list, ix)
+
+
+#endif
@@ -0,0 +1,119 @@
+#include <assert.h>
+#include "pool.h"
+
+/* Chunk headers are padded so the first object in a chunk is 16 byte aligned. */
+#define ADT_POOL_ALIGN 16
+#define ADT_POOL_ROUND(n, a) (((n) + (a) - 1) & ~((size_t)(a) - 1))
+#define ADT_POOL_HDR ADT_POOL_ROUND(sizeof(struct ADT_pool_chunk), ADT_POOL_ALIGN)
+
+static void *
+ADT_pool_alloc(void *ctx, size_t size)
+{
+  struct ADT_pool *pool = (struct ADT_pool *)ctx;
+
+  assert(size <= pool->size);
+  return ADT_pool_get(pool);
+}
+
+static void
+ADT_pool_free(void *ctx, void *ptr)
+{
+  ADT_pool_put((struct ADT_pool *)ctx, ptr);
+}
+
+/*
+ * Initialize an empty pool handing out objects of size bytes.
+ * Pre: pool is a pointer to a newly created ADT_pool, size is non zero and
+ *      per_chunk is the number of objects to carve from each chunk.
+ * Post: pool holds no memory. The first ADT_pool_get allocates a chunk.
+ * Returns: 0 on success or -1 if size or per_chunk is zero.
+ */
+int
+ADT_pool_init(struct ADT_pool *pool, size_t size, unsigned int per_chunk)
+{
+  if (size == 0 || per_chunk == 0)
+    return -1;
+  if (size < sizeof(void *))
+    size = sizeof(void *);
+  pool->free = NULL;
+  pool->chunks = NULL;
+  pool->cur = NULL;
+  pool->end = NULL;
+  pool->size = ADT_POOL_ROUND(size, sizeof(void *));
+  pool->per_chunk = per_chunk;
+  pool->backing = ADT_get_allocator();
+  pool->allocator.alloc = &ADT_pool_alloc;
+  pool->allocator.free = &ADT_pool_free;
+  pool->allocator.ctx = pool;
+  return 0;
+}
+
+/*
+ * Release every chunk owned by pool in one pass over the chunk list.
+ * Pre: pool must be a pointer to an initialized ADT_pool. Nothing may still
+ *      reference objects handed out by pool.
+ * Post: all objects are invalid and pool holds no memory. The pool may be
+ *       reused as if freshly initialized.
+ */
+void
+ADT_pool_destroy(struct ADT_pool *pool)
+{
+  struct ADT_pool_chunk *chunk;
+
+  while (pool->chunks != NULL) {
+    chunk = pool->chunks;
+    pool->chunks = chunk->next;
+    ADT_free(pool->backing, chunk);
+  }
+  pool->free = NULL;
+  pool->cur = NULL;
+  pool->end = NULL;
+}
+
+/*
+ * Take an object from pool. Recycled objects are preferred, then untouched
+ * space in the newest chunk, and only then is a new chunk allocated.
+ * Pre: pool must be a pointer to an initialized ADT_pool.
+ * Returns: a pointer to size bytes of uninitialized memory or NULL on an
+ *          allocation error.
+ */
+void *
+ADT_pool_get(struct ADT_pool *pool)
+{
+  struct ADT_pool_chunk *chunk;
+  void *obj;
+
+  if (pool->free != NULL) {
+    obj = pool->free;
+    pool->free = *(void **)obj;
+    return obj;
+  }
+  if (pool->cur == pool->end) {
+    chunk = (struct ADT_pool_chunk *)ADT_alloc(pool->backing,
+                                               ADT_POOL_HDR + pool->size * pool->per_chunk);
+    if (chunk == NULL)
+      return NULL;
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    pool->cur = (char *)chunk + ADT_POOL_HDR;
+    pool->end = pool->cur + pool->size * pool->per_chunk;
+  }
+  obj = pool->cur;
+  pool->cur += pool->size;
+  return obj;
+}
+
+/*
+ * Return obj to pool for reuse.
+ * Pre: pool must be a pointer to an initialized ADT_pool and obj must have
+ *      been handed out by that same pool.
+ * Post: obj is on the freelist and will be the next object returned by
+ *       ADT_pool_get.
+ */
+void
+ADT_pool_put(struct ADT_pool *pool, void *obj)
+{
+  assert(obj != NULL);
+  *(void **)obj = pool->free;
+  pool->free = obj;
+}
@@ -0,0 +1,36 @@
+#ifndef _ADT_POOL_H
+#define _ADT_POOL_H
+
+#include <stddef.h>
+#include "alloc.h"
+
+/*******************************************************************************
+ * Fixed size object pool
+ *
+ * Objects are carved out of large chunks and recycled through a freelist, so
+ * steady state get/put never touches malloc. A pool may be shared by any
+ * number of structures which use objects of the same size.
+ */
+
+struct ADT_pool_chunk {
+  struct ADT_pool_chunk *next;
+};
+
+struct ADT_pool {
+  void *free;                   /* recycled objects, linked through their first word */
+  struct ADT_pool_chunk *chunks;
+  char *cur;                    /* next never-used object in the newest chunk */
+  char *end;
+  size_t size;
+  unsigned int per_chunk;
+  const struct ADT_allocator *backing;  /* chunk source */
+  struct ADT_allocator allocator;       /* get/put as an ADT_allocator */
+};
+
+int ADT_pool_init(struct ADT_pool *, size_t, unsigned int);
+void ADT_pool_destroy(struct ADT_pool *);
+void *ADT_pool_get(struct ADT_pool *);
+void ADT_pool_put(struct ADT_pool *, void *);
+
+
+#endif
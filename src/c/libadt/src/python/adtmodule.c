@@ -0,0 +1,728 @@
+/*
+ * Python bindings for libadt.
+ *
+ *   adt.List   ADT_sl_list: append, appendleft, popleft, extend, clear
+ *   adt.Queue  ADT_ms_queue: enqueue, dequeue, extend
+ *   adt.Ring   ADT_ring: enqueue, dequeue, extend, policy RING_FAIL,
+ *              RING_OVERWRITE or RING_GROW
+ *
+ * Each container owns a reference to every object it holds. extend() takes
+ * any iterable and moves it in with a single C call; list and tuple
+ * arguments are linked straight from their item arrays, and objects with a
+ * one dimensional numeric buffer (array.array, memoryview, ...) are read
+ * directly from their memory.
+ */
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+#include "adt.h"
+
+static PyObject *ADTError;
+
+static void
+ADT_py_decref(void *obj)
+{
+  Py_DECREF((PyObject *)obj);
+}
+
+/*
+ * Return the type code of a buffer format naming one native numeric item,
+ * as read by ADT_py_items, or '\0' for any other format. A NULL format is
+ * unsigned bytes.
+ */
+static char
+ADT_py_native_format(const char *format)
+{
+  if (format == NULL)
+    return 'B';
+  if (format[0] == '@')
+    format++;
+  if (format[0] == '\0' || format[1] != '\0' || strchr("bBhHiIlLqQnNfd", format[0]) == NULL)
+    return '\0';
+  return format[0];
+}
+
+/* Return the size of a native item of type code fmt. */
+static size_t
+ADT_py_native_size(char fmt)
+{
+  switch (fmt) {
+  case 'b': case 'B': return sizeof(char);
+  case 'h': case 'H': return sizeof(short);
+  case 'i': case 'I': return sizeof(int);
+  case 'l': case 'L': return sizeof(long);
+  case 'q': case 'Q': return sizeof(long long);
+  case 'n': case 'N': return sizeof(size_t);
+  case 'f': return sizeof(float);
+  default: return sizeof(double);
+  }
+}
+
+/*
+ * Convert the items of a buffer or sequence into a new reference array.
+ * Returns: the array (PyMem_Free it, after dropping the references if they
+ *          were not handed on) with its length in n, or NULL with an
+ *          exception set.
+ */
+static PyObject **
+ADT_py_items(PyObject *iterable, Py_ssize_t *n)
+{
+  PyObject **items, *seq;
+  Py_buffer view;
+  Py_ssize_t i;
+  char *p;
+  char fmt;
+
+  if (PyObject_CheckBuffer(iterable) &&
+      PyObject_GetBuffer(iterable, &view, PyBUF_FORMAT | PyBUF_ND) == 0) {
+    if (view.ndim != 1) {
+      PyBuffer_Release(&view);
+      PyErr_SetString(PyExc_TypeError, "extend() needs a one dimensional numeric buffer");
+      return NULL;
+    }
+    fmt = ADT_py_native_format(view.format);
+    /* Anything else, say standard sizes, converts item by item below. */
+    if (fmt == '\0' || (size_t)view.itemsize != ADT_py_native_size(fmt)) {
+      PyBuffer_Release(&view);
+      goto sequence;
+    }
+    *n = view.shape[0];
+    items = PyMem_New(PyObject *, *n ? *n : 1);
+    if (items == NULL) {
+      PyBuffer_Release(&view);
+      PyErr_NoMemory();
+      return NULL;
+    }
+    for (i = 0, p = (char *)view.buf; i < *n; i++, p += view.itemsize) {
+      switch (fmt) {
+      case 'b': items[i] = PyLong_FromLong(*(signed char *)p); break;
+      case 'B': items[i] = PyLong_FromUnsignedLong(*(unsigned char *)p); break;
+      case 'h': items[i] = PyLong_FromLong(*(short *)p); break;
+      case 'H': items[i] = PyLong_FromUnsignedLong(*(unsigned short *)p); break;
+      case 'i': items[i] = PyLong_FromLong(*(int *)p); break;
+      case 'I': items[i] = PyLong_FromUnsignedLong(*(unsigned int *)p); break;
+      case 'l': items[i] = PyLong_FromLong(*(long *)p); break;
+      case 'L': items[i] = PyLong_FromUnsignedLong(*(unsigned long *)p); break;
+      case 'q': items[i] = PyLong_FromLongLong(*(long long *)p); break;
+      case 'Q': items[i] = PyLong_FromUnsignedLongLong(*(unsigned long long *)p); break;
+      case 'n': items[i] = PyLong_FromSsize_t(*(Py_ssize_t *)p); break;
+      case 'N': items[i] = PyLong_FromSize_t(*(size_t *)p); break;
+      case 'f': items[i] = PyFloat_FromDouble(*(float *)p); break;
+      default: items[i] = PyFloat_FromDouble(*(double *)p); break;
+      }
+      if (items[i] == NULL) {
+        while (i-- > 0)
+          Py_DECREF(items[i]);
+        PyMem_Free(items);
+        PyBuffer_Release(&view);
+        return NULL;
+      }
+    }
+    PyBuffer_Release(&view);
+    return items;
+  }
+  PyErr_Clear();
+
+sequence:
+  seq = PySequence_Fast(iterable, "extend() argument must be iterable");
+  if (seq == NULL)
+    return NULL;
+  *n = PySequence_Fast_GET_SIZE(seq);
+  items = PyMem_New(PyObject *, *n ? *n : 1);
+  if (items == NULL) {
+    Py_DECREF(seq);
+    PyErr_NoMemory();
+    return NULL;
+  }
+  for (i = 0; i < *n; i++) {
+    items[i] = PySequence_Fast_ITEMS(seq)[i];
+    Py_INCREF(items[i]);
+  }
+  Py_DECREF(seq);
+  return items;
+}
+
+static void
+ADT_py_items_free(PyObject **items, Py_ssize_t n)
+{
+  Py_ssize_t i;
+
+  for (i = 0; i < n; i++)
+    Py_DECREF(items[i]);
+  PyMem_Free(items);
+}
+
+/*******************************************************************************
+ * adt.List
+ */
+
+typedef struct {
+  PyObject_HEAD
+  struct ADT_sl_list list;
+  unsigned long state;          /* bumped by every mutation */
+} ADT_ListObject;
+
+typedef struct {
+  PyObject_HEAD
+  ADT_ListObject *list;
+  struct ADT_sl_node *node;
+  unsigned long state;
+} ADT_ListIterObject;
+
+static PyTypeObject ADT_ListType;
+static PyTypeObject ADT_ListIterType;
+
+static PyObject *
+ADT_List_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+  ADT_ListObject *self = (ADT_ListObject *)type->tp_alloc(type, 0);
+
+  if (self == NULL)
+    return NULL;
+  ADT_sl_list_init(&self->list);
+  self->state = 0;
+  return (PyObject *)self;
+}
+
+static PyObject *ADT_List_extend(ADT_ListObject *, PyObject *);
+
+static int
+ADT_List_init(ADT_ListObject *self, PyObject *args, PyObject *kwds)
+{
+  PyObject *iterable = NULL, *res;
+
+  if (!PyArg_ParseTuple(args, "|O:List", &iterable))
+    return -1;
+  if (iterable == NULL)
+    return 0;
+  res = ADT_List_extend(self, iterable);
+  if (res == NULL)
+    return -1;
+  Py_DECREF(res);
+  return 0;
+}
+
+static int
+ADT_List_traverse(ADT_ListObject *self, visitproc visit, void *arg)
+{
+  struct ADT_sl_node *node;
+
+  for (node = self->list.head; node != NULL && self->list.len != 0; node = node->next)
+    Py_VISIT((PyObject *)node->data);
+  return 0;
+}
+
+static int
+ADT_List_clear(ADT_ListObject *self)
+{
+  self->state++;
+  ADT_sl_list_destroy(&self->list, &ADT_py_decref);
+  return 0;
+}
+
+static void
+ADT_List_dealloc(ADT_ListObject *self)
+{
+  PyObject_GC_UnTrack(self);
+  ADT_List_clear(self);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static Py_ssize_t
+ADT_List_length(ADT_ListObject *self)
+{
+  return ADT_sl_list_length(&self->list);
+}
+
+static PyObject *
+ADT_List_append(ADT_ListObject *self, PyObject *obj)
+{
+  if (ADT_sl_list_append(&self->list, obj) != 0)
+    return PyErr_NoMemory();
+  Py_INCREF(obj);
+  self->state++;
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+ADT_List_appendleft(ADT_ListObject *self, PyObject *obj)
+{
+  if (ADT_sl_list_push(&self->list, obj) != 0)
+    return PyErr_NoMemory();
+  Py_INCREF(obj);
+  self->state++;
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+ADT_List_popleft(ADT_ListObject *self, PyObject *unused)
+{
+  void *obj;
+
+  if (ADT_sl_list_length(&self->list) == 0) {
+    PyErr_SetString(PyExc_IndexError, "pop from an empty List");
+    return NULL;
+  }
+  ADT_sl_list_pop(&self->list, &obj);
+  self->state++;
+  /* The list's reference passes to the caller. */
+  return (PyObject *)obj;
+}
+
+static PyObject *
+ADT_List_extend(ADT_ListObject *self, PyObject *iterable)
+{
+  PyObject **items;
+  Py_ssize_t n;
+
+  items = ADT_py_items(iterable, &n);
+  if (items == NULL)
+    return NULL;
+  if (ADT_sl_list_append_n(&self->list, (void **)items, n) != 0) {
+    ADT_py_items_free(items, n);
+    return PyErr_NoMemory();
+  }
+  PyMem_Free(items);
+  self->state++;
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+ADT_List_clear_method(ADT_ListObject *self, PyObject *unused)
+{
+  ADT_List_clear(self);
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+ADT_List_iter(ADT_ListObject *self)
+{
+  ADT_ListIterObject *it = PyObject_GC_New(ADT_ListIterObject, &ADT_ListIterType);
+
+  if (it == NULL)
+    return NULL;
+  Py_INCREF(self);
+  it->list = self;
+  it->node = self->list.len ? self->list.head : NULL;
+  it->state = self->state;
+  PyObject_GC_Track(it);
+  return (PyObject *)it;
+}
+
+static PyMethodDef ADT_List_methods[] = {
+  {"append", (PyCFunction)ADT_List_append, METH_O, "Add an item at the end."},
+  {"appendleft", (PyCFunction)ADT_List_appendleft, METH_O, "Add an item at the front."},
+  {"popleft", (PyCFunction)ADT_List_popleft, METH_NOARGS, "Remove and return the first item."},
+  {"extend", (PyCFunction)ADT_List_extend, METH_O, "Append every item of an iterable or buffer."},
+  {"clear", (PyCFunction)ADT_List_clear_method, METH_NOARGS, "Remove every item."},
+  {NULL}
+};
+
+static PySequenceMethods ADT_List_as_sequence = {
+  (lenfunc)ADT_List_length,
+};
+
+static PyTypeObject ADT_ListType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  .tp_name = "adt.List",
+  .tp_basicsize = sizeof(ADT_ListObject),
+  .tp_dealloc = (destructor)ADT_List_dealloc,
+  .tp_as_sequence = &ADT_List_as_sequence,
+  .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+  .tp_doc = "Single linked list (ADT_sl_list).",
+  .tp_traverse = (traverseproc)ADT_List_traverse,
+  .tp_clear = (inquiry)ADT_List_clear,
+  .tp_iter = (getiterfunc)ADT_List_iter,
+  .tp_methods = ADT_List_methods,
+  .tp_init = (initproc)ADT_List_init,
+  .tp_new = ADT_List_new,
+};
+
+static int
+ADT_ListIter_traverse(ADT_ListIterObject *it, visitproc visit, void *arg)
+{
+  Py_VISIT(it->list);
+  return 0;
+}
+
+static void
+ADT_ListIter_dealloc(ADT_ListIterObject *it)
+{
+  PyObject_GC_UnTrack(it);
+  Py_XDECREF(it->list);
+  PyObject_GC_Del(it);
+}
+
+static PyObject *
+ADT_ListIter_next(ADT_ListIterObject *it)
+{
+  PyObject *obj;
+
+  if (it->node == NULL)
+    return NULL;
+  /* Any mutation may have freed the node the iterator is parked on. */
+  if (it->state != it->list->state) {
+    it->node = NULL;
+    PyErr_SetString(PyExc_RuntimeError, "List mutated during iteration");
+    return NULL;
+  }
+  obj = (PyObject *)it->node->data;
+  it->node = it->node->next;
+  Py_INCREF(obj);
+  return obj;
+}
+
+static PyTypeObject ADT_ListIterType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  .tp_name = "adt.ListIterator",
+  .tp_basicsize = sizeof(ADT_ListIterObject),
+  .tp_dealloc = (destructor)ADT_ListIter_dealloc,
+  .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+  .tp_traverse = (traverseproc)ADT_ListIter_traverse,
+  .tp_iter = PyObject_SelfIter,
+  .tp_iternext = (iternextfunc)ADT_ListIter_next,
+};
+
+/*******************************************************************************
+ * adt.Queue
+ */
+
+typedef struct {
+  PyObject_HEAD
+  struct ADT_ms_queue queue;
+  Py_ssize_t len;
+} ADT_QueueObject;
+
+static PyObject *
+ADT_Queue_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+  ADT_QueueObject *self = (ADT_QueueObject *)type->tp_alloc(type, 0);
+
+  if (self == NULL)
+    return NULL;
+  if (ADT_ms_queue_init(&self->queue) != 0) {
+    /* tp_dealloc must not see a half built queue. */
+    atomic_init(&self->queue.head, NULL);
+    Py_DECREF(self);
+    return PyErr_NoMemory();
+  }
+  self->len = 0;
+  return (PyObject *)self;
+}
+
+static int
+ADT_Queue_traverse(ADT_QueueObject *self, visitproc visit, void *arg)
+{
+  struct ADT_ms_node *node;
+
+  if (atomic_load(&self->queue.head) == NULL)
+    return 0;
+  for (node = atomic_load(&atomic_load(&self->queue.head)->next); node != NULL;
+       node = atomic_load(&node->next))
+    Py_VISIT((PyObject *)node->data);
+  return 0;
+}
+
+static int
+ADT_Queue_clear(ADT_QueueObject *self)
+{
+  void *obj;
+
+  if (atomic_load(&self->queue.head) == NULL)
+    return 0;
+  while (ADT_ms_queue_dequeue(&self->queue, &obj) == 0)
+    Py_DECREF((PyObject *)obj);
+  self->len = 0;
+  return 0;
+}
+
+static void
+ADT_Queue_dealloc(ADT_QueueObject *self)
+{
+  PyObject_GC_UnTrack(self);
+  if (atomic_load(&self->queue.head) != NULL)
+    ADT_ms_queue_destroy(&self->queue, &ADT_py_decref);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static Py_ssize_t
+ADT_Queue_length(ADT_QueueObject *self)
+{
+  return self->len;
+}
+
+static PyObject *
+ADT_Queue_enqueue(ADT_QueueObject *self, PyObject *obj)
+{
+  if (ADT_ms_queue_enqueue(&self->queue, obj) != 0)
+    return PyErr_NoMemory();
+  Py_INCREF(obj);
+  self->len++;
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+ADT_Queue_dequeue(ADT_QueueObject *self, PyObject *unused)
+{
+  void *obj;
+
+  if (ADT_ms_queue_dequeue(&self->queue, &obj) != 0) {
+    PyErr_SetString(PyExc_IndexError, "dequeue from an empty Queue");
+    return NULL;
+  }
+  self->len--;
+  return (PyObject *)obj;
+}
+
+static PyObject *
+ADT_Queue_extend(ADT_QueueObject *self, PyObject *iterable)
+{
+  PyObject **items;
+  Py_ssize_t n, i;
+
+  items = ADT_py_items(iterable, &n);
+  if (items == NULL)
+    return NULL;
+  for (i = 0; i < n; i++) {
+    if (ADT_ms_queue_enqueue(&self->queue, items[i]) != 0) {
+      ADT_py_items_free(items + i, n - i);
+      self->len += i;
+      return PyErr_NoMemory();
+    }
+  }
+  PyMem_Free(items);
+  self->len += n;
+  Py_RETURN_NONE;
+}
+
+static PyMethodDef ADT_Queue_methods[] = {
+  {"enqueue", (PyCFunction)ADT_Queue_enqueue, METH_O, "Add an item at the tail."},
+  {"dequeue", (PyCFunction)ADT_Queue_dequeue, METH_NOARGS, "Remove and return the oldest item."},
+  {"extend", (PyCFunction)ADT_Queue_extend, METH_O, "Enqueue every item of an iterable or buffer."},
+  {NULL}
+};
+
+static PySequenceMethods ADT_Queue_as_sequence = {
+  (lenfunc)ADT_Queue_length,
+};
+
+static PyTypeObject ADT_QueueType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  .tp_name = "adt.Queue",
+  .tp_basicsize = sizeof(ADT_QueueObject),
+  .tp_dealloc = (destructor)ADT_Queue_dealloc,
+  .tp_as_sequence = &ADT_Queue_as_sequence,
+  .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+  .tp_doc = "Lock-free MPMC queue (ADT_ms_queue).",
+  .tp_traverse = (traverseproc)ADT_Queue_traverse,
+  .tp_clear = (inquiry)ADT_Queue_clear,
+  .tp_methods = ADT_Queue_methods,
+  .tp_new = ADT_Queue_new,
+};
+
+/*******************************************************************************
+ * adt.Ring
+ */
+
+typedef struct {
+  PyObject_HEAD
+  struct ADT_ring ring;
+} ADT_RingObject;
+
+static PyObject *
+ADT_Ring_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+  static char *kwlist[] = {"capacity", "policy", NULL};
+  ADT_RingObject *self;
+  unsigned int capacity;
+  int policy = ADT_RING_FAIL;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "I|i:Ring", kwlist, &capacity, &policy))
+    return NULL;
+  if (policy < ADT_RING_FAIL || policy > ADT_RING_GROW) {
+    PyErr_SetString(PyExc_ValueError, "policy must be RING_FAIL, RING_OVERWRITE or RING_GROW");
+    return NULL;
+  }
+  self = (ADT_RingObject *)type->tp_alloc(type, 0);
+  if (self == NULL)
+    return NULL;
+  if (ADT_ring_init(&self->ring, capacity, (enum ADT_ring_policy)policy) != 0) {
+    self->ring.buf = NULL;
+    Py_DECREF(self);
+    if (capacity == 0)
+      PyErr_SetString(PyExc_ValueError, "capacity must be positive");
+    else
+      PyErr_NoMemory();
+    return NULL;
+  }
+  return (PyObject *)self;
+}
+
+static int
+ADT_Ring_traverse(ADT_RingObject *self, visitproc visit, void *arg)
+{
+  unsigned int i;
+
+  if (self->ring.buf == NULL)
+    return 0;
+  for (i = self->ring.head; i != self->ring.tail; i++)
+    Py_VISIT((PyObject *)self->ring.buf[i & self->ring.mask]);
+  return 0;
+}
+
+static int
+ADT_Ring_clear(ADT_RingObject *self)
+{
+  void *obj;
+
+  if (self->ring.buf == NULL)
+    return 0;
+  while (ADT_ring_dequeue(&self->ring, &obj) == 0)
+    Py_DECREF((PyObject *)obj);
+  return 0;
+}
+
+static void
+ADT_Ring_dealloc(ADT_RingObject *self)
+{
+  PyObject_GC_UnTrack(self);
+  if (self->ring.buf != NULL)
+    ADT_ring_destroy(&self->ring, &ADT_py_decref);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static Py_ssize_t
+ADT_Ring_length(ADT_RingObject *self)
+{
+  return ADT_ring_length(&self->ring);
+}
+
+/*
+ * Enqueue obj, stealing a reference to it. A full overwrite ring has its
+ * oldest item dequeued here rather than dropped by ADT_ring_enqueue, and
+ * released only once obj is in, so a __del__ it runs sees a consistent
+ * ring and may use it.
+ * Returns: 0 on success, or -1 if the ring is full or cannot grow.
+ */
+static int
+ADT_Ring_put(ADT_RingObject *self, PyObject *obj)
+{
+  void *victim = NULL;
+  int rc;
+
+  if (self->ring.policy == ADT_RING_OVERWRITE &&
+      ADT_ring_length(&self->ring) == self->ring.mask + 1)
+    ADT_ring_dequeue(&self->ring, &victim);
+  rc = ADT_ring_enqueue(&self->ring, obj);
+  Py_XDECREF((PyObject *)victim);
+  return rc;
+}
+
+static PyObject *
+ADT_Ring_enqueue(ADT_RingObject *self, PyObject *obj)
+{
+  Py_INCREF(obj);
+  if (ADT_Ring_put(self, obj) != 0) {
+    Py_DECREF(obj);
+    if (self->ring.policy == ADT_RING_GROW)
+      return PyErr_NoMemory();
+    PyErr_SetString(ADTError, "Ring is full");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+ADT_Ring_dequeue(ADT_RingObject *self, PyObject *unused)
+{
+  void *obj;
+
+  if (ADT_ring_dequeue(&self->ring, &obj) != 0) {
+    PyErr_SetString(PyExc_IndexError, "dequeue from an empty Ring");
+    return NULL;
+  }
+  return (PyObject *)obj;
+}
+
+static PyObject *
+ADT_Ring_extend(ADT_RingObject *self, PyObject *iterable)
+{
+  PyObject **items;
+  Py_ssize_t n, i;
+
+  items = ADT_py_items(iterable, &n);
+  if (items == NULL)
+    return NULL;
+  for (i = 0; i < n; i++) {
+    if (ADT_Ring_put(self, items[i]) != 0) {
+      ADT_py_items_free(items + i, n - i);
+      if (self->ring.policy == ADT_RING_GROW)
+        return PyErr_NoMemory();
+      PyErr_SetString(ADTError, "Ring is full");
+      return NULL;
+    }
+  }
+  PyMem_Free(items);
+  Py_RETURN_NONE;
+}
+
+static PyMethodDef ADT_Ring_methods[] = {
+  {"enqueue", (PyCFunction)ADT_Ring_enqueue, METH_O, "Add an item, applying the full policy."},
+  {"dequeue", (PyCFunction)ADT_Ring_dequeue, METH_NOARGS, "Remove and return the oldest item."},
+  {"extend", (PyCFunction)ADT_Ring_extend, METH_O, "Enqueue every item of an iterable or buffer."},
+  {NULL}
+};
+
+static PySequenceMethods ADT_Ring_as_sequence = {
+  (lenfunc)ADT_Ring_length,
+};
+
+static PyTypeObject ADT_RingType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  .tp_name = "adt.Ring",
+  .tp_basicsize = sizeof(ADT_RingObject),
+  .tp_dealloc = (destructor)ADT_Ring_dealloc,
+  .tp_as_sequence = &ADT_Ring_as_sequence,
+  .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+  .tp_doc = "Ring(capacity, policy=RING_FAIL): bounded ring buffer queue (ADT_ring).",
+  .tp_traverse = (traverseproc)ADT_Ring_traverse,
+  .tp_clear = (inquiry)ADT_Ring_clear,
+  .tp_methods = ADT_Ring_methods,
+  .tp_new = ADT_Ring_new,
+};
+
+/*******************************************************************************
+ * Module
+ */
+
+static struct PyModuleDef ADT_module = {
+  PyModuleDef_HEAD_INIT,
+  "adt",
+  "Lists and queues from libadt.",
+  -1,
+  NULL
+};
+
+PyMODINIT_FUNC
+PyInit_adt(void)
+{
+  PyObject *m;
+
+  if (PyType_Ready(&ADT_ListType) < 0 || PyType_Ready(&ADT_ListIterType) < 0 ||
+      PyType_Ready(&ADT_QueueType) < 0 || PyType_Ready(&ADT_RingType) < 0)
+    return NULL;
+  m = PyModule_Create(&ADT_module);
+  if (m == NULL)
+    return NULL;
+  ADTError = PyErr_NewException("adt.error", NULL, NULL);
+  if (PyModule_AddObjectRef(m, "error", ADTError) < 0 ||
+      PyModule_AddObjectRef(m, "List", (PyObject *)&ADT_ListType) < 0 ||
+      PyModule_AddObjectRef(m, "Queue", (PyObject *)&ADT_QueueType) < 0 ||
+      PyModule_AddObjectRef(m, "Ring", (PyObject *)&ADT_RingType) < 0 ||
+      PyModule_AddIntConstant(m, "RING_FAIL", ADT_RING_FAIL) < 0 ||
+      PyModule_AddIntConstant(m, "RING_OVERWRITE", ADT_RING_OVERWRITE) < 0 ||
+      PyModule_AddIntConstant(m, "RING_GROW", ADT_RING_GROW) < 0) {
+    Py_DECREF(m);
+    return NULL;
+  }
+  return m;
+}
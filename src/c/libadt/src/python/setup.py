@@ -0,0 +1,25 @@
+"""
+Build the adt extension module against the libadt sources one level up:
+
+    python setup.py build_ext --inplace
+"""
+import glob
+import os
+
+from setuptools import setup, Extension
+
+here = os.path.dirname(os.path.abspath(__file__))
+libadt = os.path.dirname(here)
+
+setup(
+    name="adt",
+    version="0.1",
+    ext_modules=[
+        Extension(
+            "adt",
+            sources=["adtmodule.c"] + sorted(glob.glob(os.path.join(libadt, "*.c"))),
+            include_dirs=[libadt],
+            libraries=["pthread"],
+        ),
+    ],
+)
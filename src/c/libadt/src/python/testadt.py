@@ -0,0 +1,135 @@
+#!/usr/bin/env python
+"""
+Tests for the adt extension module. Build it first with
+python setup.py build_ext --inplace.
+"""
+import array
+import ctypes
+import gc
+import sys
+import unittest
+
+import adt
+
+
+class Tracked(object):
+    alive = 0
+
+    def __init__(self):
+        Tracked.alive += 1
+
+    def __del__(self):
+        Tracked.alive -= 1
+
+
+class TestList(unittest.TestCase):
+
+    def test_append_popleft(self):
+        l = adt.List()
+        l.append('b')
+        l.appendleft('a')
+        self.assertEqual(len(l), 2)
+        self.assertEqual(l.popleft(), 'a')
+        self.assertEqual(l.popleft(), 'b')
+        self.assertRaises(IndexError, l.popleft)
+
+    def test_extend_and_iter(self):
+        l = adt.List(range(3))
+        l.extend((3, 4))
+        l.extend(x for x in (5, 6))
+        self.assertEqual(list(l), list(range(7)))
+
+    def test_extend_buffer(self):
+        l = adt.List()
+        l.extend(array.array('q', [1, -2, 3]))
+        l.extend(array.array('d', [0.5]))
+        self.assertEqual(list(l), [1, -2, 3, 0.5])
+        self.assertRaises(TypeError, l.extend, 5)
+
+    def test_extend_buffer_standard_sizes(self):
+        # ctypes exports explicit byte order formats such as '<h'.
+        shorts = (ctypes.c_int16 * 3)(1, -2, 3)
+        self.assertNotEqual(memoryview(shorts).format[0], '@')
+        l = adt.List()
+        l.extend(shorts)
+        self.assertEqual(list(l), [1, -2, 3])
+
+    def test_mutation_during_iteration(self):
+        l = adt.List([1, 2, 3])
+        it = iter(l)
+        next(it)
+        l.popleft()
+        self.assertRaises(RuntimeError, next, it)
+
+    def test_references(self):
+        obj = object()
+        before = sys.getrefcount(obj)
+        l = adt.List([obj, obj])
+        self.assertEqual(sys.getrefcount(obj), before + 2)
+        l.popleft()
+        self.assertEqual(sys.getrefcount(obj), before + 1)
+        del l
+        self.assertEqual(sys.getrefcount(obj), before)
+
+    def test_cycle_collected(self):
+        l = adt.List()
+        l.append(l)
+        l.append(Tracked())
+        del l
+        gc.collect()
+        self.assertEqual(Tracked.alive, 0)
+
+
+class TestQueue(unittest.TestCase):
+
+    def test_enqueue_dequeue(self):
+        q = adt.Queue()
+        q.extend([1, 2])
+        q.enqueue(3)
+        self.assertEqual(len(q), 3)
+        self.assertEqual([q.dequeue() for i in range(3)], [1, 2, 3])
+        self.assertRaises(IndexError, q.dequeue)
+
+
+class TestRing(unittest.TestCase):
+
+    def test_fail(self):
+        r = adt.Ring(2)
+        r.extend([1, 2])
+        self.assertRaises(adt.error, r.enqueue, 3)
+        self.assertEqual(r.dequeue(), 1)
+
+    def test_overwrite(self):
+        r = adt.Ring(2, adt.RING_OVERWRITE)
+        r.enqueue(Tracked())
+        r.extend([1, 2])
+        self.assertEqual(Tracked.alive, 0)
+        self.assertEqual([r.dequeue(), r.dequeue()], [1, 2])
+
+    def test_overwrite_reentrant(self):
+        class Requeue(object):
+            def __init__(self, ring):
+                self.ring = ring
+
+            def __del__(self):
+                self.ring.enqueue('y')
+
+        r = adt.Ring(2, adt.RING_OVERWRITE)
+        r.enqueue(Requeue(r))
+        r.enqueue(2)
+        r.enqueue(3)
+        self.assertEqual(len(r), 2)
+        self.assertEqual([r.dequeue(), r.dequeue()], [3, 'y'])
+        r.extend([Requeue(r), 4, 5])
+        self.assertEqual(len(r), 2)
+        self.assertEqual([r.dequeue(), r.dequeue()], [5, 'y'])
+
+    def test_grow(self):
+        r = adt.Ring(1, policy=adt.RING_GROW)
+        r.extend(range(100))
+        self.assertEqual(len(r), 100)
+        self.assertRaises(ValueError, adt.Ring, 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
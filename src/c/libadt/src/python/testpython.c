@@ -1,4 +0,0 @@
-#include "Python.h"
-#include "adt.h"
-
-static PyObject *ADTError;
@@ -0,0 +1,242 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ring.h"
+
+static unsigned int
+ADT_ring_round(unsigned int n)
+{
+  unsigned int cap = 1;
+
+  while (cap < n && cap != 0)
+    cap <<= 1;
+  return cap;
+}
+
+/*
+ * Return a new initialized ring with room for capacity elements, rounded up
+ * to a power of two.
+ * Pre: ring is a pointer to a newly created ADT_ring.
+ * Post: ring is empty. The array comes from the library-wide allocator.
+ * Returns: 0 on success or -1 on a bad capacity or an allocation error.
+ */
+int
+ADT_ring_init(struct ADT_ring *ring, unsigned int capacity, enum ADT_ring_policy policy)
+{
+  return ADT_ring_init_alloc(ring, capacity, policy, ADT_get_allocator());
+}
+
+/*
+ * As ADT_ring_init, but the array comes from alloc, which must outlive ring.
+ */
+int
+ADT_ring_init_alloc(struct ADT_ring *ring, unsigned int capacity,
+                    enum ADT_ring_policy policy, const struct ADT_allocator *alloc)
+{
+  unsigned int cap = ADT_ring_round(capacity);
+
+  if (capacity == 0 || cap == 0)
+    return -1;
+  ring->buf = (void **)ADT_alloc(alloc, cap * sizeof(void *));
+  if (ring->buf == NULL)
+    return -1;
+  ring->mask = cap - 1;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->policy = policy;
+  ring->drop = NULL;
+  ring->alloc = alloc;
+  return 0;
+}
+
+/*
+ * Remove all items from ring and call the designated destroy fn to free
+ * them, then release the array.
+ * Pre: destroy must be a valid function for freeing ring data or NULL.
+ */
+void
+ADT_ring_destroy(struct ADT_ring *ring, void (*destroy)(void *))
+{
+  void *data;
+
+  while (destroy != NULL && ADT_ring_dequeue(ring, &data) == 0)
+    (*destroy)(data);
+  ADT_free(ring->alloc, ring->buf);
+  ring->buf = NULL;
+  ring->head = 0;
+  ring->tail = 0;
+}
+
+static int
+ADT_ring_grow(struct ADT_ring *ring)
+{
+  unsigned int cap = ring->mask + 1, h = ring->head & ring->mask;
+  void **buf;
+
+  if (cap * 2 == 0)
+    return -1;
+  buf = (void **)ADT_alloc(ring->alloc, 2 * cap * sizeof(void *));
+  if (buf == NULL)
+    return -1;
+  /* Unwrap the full ring so its elements start at index 0. */
+  memcpy(buf, ring->buf + h, (cap - h) * sizeof(void *));
+  memcpy(buf + cap - h, ring->buf, h * sizeof(void *));
+  ADT_free(ring->alloc, ring->buf);
+  ring->buf = buf;
+  ring->mask = 2 * cap - 1;
+  ring->head = 0;
+  ring->tail = cap;
+  return 0;
+}
+
+/*
+ * Insert data at the tail of ring.
+ * Pre: ring must be a pointer to an initialized ADT_ring structure.
+ * Post: data is the newest element of ring. A full ring first applies
+ *       its policy.
+ * Returns: 0 on success, or -1 if the ring is full under ADT_RING_FAIL or
+ *          cannot grow under ADT_RING_GROW.
+ */
+int
+ADT_ring_enqueue(struct ADT_ring *ring, void *data)
+{
+  void *old;
+
+  if (ring->tail - ring->head > ring->mask) {
+    switch (ring->policy) {
+    case ADT_RING_FAIL:
+      return -1;
+    case ADT_RING_OVERWRITE:
+      old = ring->buf[ring->head++ & ring->mask];
+      if (ring->drop != NULL)
+        (*ring->drop)(old);
+      break;
+    case ADT_RING_GROW:
+      if (ADT_ring_grow(ring) != 0)
+        return -1;
+      break;
+    }
+  }
+  ring->buf[ring->tail++ & ring->mask] = data;
+  return 0;
+}
+
+/*
+ * Remove data from the head of ring.
+ * Post: on success data points to the oldest element, which is removed.
+ * Returns: 0 on success or -1 if ring is empty.
+ */
+int
+ADT_ring_dequeue(struct ADT_ring *ring, void **data)
+{
+  if (ring->head == ring->tail)
+    return -1;
+  *data = ring->buf[ring->head++ & ring->mask];
+  return 0;
+}
+
+unsigned int
+ADT_ring_length(struct ADT_ring *ring)
+{
+  return ring->tail - ring->head;
+}
+
+/*
+ * Return a new initialized SPSC ring with room for capacity elements,
+ * rounded up to a power of two.
+ * Pre: ring is a pointer to a newly created ADT_spsc_ring.
+ * Returns: 0 on success or -1 on a bad capacity or an allocation error.
+ */
+int
+ADT_spsc_ring_init(struct ADT_spsc_ring *ring, unsigned int capacity)
+{
+  return ADT_spsc_ring_init_alloc(ring, capacity, ADT_get_allocator());
+}
+
+/*
+ * As ADT_spsc_ring_init, but the array comes from alloc, which must outlive
+ * ring.
+ */
+int
+ADT_spsc_ring_init_alloc(struct ADT_spsc_ring *ring, unsigned int capacity,
+                         const struct ADT_allocator *alloc)
+{
+  unsigned int cap = ADT_ring_round(capacity);
+
+  if (capacity == 0 || cap == 0)
+    return -1;
+  ring->buf = (void **)ADT_alloc(alloc, cap * sizeof(void *));
+  if (ring->buf == NULL)
+    return -1;
+  ring->mask = cap - 1;
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+  ring->head_cache = 0;
+  ring->tail_cache = 0;
+  ring->alloc = alloc;
+  return 0;
+}
+
+/*
+ * Remove all items from ring and call the designated destroy fn to free
+ * them, then release the array.
+ * Pre: neither the producer nor the consumer is still using ring.
+ */
+void
+ADT_spsc_ring_destroy(struct ADT_spsc_ring *ring, void (*destroy)(void *))
+{
+  void *data;
+
+  while (destroy != NULL && ADT_spsc_ring_dequeue(ring, &data) == 0)
+    (*destroy)(data);
+  ADT_free(ring->alloc, ring->buf);
+  ring->buf = NULL;
+}
+
+/*
+ * Insert data at the tail of ring. Only the producer thread may call this.
+ * Returns: 0 on success or -1 if ring is full.
+ */
+int
+ADT_spsc_ring_enqueue(struct ADT_spsc_ring *ring, void *data)
+{
+  unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+  if (tail - ring->head_cache > ring->mask) {
+    ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail - ring->head_cache > ring->mask)
+      return -1;
+  }
+  ring->buf[tail & ring->mask] = data;
+  atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+  return 0;
+}
+
+/*
+ * Remove data from the head of ring. Only the consumer thread may call this.
+ * Post: on success data points to the oldest element, which is removed.
+ * Returns: 0 on success or -1 if ring is empty.
+ */
+int
+ADT_spsc_ring_dequeue(struct ADT_spsc_ring *ring, void **data)
+{
+  unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+  if (head == ring->tail_cache) {
+    ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head == ring->tail_cache)
+      return -1;
+  }
+  *data = ring->buf[head & ring->mask];
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+  return 0;
+}
+
+/*
+ * Return the number of queued elements. From a thread other than the
+ * producer or consumer this is only a snapshot.
+ */
+unsigned int
+ADT_spsc_ring_length(struct ADT_spsc_ring *ring)
+{
+  return atomic_load(&ring->tail) - atomic_load(&ring->head);
+}
@@ -0,0 +1,73 @@
+#ifndef _ADT_RING_H
+#define _ADT_RING_H
+
+#include <stdatomic.h>
+#include "alloc.h"
+#include "cache.h"
+
+/*******************************************************************************
+ * Ring buffer queue
+ *
+ * A bounded queue over a power of two array of data pointers, for callers
+ * with a known maximum depth. Head and tail run freely and are masked on
+ * access, so a full ring uses every slot. What enqueue does on a full ring
+ * is chosen at init time:
+ *
+ *   ADT_RING_FAIL       enqueue returns -1 and the ring is unchanged.
+ *   ADT_RING_OVERWRITE  the oldest element is dropped, and passed to the
+ *                       ring's drop fn if one is set.
+ *   ADT_RING_GROW       the array is doubled.
+ */
+
+enum ADT_ring_policy {
+  ADT_RING_FAIL,
+  ADT_RING_OVERWRITE,
+  ADT_RING_GROW
+};
+
+struct ADT_ring {
+  void **buf;
+  unsigned int mask;
+  unsigned int head;
+  unsigned int tail;
+  enum ADT_ring_policy policy;
+  void (*drop)(void *);                 /* overwritten elements, may be NULL */
+  const struct ADT_allocator *alloc;    /* array source */
+};
+
+int ADT_ring_init(struct ADT_ring *, unsigned int, enum ADT_ring_policy);
+int ADT_ring_init_alloc(struct ADT_ring *, unsigned int, enum ADT_ring_policy,
+                        const struct ADT_allocator *);
+void ADT_ring_destroy(struct ADT_ring *, void (*destroy)(void *));
+int ADT_ring_enqueue(struct ADT_ring *, void *);
+int ADT_ring_dequeue(struct ADT_ring *, void **);
+unsigned int ADT_ring_length(struct ADT_ring *);
+
+/*******************************************************************************
+ * Lock-free single producer, single consumer ring buffer
+ *
+ * One thread may enqueue while another dequeues. Each side owns its index on
+ * its own cache line, next to a cached copy of the other side's index, so
+ * the shared lines only move when the cached view runs out. A full ring
+ * always fails: overwriting or growing would need the consumer's index.
+ */
+
+struct ADT_spsc_ring {
+  _Alignas(ADT_CACHE_LINE) atomic_uint head;    /* consumer */
+  unsigned int tail_cache;
+  _Alignas(ADT_CACHE_LINE) atomic_uint tail;    /* producer */
+  unsigned int head_cache;
+  _Alignas(ADT_CACHE_LINE) void **buf;
+  unsigned int mask;
+  const struct ADT_allocator *alloc;
+};
+
+int ADT_spsc_ring_init(struct ADT_spsc_ring *, unsigned int);
+int ADT_spsc_ring_init_alloc(struct ADT_spsc_ring *, unsigned int, const struct ADT_allocator *);
+void ADT_spsc_ring_destroy(struct ADT_spsc_ring *, void (*destroy)(void *));
+int ADT_spsc_ring_enqueue(struct ADT_spsc_ring *, void *);
+int ADT_spsc_ring_dequeue(struct ADT_spsc_ring *, void **);
+unsigned int ADT_spsc_ring_length(struct ADT_spsc_ring *);
+
+
+#endif
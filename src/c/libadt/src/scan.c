@@ -0,0 +1,243 @@
+#include <stdint.h>
+#include <string.h>
+#include "scan.h"
+#if UINTPTR_MAX == UINT64_MAX && defined(__x86_64__) && defined(__GNUC__)
+  #define ADT_SCAN_X86 1
+  #include <immintrin.h>
+#elif UINTPTR_MAX == UINT64_MAX && defined(__aarch64__) && defined(__ARM_NEON)
+  #define ADT_SCAN_NEON 1
+  #include <arm_neon.h>
+#endif
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+#define ADT_key(v, i) ((uintptr_t)(v)[i])
+
+static size_t
+ADT_find_scalar(const void *const *v, size_t n, const void *key)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    if (v[i] == key)
+      return i;
+  }
+  return n;
+}
+
+/* Keys within [lo, lo + span] are exactly those whose offset from lo is at most span. */
+static size_t
+ADT_filter_scalar(const void *const *v, size_t n, uintptr_t lo, uintptr_t span, void **out)
+{
+  size_t i, m = 0;
+
+  for (i = 0; i < n; i++) {
+    if (ADT_key(v, i) - lo <= span)
+      out[m++] = (void *)v[i];
+  }
+  return m;
+}
+
+#if defined(ADT_SCAN_X86)
+
+/* SSE2 has no 64-bit compare: two lanes match when both their halves do. */
+static size_t
+ADT_find_sse2(const void *const *v, size_t n, const void *key)
+{
+  __m128i k = _mm_set1_epi64x((long long)(uintptr_t)key), eq;
+  size_t i;
+  int m;
+
+  for (i = 0; i + 2 <= n; i += 2) {
+    eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(v + i)), k);
+    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    m = _mm_movemask_pd(_mm_castsi128_pd(eq));
+    if (m != 0)
+      return i + (size_t)__builtin_ctz((unsigned int)m);
+  }
+  return i + ADT_find_scalar(v + i, n - i, key);
+}
+
+__attribute__((target("avx2"))) static size_t
+ADT_find_avx2(const void *const *v, size_t n, const void *key)
+{
+  __m256i k = _mm256_set1_epi64x((long long)(uintptr_t)key), a, b;
+  size_t i;
+  int m;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    a = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(v + i)), k);
+    b = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(v + i + 4)), k);
+    if (_mm256_testz_si256(_mm256_or_si256(a, b), _mm256_or_si256(a, b)))
+      continue;
+    m = _mm256_movemask_pd(_mm256_castsi256_pd(a)) |
+        (_mm256_movemask_pd(_mm256_castsi256_pd(b)) << 4);
+    return i + (size_t)__builtin_ctz((unsigned int)m);
+  }
+  for (; i + 4 <= n; i += 4) {
+    a = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(v + i)), k);
+    m = _mm256_movemask_pd(_mm256_castsi256_pd(a));
+    if (m != 0)
+      return i + (size_t)__builtin_ctz((unsigned int)m);
+  }
+  return i + ADT_find_scalar(v + i, n - i, key);
+}
+
+/* Unsigned offset <= span, as a signed compare with both sides biased. */
+__attribute__((target("avx2"))) static size_t
+ADT_filter_avx2(const void *const *v, size_t n, uintptr_t lo, uintptr_t span, void **out)
+{
+  __m256i bias = _mm256_set1_epi64x(INT64_MIN), l = _mm256_set1_epi64x((long long)lo);
+  __m256i s = _mm256_xor_si256(_mm256_set1_epi64x((long long)span), bias), d;
+  size_t i, m = 0;
+  unsigned int bits;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    d = _mm256_sub_epi64(_mm256_loadu_si256((const __m256i *)(v + i)), l);
+    d = _mm256_cmpgt_epi64(_mm256_xor_si256(d, bias), s);
+    bits = ~(unsigned int)_mm256_movemask_pd(_mm256_castsi256_pd(d)) & 0xf;
+    for (; bits != 0; bits &= bits - 1)
+      out[m++] = (void *)v[i + (size_t)__builtin_ctz(bits)];
+  }
+  return m + ADT_filter_scalar(v + i, n - i, lo, span, out + m);
+}
+
+/* Without AVX2 only find is vectorized: SSE2 cannot compare 64-bit lanes. */
+#define ADT_find_base ADT_find_sse2
+#define ADT_filter_base ADT_filter_scalar
+#define ADT_SCAN_BASE "sse2"
+
+#elif defined(ADT_SCAN_NEON)
+
+static size_t
+ADT_find_neon(const void *const *v, size_t n, const void *key)
+{
+  uint64x2_t k = vdupq_n_u64((uint64_t)(uintptr_t)key), eq;
+  size_t i;
+
+  for (i = 0; i + 2 <= n; i += 2) {
+    eq = vceqq_u64(vld1q_u64((const uint64_t *)(v + i)), k);
+    if (vgetq_lane_u64(eq, 0) != 0)
+      return i;
+    if (vgetq_lane_u64(eq, 1) != 0)
+      return i + 1;
+  }
+  return i + ADT_find_scalar(v + i, n - i, key);
+}
+
+static size_t
+ADT_filter_neon(const void *const *v, size_t n, uintptr_t lo, uintptr_t span, void **out)
+{
+  uint64x2_t l = vdupq_n_u64(lo), s = vdupq_n_u64(span), in;
+  size_t i, m = 0;
+
+  for (i = 0; i + 2 <= n; i += 2) {
+    in = vcleq_u64(vsubq_u64(vld1q_u64((const uint64_t *)(v + i)), l), s);
+    if (vgetq_lane_u64(in, 0) != 0)
+      out[m++] = (void *)v[i];
+    if (vgetq_lane_u64(in, 1) != 0)
+      out[m++] = (void *)v[i + 1];
+  }
+  return m + ADT_filter_scalar(v + i, n - i, lo, span, out + m);
+}
+
+#define ADT_find_base ADT_find_neon
+#define ADT_filter_base ADT_filter_neon
+#define ADT_SCAN_BASE "neon"
+
+#else
+
+#define ADT_find_base ADT_find_scalar
+#define ADT_filter_base ADT_filter_scalar
+#define ADT_SCAN_BASE "scalar"
+
+#endif
+
+static size_t (*ADT_find_impl)(const void *const *, size_t, const void *) = &ADT_find_base;
+static size_t (*ADT_filter_impl)(const void *const *, size_t, uintptr_t, uintptr_t,
+                                 void **) = &ADT_filter_base;
+static const char *ADT_scan_name = ADT_SCAN_BASE;
+
+#if defined(ADT_SCAN_X86)
+/* Pick the widest kernels the CPU runs before anything can call them. */
+__attribute__((constructor)) static void
+ADT_scan_init(void)
+{
+  ADT_scan_force(NULL);
+}
+#endif
+
+/*
+ * Switch the kernels to the variant named by isa, as ADT_scan_isa names
+ * them, or with isa NULL back to the widest the CPU runs. Meant for tests
+ * and benchmarks comparing the variants; not safe while another thread
+ * scans.
+ * Returns: 0 on success or -1 if the variant is not built in or the CPU
+ *          does not run it, leaving the kernels unchanged.
+ */
+int
+ADT_scan_force(const char *isa)
+{
+#if defined(ADT_SCAN_X86)
+  __builtin_cpu_init();
+  if (isa == NULL)
+    isa = __builtin_cpu_supports("avx2") ? "avx2" : ADT_SCAN_BASE;
+  if (strcmp(isa, "avx2") == 0) {
+    if (!__builtin_cpu_supports("avx2"))
+      return -1;
+    ADT_find_impl = &ADT_find_avx2;
+    ADT_filter_impl = &ADT_filter_avx2;
+    ADT_scan_name = "avx2";
+    return 0;
+  }
+#else
+  if (isa == NULL)
+    isa = ADT_SCAN_BASE;
+#endif
+  if (strcmp(isa, ADT_SCAN_BASE) == 0) {
+    ADT_find_impl = &ADT_find_base;
+    ADT_filter_impl = &ADT_filter_base;
+    ADT_scan_name = ADT_SCAN_BASE;
+  } else if (strcmp(isa, "scalar") == 0) {
+    ADT_find_impl = &ADT_find_scalar;
+    ADT_filter_impl = &ADT_filter_scalar;
+    ADT_scan_name = "scalar";
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+/*
+ * Return the index of the first of the n keys at v equal to key, or n if
+ * there is none.
+ */
+size_t
+ADT_find(const void *const *v, size_t n, const void *key)
+{
+  return (*ADT_find_impl)(v, n, key);
+}
+
+/*
+ * Copy the keys at v that lie in [lo, hi], in order, to out.
+ * Pre: out has room for n pointers.
+ * Returns: the number of keys copied; 0 if lo > hi.
+ */
+size_t
+ADT_filter(const void *const *v, size_t n, uintptr_t lo, uintptr_t hi, void **out)
+{
+  if (lo > hi)
+    return 0;
+  return (*ADT_filter_impl)(v, n, lo, hi - lo, out);
+}
+
+/*
+ * Return the name of the instruction set the kernels use: "avx2", "sse2",
+ * "neon" or "scalar". With "sse2" filter is the scalar loop.
+ */
+const char *
+ADT_scan_isa(void)
+{
+  return ADT_scan_name;
+}
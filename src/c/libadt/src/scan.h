@@ -0,0 +1,29 @@
+#ifndef _ADT_SCAN_H
+#define _ADT_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Vectorized search
+ *
+ * Kernels comparing an array of pointer-sized keys against a key or a
+ * range without a callback per element, for structures that store keys
+ * inline, such as the data blocks of an ADT_ul_node. Keys compare as
+ * unsigned integers (uintptr_t).
+ *
+ * On x86-64 they use AVX2 when the CPU has it, picked once at load time;
+ * on AArch64 NEON. Anything else, or 32-bit pointers, get the scalar loop.
+ * x86-64 without AVX2 runs find on SSE2, but SSE2 has no 64-bit compare
+ * for the unsigned range, so filter falls back to the scalar loop there.
+ * ADT_scan_isa names the variant in use, which for "sse2" is find's, and
+ * ADT_scan_force switches to another, so tests can check each one.
+ */
+
+size_t ADT_find(const void *const *, size_t, const void *);
+size_t ADT_filter(const void *const *, size_t, uintptr_t, uintptr_t, void **);
+const char *ADT_scan_isa(void);
+int ADT_scan_force(const char *);
+
+
+#endif
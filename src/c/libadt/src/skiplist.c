@@ -0,0 +1,565 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "skiplist.h"
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+/* Nodes per pool chunk at level 1; higher levels are rarer. */
+#define ADT_SKIP_PER_CHUNK 64
+
+#define ADT_skip_node_size(type, level) \
+  (offsetof(type, next) + (level) * sizeof(((type *)0)->next[0]))
+
+/*
+ * Draw a level from 1 to ADT_SKIP_MAX_LEVEL, each one a quarter as likely
+ * as the one below, from an xorshift64 generator.
+ */
+static unsigned int
+ADT_skip_random_level(uint64_t *seed)
+{
+  uint64_t x = *seed;
+  unsigned int level = 1;
+
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *seed = x;
+  while ((x & 3) == 0 && level < ADT_SKIP_MAX_LEVEL) {
+    x >>= 2;
+    level++;
+  }
+  return level;
+}
+
+/*
+ * Return a new initialized, empty Skip List ordering keys with
+ * cmp(a, b, ctx).
+ * Pre: list is a pointer to a newly created ADT_skiplist.
+ */
+void
+ADT_skiplist_init(struct ADT_skiplist *list, int (*cmp)(const void *, const void *, void *),
+                  void *ctx)
+{
+  unsigned int i, per_chunk;
+
+  for (i = 0; i < ADT_SKIP_MAX_LEVEL; i++) {
+    list->head[i] = NULL;
+    per_chunk = ADT_SKIP_PER_CHUNK >> (2 * i);
+    ADT_pool_init(&list->pools[i], ADT_skip_node_size(struct ADT_skip_node, i + 1),
+                  (per_chunk > 0) ? per_chunk : 1);
+  }
+  list->level = 1;
+  list->len = 0;
+  list->cmp = cmp;
+  list->ctx = ctx;
+  list->seed = (uint64_t)(uintptr_t)list | 1;
+}
+
+/*
+ * Remove every entry of list, calling destroy_key and destroy_value on its
+ * key and value where they are not NULL, and release its nodes.
+ * Pre: list must be a pointer to an initialized ADT_skiplist structure.
+ * Post: list is empty and may be reused.
+ */
+void
+ADT_skiplist_destroy(struct ADT_skiplist *list, void (*destroy_key)(void *),
+                     void (*destroy_value)(void *))
+{
+  struct ADT_skip_node *node;
+  unsigned int i;
+
+  for (node = list->head[0]; node != NULL; node = node->next[0]) {
+    if (destroy_key != NULL)
+      (*destroy_key)(node->key);
+    if (destroy_value != NULL)
+      (*destroy_value)(node->value);
+  }
+  for (i = 0; i < ADT_SKIP_MAX_LEVEL; i++) {
+    list->head[i] = NULL;
+    ADT_pool_destroy(&list->pools[i]);
+  }
+  list->level = 1;
+  list->len = 0;
+}
+
+/*
+ * Fill preds with the link slot at each level which leads to the first
+ * node whose key is not less than key, and return that node.
+ */
+static struct ADT_skip_node *
+ADT_skip_search(struct ADT_skiplist *list, const void *key, struct ADT_skip_node ***preds)
+{
+  struct ADT_skip_node **link = list->head, *next = NULL;
+  int i;
+
+  for (i = (int)list->level - 1; i >= 0; i--) {
+    while ((next = link[i]) != NULL && (*list->cmp)(next->key, key, list->ctx) < 0)
+      link = next->next;
+    if (preds != NULL)
+      preds[i] = &link[i];
+  }
+  return next;
+}
+
+/*
+ * Map key to value. If an equal key is in list already its value is
+ * replaced; the key stored first is kept.
+ * Pre: list must be a pointer to an initialized ADT_skiplist structure.
+ * Returns: 0 if key was added, 1 if its value was replaced, or -1 on an
+ *          allocation error.
+ */
+int
+ADT_skiplist_insert(struct ADT_skiplist *list, void *key, void *value)
+{
+  struct ADT_skip_node **preds[ADT_SKIP_MAX_LEVEL], *node;
+  unsigned int level, i;
+
+  node = ADT_skip_search(list, key, preds);
+  if (node != NULL && (*list->cmp)(node->key, key, list->ctx) == 0) {
+    node->value = value;
+    return 1;
+  }
+  level = ADT_skip_random_level(&list->seed);
+  node = (struct ADT_skip_node *)ADT_pool_get(&list->pools[level - 1]);
+  if (node == NULL)
+    return -1;
+  for (i = list->level; i < level; i++)
+    preds[i] = &list->head[i];
+  if (level > list->level)
+    list->level = level;
+  node->key = key;
+  node->value = value;
+  node->level = level;
+  for (i = 0; i < level; i++) {
+    node->next[i] = *preds[i];
+    *preds[i] = node;
+  }
+  list->len++;
+  return 0;
+}
+
+/*
+ * Look key up in list.
+ * Pre: list must be a pointer to an initialized ADT_skiplist structure.
+ * Post: on success value, unless NULL, points to the value for key.
+ * Returns: 0 if key is in list or -1 if not.
+ */
+int
+ADT_skiplist_find(struct ADT_skiplist *list, const void *key, void **value)
+{
+  struct ADT_skip_node *node = ADT_skip_search(list, key, NULL);
+
+  if (node == NULL || (*list->cmp)(node->key, key, list->ctx) != 0)
+    return -1;
+  if (value != NULL)
+    *value = node->value;
+  return 0;
+}
+
+/*
+ * Remove key from list.
+ * Pre: list must be a pointer to an initialized ADT_skiplist structure.
+ * Post: on success stored_key and value, unless NULL, point to the key and
+ *       value that were in list.
+ * Returns: 0 if key was in list or -1 if not.
+ */
+int
+ADT_skiplist_remove(struct ADT_skiplist *list, const void *key, void **stored_key,
+                    void **value)
+{
+  struct ADT_skip_node **preds[ADT_SKIP_MAX_LEVEL], *node;
+  unsigned int i;
+
+  node = ADT_skip_search(list, key, preds);
+  if (node == NULL || (*list->cmp)(node->key, key, list->ctx) != 0)
+    return -1;
+  for (i = 0; i < node->level; i++)
+    *preds[i] = node->next[i];
+  while (list->level > 1 && list->head[list->level - 1] == NULL)
+    list->level--;
+  if (stored_key != NULL)
+    *stored_key = node->key;
+  if (value != NULL)
+    *value = node->value;
+  ADT_pool_put(&list->pools[node->level - 1], node);
+  list->len--;
+  return 0;
+}
+
+/*
+ * Return the number of entries in list.
+ * Pre: list must be a pointer to an initialized ADT_skiplist structure.
+ */
+unsigned int
+ADT_skiplist_length(struct ADT_skiplist *list)
+{
+  return list->len;
+}
+
+/*
+ * Start iter on the entries of list with keys in [lo, hi).
+ * Pre: list must be a pointer to an initialized ADT_skiplist structure,
+ *      which is not modified while iter is in use.
+ */
+void
+ADT_skiplist_range(struct ADT_skiplist *list, struct ADT_skip_iter *iter, const void *lo,
+                   const void *hi)
+{
+  iter->list = list;
+  iter->hi = hi;
+  iter->node = (lo == NULL) ? list->head[0] : ADT_skip_search(list, lo, NULL);
+}
+
+/*
+ * Step iter to the next entry of its range.
+ * Returns: 0 with key and value, unless NULL, set to the entry, or -1 at
+ *          the end of the range.
+ */
+int
+ADT_skip_iter_next(struct ADT_skip_iter *iter, void **key, void **value)
+{
+  struct ADT_skip_node *node = iter->node;
+  struct ADT_skiplist *list = iter->list;
+
+  if (node == NULL || (iter->hi != NULL && (*list->cmp)(node->key, iter->hi, list->ctx) >= 0))
+    return -1;
+  if (key != NULL)
+    *key = node->key;
+  if (value != NULL)
+    *value = node->value;
+  iter->node = node->next[0];
+  return 0;
+}
+
+/*******************************************************************************
+ * Concurrent skip list
+ */
+
+static struct ADT_cskip_node *
+ADT_cskip_node_alloc(struct ADT_cskiplist *list, unsigned int level)
+{
+  struct ADT_cskip_node *node;
+  unsigned int i;
+
+  node = (struct ADT_cskip_node *)ADT_alloc(list->alloc,
+                                            ADT_skip_node_size(struct ADT_cskip_node, level));
+  if (node == NULL)
+    return NULL;
+  node->level = level;
+  atomic_init(&node->dead, 0);
+  for (i = 0; i < level; i++)
+    atomic_init(&node->next[i], NULL);
+  return node;
+}
+
+/*
+ * Return a new initialized, empty Concurrent Skip List ordering keys with
+ * cmp(a, b, ctx).
+ * Pre: list is a pointer to a newly created ADT_cskiplist.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_cskiplist_init(struct ADT_cskiplist *list, int (*cmp)(const void *, const void *, void *),
+                   void *ctx)
+{
+  list->alloc = ADT_get_allocator();
+  list->head = ADT_cskip_node_alloc(list, ADT_SKIP_MAX_LEVEL);
+  if (list->head == NULL)
+    return -1;
+  list->head->key = NULL;
+  atomic_init(&list->head->value, NULL);
+  atomic_init(&list->level, 1);
+  atomic_init(&list->len, 0);
+  list->cmp = cmp;
+  list->ctx = ctx;
+  list->seed = (uint64_t)(uintptr_t)list | 1;
+  pthread_mutex_init(&list->lock, NULL);
+  return 0;
+}
+
+/*
+ * Release list, calling destroy_key and destroy_value on the key and value
+ * of every entry where they are not NULL.
+ * Pre: list must be a pointer to an initialized ADT_cskiplist structure
+ *      which no other thread is using any more.
+ */
+void
+ADT_cskiplist_destroy(struct ADT_cskiplist *list, void (*destroy_key)(void *),
+                      void (*destroy_value)(void *))
+{
+  struct ADT_cskip_node *node, *next;
+
+  for (node = atomic_load(&list->head->next[0]); node != NULL; node = next) {
+    next = atomic_load(&node->next[0]);
+    if (destroy_key != NULL)
+      (*destroy_key)(node->key);
+    if (destroy_value != NULL)
+      (*destroy_value)(atomic_load(&node->value));
+    ADT_free(list->alloc, node);
+  }
+  ADT_free(list->alloc, list->head);
+  list->head = NULL;
+  pthread_mutex_destroy(&list->lock);
+}
+
+/*
+ * Writer side search, under the lock: nothing is freed under the writer,
+ * so it can walk without hazard pointers. Fill preds with the last node
+ * before key at each level and return the first node not less than key.
+ */
+static struct ADT_cskip_node *
+ADT_cskip_search_locked(struct ADT_cskiplist *list, const void *key,
+                        struct ADT_cskip_node **preds)
+{
+  struct ADT_cskip_node *pred = list->head, *next = NULL;
+  int i;
+
+  for (i = ADT_SKIP_MAX_LEVEL - 1; i >= 0; i--) {
+    while ((next = atomic_load_explicit(&pred->next[i], memory_order_relaxed)) != NULL &&
+           (*list->cmp)(next->key, key, list->ctx) < 0)
+      pred = next;
+    preds[i] = pred;
+  }
+  return next;
+}
+
+/*
+ * Map key to value. If an equal key is in list already its value is
+ * replaced; the key stored first is kept. Readers see the new entry once
+ * it is linked at level 0, and the upper levels are linked after that.
+ * Pre: list must be a pointer to an initialized ADT_cskiplist structure.
+ * Returns: 0 if key was added, 1 if its value was replaced, or -1 on an
+ *          allocation error.
+ */
+int
+ADT_cskiplist_insert(struct ADT_cskiplist *list, void *key, void *value)
+{
+  struct ADT_cskip_node *preds[ADT_SKIP_MAX_LEVEL], *node;
+  unsigned int level, i;
+  int rc = 0;
+
+  pthread_mutex_lock(&list->lock);
+  node = ADT_cskip_search_locked(list, key, preds);
+  if (node != NULL && (*list->cmp)(node->key, key, list->ctx) == 0) {
+    atomic_store(&node->value, value);
+    rc = 1;
+    goto out;
+  }
+  level = ADT_skip_random_level(&list->seed);
+  node = ADT_cskip_node_alloc(list, level);
+  if (node == NULL) {
+    rc = -1;
+    goto out;
+  }
+  node->key = key;
+  atomic_init(&node->value, value);
+  for (i = 0; i < level; i++)
+    atomic_init(&node->next[i], atomic_load_explicit(&preds[i]->next[i], memory_order_relaxed));
+  for (i = 0; i < level; i++)
+    atomic_store_explicit(&preds[i]->next[i], node, memory_order_release);
+  if (level > atomic_load_explicit(&list->level, memory_order_relaxed))
+    atomic_store(&list->level, level);
+  atomic_fetch_add(&list->len, 1);
+out:
+  pthread_mutex_unlock(&list->lock);
+  return rc;
+}
+
+/*
+ * Remove key from list. The node is marked dead, unlinked from the top
+ * level down and retired, so readers still on it finish safely.
+ * Pre: list must be a pointer to an initialized ADT_cskiplist structure.
+ * Post: on success stored_key and value, unless NULL, point to the key and
+ *       value that were in list.
+ * Returns: 0 if key was in list or -1 if not, or with list unchanged if the
+ *          thread's hazard pointer record could not be allocated.
+ */
+int
+ADT_cskiplist_remove(struct ADT_cskiplist *list, const void *key, void **stored_key,
+                     void **value)
+{
+  struct ADT_hp_rec *rec = ADT_hp_get();
+  struct ADT_cskip_node *preds[ADT_SKIP_MAX_LEVEL], *node;
+  int i;
+
+  /* Before unlinking anything: the node needs the record to be retired. */
+  if (rec == NULL)
+    return -1;
+  pthread_mutex_lock(&list->lock);
+  node = ADT_cskip_search_locked(list, key, preds);
+  if (node == NULL || (*list->cmp)(node->key, key, list->ctx) != 0) {
+    pthread_mutex_unlock(&list->lock);
+    return -1;
+  }
+  atomic_store(&node->dead, 1);
+  for (i = (int)node->level - 1; i >= 0; i--)
+    atomic_store(&preds[i]->next[i], atomic_load_explicit(&node->next[i], memory_order_relaxed));
+  atomic_fetch_sub(&list->len, 1);
+  pthread_mutex_unlock(&list->lock);
+  if (stored_key != NULL)
+    *stored_key = node->key;
+  if (value != NULL)
+    *value = atomic_load(&node->value);
+  ADT_hp_retire(rec, node, list->alloc);
+  return 0;
+}
+
+/*
+ * Reader side search. Return the first node whose key is not less than key,
+ * or greater than key if after is set, protected by hazard slot *slot; the
+ * other slot is cleared.
+ *
+ * Each step protects the successor, then checks that the predecessor is
+ * still alive and still links to it. A live predecessor is linked at every
+ * one of its levels, so the successor is too and cannot have been retired;
+ * otherwise the search starts over from the head.
+ */
+static struct ADT_cskip_node *
+ADT_cskip_seek(struct ADT_cskiplist *list, const void *key, int after,
+               struct ADT_hp_rec *rec, int *slot)
+{
+  struct ADT_cskip_node *pred, *curr;
+  int i, c, pslot, cslot;
+
+retry:
+  pred = list->head;
+  pslot = 0;
+  cslot = 1;
+  curr = NULL;
+  for (i = (int)atomic_load(&list->level) - 1; i >= 0; i--) {
+    for (;;) {
+      curr = atomic_load(&pred->next[i]);
+      if (curr == NULL)
+        break;
+      atomic_store(&rec->hp[cslot], curr);
+      if (atomic_load(&pred->next[i]) != curr || atomic_load(&pred->dead))
+        goto retry;
+      if (key == NULL)
+        break;
+      c = (*list->cmp)(curr->key, key, list->ctx);
+      if (c > 0 || (c == 0 && !after))
+        break;
+      pred = curr;
+      pslot = cslot;
+      cslot = 1 - cslot;
+    }
+  }
+  ADT_hp_clear(rec, pslot);
+  if (curr == NULL)
+    ADT_hp_clear(rec, cslot);
+  *slot = cslot;
+  return curr;
+}
+
+/*
+ * Look key up in list without taking the writer lock.
+ * Pre: list must be a pointer to an initialized ADT_cskiplist structure.
+ * Post: on success value, unless NULL, points to the value for key.
+ * Returns: 0 if key is in list or -1 if not, or if the thread's hazard
+ *          pointer record could not be allocated.
+ */
+int
+ADT_cskiplist_find(struct ADT_cskiplist *list, const void *key, void **value)
+{
+  struct ADT_hp_rec *rec = ADT_hp_get();
+  struct ADT_cskip_node *node;
+  int slot, rc = -1;
+
+  if (rec == NULL)
+    return -1;
+
+  node = ADT_cskip_seek(list, key, 0, rec, &slot);
+  if (node != NULL && (*list->cmp)(node->key, key, list->ctx) == 0) {
+    if (value != NULL)
+      *value = atomic_load(&node->value);
+    rc = 0;
+  }
+  ADT_hp_clear(rec, slot);
+  return rc;
+}
+
+/*
+ * Return the number of entries in list at the time of the call.
+ * Pre: list must be a pointer to an initialized ADT_cskiplist structure.
+ */
+unsigned int
+ADT_cskiplist_length(struct ADT_cskiplist *list)
+{
+  return atomic_load(&list->len);
+}
+
+/*
+ * Start iter on the entries of list with keys in [lo, hi), without taking
+ * the writer lock. Entries inserted or removed during the iteration may or
+ * may not be seen, but keys come out in increasing order.
+ * Pre: list must be a pointer to an initialized ADT_cskiplist structure.
+ * Returns: 0 on success or -1 if the thread's hazard pointer record could
+ *          not be allocated; iter is then at the end of an empty range.
+ */
+int
+ADT_cskiplist_range(struct ADT_cskiplist *list, struct ADT_cskip_iter *iter, const void *lo,
+                    const void *hi)
+{
+  iter->list = list;
+  iter->hi = hi;
+  iter->rec = ADT_hp_get();
+  iter->node = NULL;
+  if (iter->rec == NULL)
+    return -1;
+  iter->node = ADT_cskip_seek(list, lo, 0, iter->rec, &iter->slot);
+  return 0;
+}
+
+/*
+ * Step iter to the next entry of its range.
+ * Returns: 0 with key and value, unless NULL, set to the entry, or -1 at
+ *          the end of the range, when iter has released its hazard slots.
+ */
+int
+ADT_cskip_iter_next(struct ADT_cskip_iter *iter, void **key, void **value)
+{
+  struct ADT_cskiplist *list = iter->list;
+  struct ADT_cskip_node *node = iter->node, *next;
+  int nslot = 1 - iter->slot;
+  const void *last;
+
+  if (node == NULL)
+    return -1;
+  if (iter->hi != NULL && (*list->cmp)(node->key, iter->hi, list->ctx) >= 0) {
+    ADT_cskip_iter_end(iter);
+    return -1;
+  }
+  if (key != NULL)
+    *key = node->key;
+  if (value != NULL)
+    *value = atomic_load(&node->value);
+  next = atomic_load(&node->next[0]);
+  if (next != NULL)
+    atomic_store(&iter->rec->hp[nslot], next);
+  if (atomic_load(&node->next[0]) == next && !atomic_load(&node->dead)) {
+    ADT_hp_clear(iter->rec, iter->slot);
+    iter->slot = nslot;
+    iter->node = next;
+  } else {
+    /* node went away under us: find where its key was. */
+    last = node->key;
+    ADT_hp_clear(iter->rec, nslot);
+    iter->node = ADT_cskip_seek(list, last, 1, iter->rec, &iter->slot);
+  }
+  return 0;
+}
+
+/*
+ * Release the hazard slots held by iter before reaching its end.
+ */
+void
+ADT_cskip_iter_end(struct ADT_cskip_iter *iter)
+{
+  if (iter->node != NULL) {
+    ADT_hp_clear(iter->rec, 0);
+    ADT_hp_clear(iter->rec, 1);
+    iter->node = NULL;
+  }
+}
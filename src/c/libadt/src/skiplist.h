@@ -0,0 +1,121 @@
+#ifndef _ADT_SKIPLIST_H
+#define _ADT_SKIPLIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "alloc.h"
+#include "pool.h"
+#include "hazard.h"
+
+/*******************************************************************************
+ * Skip list
+ *
+ * An ordered map with expected O(log n) insert, find and remove. Level 0
+ * links every node in key order like an ADT_sl_list, and each level above
+ * links about a quarter of the nodes of the one below. Nodes are sized to
+ * their level and come from one pool per level, owned by the list.
+ *
+ * Keys are ordered by cmp(a, b, ctx) as for ADT_sl_list_sort and are not
+ * copied. A range is iterated from the first key not less than lo to the
+ * last key less than hi, where a NULL lo or hi leaves that end open.
+ */
+
+#define ADT_SKIP_MAX_LEVEL 16
+
+struct ADT_skip_node {
+  void *key;
+  void *value;
+  unsigned int level;
+  struct ADT_skip_node *next[];         /* level entries */
+};
+
+struct ADT_skiplist {
+  struct ADT_skip_node *head[ADT_SKIP_MAX_LEVEL];
+  unsigned int level;                   /* levels in use */
+  unsigned int len;
+  int (*cmp)(const void *, const void *, void *);
+  void *ctx;
+  uint64_t seed;
+  struct ADT_pool pools[ADT_SKIP_MAX_LEVEL];  /* pools[i] has nodes of level i + 1 */
+};
+
+struct ADT_skip_iter {
+  struct ADT_skiplist *list;
+  struct ADT_skip_node *node;
+  const void *hi;
+};
+
+void ADT_skiplist_init(struct ADT_skiplist *, int (*cmp)(const void *, const void *, void *),
+                       void *);
+void ADT_skiplist_destroy(struct ADT_skiplist *, void (*destroy_key)(void *),
+                          void (*destroy_value)(void *));
+int ADT_skiplist_insert(struct ADT_skiplist *, void *, void *);
+int ADT_skiplist_find(struct ADT_skiplist *, const void *, void **);
+int ADT_skiplist_remove(struct ADT_skiplist *, const void *, void **, void **);
+unsigned int ADT_skiplist_length(struct ADT_skiplist *);
+void ADT_skiplist_range(struct ADT_skiplist *, struct ADT_skip_iter *, const void *,
+                        const void *);
+int ADT_skip_iter_next(struct ADT_skip_iter *, void **, void **);
+
+/*******************************************************************************
+ * Concurrent skip list
+ *
+ * Writers serialize on an internal mutex while readers never lock: find and
+ * range iteration walk the list under hazard pointers, so a removed node is
+ * only freed once no reader holds it. A writer marks a node dead before
+ * unlinking it, from the top level down, and a reader that finds its
+ * predecessor dead or relinked starts its step over.
+ *
+ * A reader uses the calling thread's hazard slots, so a thread walks one
+ * ADT_cskiplist (or other hazard pointer structure) at a time, and an open
+ * iterator holds them until it reaches its end or ADT_cskip_iter_end. Keys
+ * and values handed back by remove may still be read by readers; retire
+ * them rather than freeing them at once if readers can be running. Nodes
+ * come from the library-wide allocator, which must allow any thread to
+ * free.
+ */
+
+struct ADT_cskip_node {
+  void *key;
+  void *_Atomic value;
+  unsigned int level;
+  atomic_int dead;
+  struct ADT_cskip_node *_Atomic next[];
+};
+
+struct ADT_cskiplist {
+  struct ADT_cskip_node *head;          /* level ADT_SKIP_MAX_LEVEL sentinel */
+  atomic_uint level;
+  atomic_uint len;
+  int (*cmp)(const void *, const void *, void *);
+  void *ctx;
+  uint64_t seed;
+  pthread_mutex_t lock;                 /* writers */
+  const struct ADT_allocator *alloc;
+};
+
+struct ADT_cskip_iter {
+  struct ADT_cskiplist *list;
+  struct ADT_cskip_node *node;          /* protected by slot */
+  const void *hi;
+  struct ADT_hp_rec *rec;
+  int slot;
+};
+
+int ADT_cskiplist_init(struct ADT_cskiplist *, int (*cmp)(const void *, const void *, void *),
+                       void *);
+void ADT_cskiplist_destroy(struct ADT_cskiplist *, void (*destroy_key)(void *),
+                           void (*destroy_value)(void *));
+int ADT_cskiplist_insert(struct ADT_cskiplist *, void *, void *);
+int ADT_cskiplist_find(struct ADT_cskiplist *, const void *, void **);
+int ADT_cskiplist_remove(struct ADT_cskiplist *, const void *, void **, void **);
+unsigned int ADT_cskiplist_length(struct ADT_cskiplist *);
+int ADT_cskiplist_range(struct ADT_cskiplist *, struct ADT_cskip_iter *, const void *,
+                        const void *);
+int ADT_cskip_iter_next(struct ADT_cskip_iter *, void **, void **);
+void ADT_cskip_iter_end(struct ADT_cskip_iter *);
+
+
+#endif
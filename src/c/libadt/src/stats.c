@@ -0,0 +1,45 @@
+#include "stats.h"
+
+struct ADT_stats_counters ADT_stats_counters;
+
+/*
+ * Copy the current list counters to stats. Counters are read one at a time
+ * while other threads may be updating them, so the copy is not an atomic
+ * snapshot of all of them together. Without ADT_STATS they stay zero.
+ */
+void
+ADT_stats_snapshot(struct ADT_stats *stats)
+{
+  int i, j;
+
+  stats->nodes_allocated = atomic_load_explicit(&ADT_stats_counters.nodes_allocated,
+                                                memory_order_relaxed);
+  stats->nodes_freed = atomic_load_explicit(&ADT_stats_counters.nodes_freed,
+                                            memory_order_relaxed);
+  stats->peak_length = atomic_load_explicit(&ADT_stats_counters.peak_length,
+                                            memory_order_relaxed);
+  for (i = 0; i < ADT_STATS_NOPS; i++) {
+    stats->calls[i] = atomic_load_explicit(&ADT_stats_counters.calls[i], memory_order_relaxed);
+    for (j = 0; j < ADT_STATS_BUCKETS; j++)
+      stats->latency[i][j] = atomic_load_explicit(&ADT_stats_counters.latency[i][j],
+                                                  memory_order_relaxed);
+  }
+}
+
+/*
+ * Zero every list counter, e.g. at the start of a measurement interval.
+ */
+void
+ADT_stats_reset(void)
+{
+  int i, j;
+
+  atomic_store_explicit(&ADT_stats_counters.nodes_allocated, 0, memory_order_relaxed);
+  atomic_store_explicit(&ADT_stats_counters.nodes_freed, 0, memory_order_relaxed);
+  atomic_store_explicit(&ADT_stats_counters.peak_length, 0, memory_order_relaxed);
+  for (i = 0; i < ADT_STATS_NOPS; i++) {
+    atomic_store_explicit(&ADT_stats_counters.calls[i], 0, memory_order_relaxed);
+    for (j = 0; j < ADT_STATS_BUCKETS; j++)
+      atomic_store_explicit(&ADT_stats_counters.latency[i][j], 0, memory_order_relaxed);
+  }
+}
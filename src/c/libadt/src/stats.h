@@ -0,0 +1,130 @@
+#ifndef _ADT_STATS_H
+#define _ADT_STATS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#else
+  #include <time.h>
+#endif
+
+/*******************************************************************************
+ * Single linked list statistics
+ *
+ * Building with ADT_STATS defined (make STATS=1) makes the list count node
+ * allocations and frees, every push/pop/append/insert_after/remove_after
+ * call and the longest list seen, in process-wide relaxed atomic counters.
+ * Also defining ADT_STATS_TIMING (make STATS=timing) adds a latency
+ * histogram per operation: bucket i counts calls that took from 2^(i-1) up
+ * to 2^i cycles of the time stamp counter, or nanoseconds where there is
+ * none. Otherwise the hooks compile to nothing.
+ *
+ * ADT_stats_snapshot reads the counters at any time; with ADT_INLINE the
+ * hot paths count as the including file is built.
+ */
+
+enum ADT_stats_op {
+  ADT_STATS_PUSH,
+  ADT_STATS_POP,
+  ADT_STATS_APPEND,
+  ADT_STATS_INSERT,
+  ADT_STATS_REMOVE,
+  ADT_STATS_NOPS
+};
+
+#define ADT_STATS_BUCKETS 32
+
+struct ADT_stats {
+  unsigned long long nodes_allocated;
+  unsigned long long nodes_freed;
+  unsigned long long peak_length;
+  unsigned long long calls[ADT_STATS_NOPS];
+  unsigned long long latency[ADT_STATS_NOPS][ADT_STATS_BUCKETS];
+};
+
+struct ADT_stats_counters {
+  atomic_ullong nodes_allocated;
+  atomic_ullong nodes_freed;
+  atomic_ullong peak_length;
+  atomic_ullong calls[ADT_STATS_NOPS];
+  atomic_ullong latency[ADT_STATS_NOPS][ADT_STATS_BUCKETS];
+};
+
+extern struct ADT_stats_counters ADT_stats_counters;
+
+void ADT_stats_snapshot(struct ADT_stats *);
+void ADT_stats_reset(void);
+
+#ifdef ADT_STATS
+
+static inline uint64_t
+ADT_stats_clock(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static inline void
+ADT_stats_length(unsigned long long len)
+{
+  unsigned long long peak = atomic_load_explicit(&ADT_stats_counters.peak_length,
+                                                 memory_order_relaxed);
+
+  while (len > peak &&
+         !atomic_compare_exchange_weak_explicit(&ADT_stats_counters.peak_length, &peak, len,
+                                                memory_order_relaxed, memory_order_relaxed))
+    ;
+}
+
+static inline uint64_t
+ADT_stats_begin(enum ADT_stats_op op)
+{
+  atomic_fetch_add_explicit(&ADT_stats_counters.calls[op], 1, memory_order_relaxed);
+#ifdef ADT_STATS_TIMING
+  return ADT_stats_clock();
+#else
+  return 0;
+#endif
+}
+
+static inline void
+ADT_stats_end(enum ADT_stats_op op, uint64_t start)
+{
+#ifdef ADT_STATS_TIMING
+  uint64_t elapsed = ADT_stats_clock() - start;
+  unsigned int bucket = (elapsed == 0) ? 0 : 64 - __builtin_clzll(elapsed);
+
+  if (bucket >= ADT_STATS_BUCKETS)
+    bucket = ADT_STATS_BUCKETS - 1;
+  atomic_fetch_add_explicit(&ADT_stats_counters.latency[op][bucket], 1, memory_order_relaxed);
+#else
+  (void)op;
+  (void)start;
+#endif
+}
+
+#define ADT_STATS_ADD(field, n) \
+  atomic_fetch_add_explicit(&ADT_stats_counters.field, (n), memory_order_relaxed)
+#define ADT_STATS_LENGTH(len) ADT_stats_length(len)
+/* BEGIN declares the start time, so it goes after a block's declarations. */
+#define ADT_STATS_BEGIN(op) uint64_t ADT_stats_start = ADT_stats_begin(op)
+#define ADT_STATS_END(op) ADT_stats_end(op, ADT_stats_start)
+
+#else
+
+#define ADT_STATS_ADD(field, n) ((void)0)
+#define ADT_STATS_LENGTH(len) ((void)0)
+#define ADT_STATS_BEGIN(op) ((void)0)
+#define ADT_STATS_END(op) ((void)0)
+
+#endif
+
+
+#endif
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "alloc.h"
+#include "list.h"
+
+/* A bump arena with no free: everything is dropped at once. */
+struct arena {
+  char buf[4096];
+  size_t used;
+  int allocs;
+};
+
+static void *arena_alloc(void *ctx, size_t size)
+{
+  struct arena *a = (struct arena *)ctx;
+  void *ptr;
+
+  size = (size + 15) & ~(size_t)15;
+  if (a->used + size > sizeof(a->buf))
+    return NULL;
+  ptr = a->buf + a->used;
+  a->used += size;
+  a->allocs++;
+  return ptr;
+}
+
+static int frees;
+
+static void *counting_alloc(void *ctx, size_t size)
+{
+  (*(int *)ctx)++;
+  return malloc(size);
+}
+
+static void counting_free(void *ctx, void *ptr)
+{
+  frees++;
+  free(ptr);
+}
+
+void test__ADT_set_allocator()
+{
+  int allocs = 0;
+  struct ADT_allocator counting = { &counting_alloc, &counting_free, &allocs };
+  struct ADT_sl_list list;
+  char *tmp;
+
+  assert(ADT_get_allocator() == &ADT_malloc_allocator);
+  ADT_set_allocator(&counting);
+  ADT_sl_list_init(&list);
+  ADT_set_allocator(NULL);
+  assert(ADT_get_allocator() == &ADT_malloc_allocator);
+  /* The list keeps the allocator it was initialized with. */
+  ADT_sl_list_push(&list, "a");
+  ADT_sl_list_push(&list, "b");
+  assert(allocs == 2);
+  ADT_sl_list_pop(&list, (void *)&tmp);
+  assert(frees == 1);
+  ADT_sl_list_destroy(&list, NULL);
+  assert(frees == 2);
+  printf("Test Allocator Set (ADT_set_allocator)...ok\n");
+}
+
+void test__ADT_sl_list_init_alloc()
+{
+  struct arena a = { {0}, 0, 0 };
+  struct ADT_allocator arena = { &arena_alloc, NULL, &a };
+  struct ADT_sl_list list;
+  int i;
+
+  ADT_sl_list_init_alloc(&list, &arena);
+  for (i = 0; i < 100; i++)
+    assert(ADT_sl_list_append(&list, &a) == 0);
+  assert(a.allocs == 100);
+  /* Nodes belong to the arena, so destroy does not walk the list. */
+  ADT_sl_list_destroy(&list, NULL);
+  assert(ADT_sl_list_length(&list) == 0 && list.head == NULL);
+  printf("Test Single Linked List Allocator (ADT_sl_list_init_alloc)...ok\n");
+}
+
+int main()
+{
+  test__ADT_set_allocator();
+  test__ADT_sl_list_init_alloc();
+  return 0;
+}
@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include <errno.h>
+#include <poll.h>
+#include "cqueue.h"
+#include "hazard.h"
+#include "list.h"
+
+#define THREADS 4
+#define ITEMS 20000
+
+struct item {
+  long value;
+  struct ADT_mpsc_link link;
+  struct ADT_bq_link bq_link;
+};
+
+static struct ADT_ms_queue ms;
+static struct ADT_mpsc_queue mpsc;
+static struct ADT_bqueue bq;
+static atomic_long consumed_sum;
+static atomic_long consumed_count;
+
+static void *ms_producer(void *arg)
+{
+  long base = (long)arg * ITEMS, i;
+
+  for (i = 1; i <= ITEMS; i++)
+    assert(ADT_ms_queue_enqueue(&ms, (void *)(base + i)) == 0);
+  return NULL;
+}
+
+static void *ms_consumer(void *arg)
+{
+  void *data;
+
+  while (atomic_load(&consumed_count) < THREADS * ITEMS) {
+    if (ADT_ms_queue_dequeue(&ms, &data) == 0) {
+      atomic_fetch_add(&consumed_sum, (long)data);
+      atomic_fetch_add(&consumed_count, 1);
+    }
+  }
+  return NULL;
+}
+
+static void *mpsc_producer(void *arg)
+{
+  struct item *items = (struct item *)arg;
+  int i;
+
+  for (i = 0; i < ITEMS; i++)
+    ADT_mpsc_queue_enqueue(&mpsc, &items[i].link);
+  return NULL;
+}
+
+void test__ADT_ms_queue()
+{
+  pthread_t producers[THREADS], consumers[THREADS];
+  void *data;
+  long n = THREADS * ITEMS;
+  int i;
+
+  assert(ADT_ms_queue_init(&ms) == 0);
+  assert(ADT_ms_queue_dequeue(&ms, &data) == -1);
+  ADT_ms_queue_enqueue(&ms, (void *)1L);
+  ADT_ms_queue_enqueue(&ms, (void *)2L);
+  assert(ADT_ms_queue_dequeue(&ms, &data) == 0 && data == (void *)1L);
+  assert(ADT_ms_queue_dequeue(&ms, &data) == 0 && data == (void *)2L);
+
+  for (i = 0; i < THREADS; i++) {
+    pthread_create(&producers[i], NULL, &ms_producer, (void *)(long)i);
+    pthread_create(&consumers[i], NULL, &ms_consumer, NULL);
+  }
+  for (i = 0; i < THREADS; i++) {
+    pthread_join(producers[i], NULL);
+    pthread_join(consumers[i], NULL);
+  }
+  assert(atomic_load(&consumed_sum) == n * (n + 1) / 2);
+  assert(ADT_ms_queue_dequeue(&ms, &data) == -1);
+  ADT_hp_drain();
+  ADT_ms_queue_destroy(&ms, NULL);
+  printf("Test MPMC Queue (ADT_ms_queue_*)...ok\n");
+}
+
+void test__ADT_mpsc_queue()
+{
+  pthread_t producers[THREADS];
+  struct item *items = (struct item *)malloc(THREADS * ITEMS * sizeof(struct item));
+  struct ADT_mpsc_link *link;
+  long last[THREADS], sum = 0, n = THREADS * ITEMS;
+  long got = 0;
+  int i;
+
+  assert(items != NULL);
+  ADT_mpsc_queue_init(&mpsc);
+  assert(ADT_mpsc_queue_dequeue(&mpsc, &link) == -1);
+  for (i = 0; i < n; i++)
+    items[i].value = i;
+  for (i = 0; i < THREADS; i++) {
+    last[i] = -1;
+    pthread_create(&producers[i], NULL, &mpsc_producer, &items[i * ITEMS]);
+  }
+  while (got < n) {
+    if (ADT_mpsc_queue_dequeue(&mpsc, &link) != 0)
+      continue;
+    i = ADT_container_of(link, struct item, link)->value;
+    /* Each producer's items come out in the order it enqueued them. */
+    assert(i > last[i / ITEMS]);
+    last[i / ITEMS] = i;
+    sum += i;
+    got++;
+  }
+  for (i = 0; i < THREADS; i++)
+    pthread_join(producers[i], NULL);
+  assert(sum == n * (n - 1) / 2);
+  assert(ADT_mpsc_queue_dequeue(&mpsc, &link) == -1);
+  free(items);
+  printf("Test MPSC Queue (ADT_mpsc_queue_*)...ok\n");
+}
+
+static void *bq_producer(void *arg)
+{
+  struct item *items = (struct item *)arg;
+  int i;
+
+  for (i = 0; i < ITEMS; i++)
+    ADT_bqueue_enqueue(&bq, &items[i].bq_link);
+  return NULL;
+}
+
+void test__ADT_bqueue()
+{
+  pthread_t producers[THREADS];
+  struct item *items = (struct item *)malloc(THREADS * ITEMS * sizeof(struct item));
+  struct ADT_bq_link *link, *chain;
+  long last[THREADS], sum = 0, n = THREADS * ITEMS;
+  long got = 0;
+  int i;
+
+  assert(items != NULL);
+  assert(ADT_bqueue_init(&bq, 0) == 0);
+  assert(ADT_bqueue_dequeue(&bq, &link) == -1 && ADT_bqueue_dequeue_all(&bq) == NULL);
+  assert(ADT_bqueue_wait(&bq, 0) == -1 && errno == ETIMEDOUT);
+  assert(ADT_bqueue_wait(&bq, 10) == -1 && errno == ETIMEDOUT);
+  for (i = 0; i < 4; i++) {
+    items[i].value = i;
+    ADT_bqueue_enqueue(&bq, &items[i].bq_link);
+  }
+  assert(ADT_bqueue_wait(&bq, -1) == 0);
+  assert(ADT_bqueue_dequeue(&bq, &link) == 0 && link == &items[0].bq_link);
+  ADT_bqueue_enqueue(&bq, &items[4].bq_link);
+  /* The rest of the taken batch comes first, then what was pending. */
+  chain = ADT_bqueue_dequeue_all(&bq);
+  for (i = 1; i <= 4; i++, chain = chain->next)
+    assert(chain == &items[i].bq_link);
+  assert(chain == NULL);
+
+  for (i = 0; i < n; i++)
+    items[i].value = i;
+  for (i = 0; i < THREADS; i++) {
+    last[i] = -1;
+    pthread_create(&producers[i], NULL, &bq_producer, &items[i * ITEMS]);
+  }
+  while (got < n) {
+    assert(ADT_bqueue_wait(&bq, -1) == 0);
+    for (chain = ADT_bqueue_dequeue_all(&bq); chain != NULL; chain = chain->next) {
+      i = ADT_container_of(chain, struct item, bq_link)->value;
+      /* Each producer's items come out in the order it enqueued them. */
+      assert(i > last[i / ITEMS]);
+      last[i / ITEMS] = i;
+      sum += i;
+      got++;
+    }
+  }
+  for (i = 0; i < THREADS; i++)
+    pthread_join(producers[i], NULL);
+  assert(sum == n * (n - 1) / 2);
+  ADT_bqueue_destroy(&bq);
+  free(items);
+  printf("Test Blocking Queue (ADT_bqueue_*)...ok\n");
+}
+
+void test__ADT_bqueue_eventfd()
+{
+#ifdef __linux__
+  struct item items[2];
+  struct pollfd pfd;
+
+  assert(ADT_bqueue_init(&bq, ADT_BQ_EVENTFD) == 0);
+  pfd.fd = ADT_bqueue_eventfd(&bq);
+  pfd.events = POLLIN;
+  assert(pfd.fd >= 0 && poll(&pfd, 1, 0) == 0);
+  ADT_bqueue_enqueue(&bq, &items[0].bq_link);
+  ADT_bqueue_enqueue(&bq, &items[1].bq_link);
+  assert(poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN));
+  ADT_bqueue_eventfd_ack(&bq);
+  assert(poll(&pfd, 1, 0) == 0);
+  assert(ADT_bqueue_dequeue_all(&bq) == &items[0].bq_link);
+  ADT_bqueue_destroy(&bq);
+  printf("Test Blocking Queue Eventfd (ADT_bqueue_eventfd)...ok\n");
+#endif
+}
+
+int main()
+{
+  test__ADT_ms_queue();
+  test__ADT_mpsc_queue();
+  test__ADT_bqueue();
+  test__ADT_bqueue_eventfd();
+  return 0;
+}
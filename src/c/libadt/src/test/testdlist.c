@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "dlist.h"
+
+/* Check both directions of list against the len data of want. */
+static void check_order(struct ADT_dl_list *list, void **want, unsigned int len)
+{
+  struct ADT_dl_node *node;
+  unsigned int i = 0;
+
+  assert(ADT_dl_list_length(list) == len);
+  ADT_dl_list_foreach(list, node)
+    assert(node->data == want[i++]);
+  assert(i == len);
+  ADT_dl_list_foreach_reverse(list, node)
+    assert(node->data == want[--i]);
+  assert(list->head == NULL || list->head->prev == NULL);
+  assert(list->tail == NULL || list->tail->next == NULL);
+}
+
+void test__ADT_dl_list_push_append_pop()
+{
+  struct ADT_dl_list list;
+  void *items[4] = { "a", "b", "c", "d" };
+  void *data;
+
+  ADT_dl_list_init(&list);
+  assert(ADT_dl_list_append(&list, items[1]) == 0);
+  assert(ADT_dl_list_push(&list, items[0]) == 0);
+  assert(ADT_dl_list_append(&list, items[2]) == 0);
+  assert(ADT_dl_list_insert_after(&list, list.tail, items[3]) == 0);
+  check_order(&list, items, 4);
+  ADT_dl_list_pop(&list, &data);
+  assert(data == items[0]);
+  ADT_dl_list_pop_tail(&list, &data);
+  assert(data == items[3]);
+  check_order(&list, items + 1, 2);
+  ADT_dl_list_pop(&list, &data);
+  ADT_dl_list_pop_tail(&list, &data);
+  assert(data == items[2]);
+  check_order(&list, NULL, 0);
+  printf("Test Double Linked List Push/Append/Pop (ADT_dl_list_pop_tail)...ok\n");
+  ADT_dl_list_destroy(&list, NULL);
+}
+
+void test__ADT_dl_list_remove()
+{
+  struct ADT_dl_list list;
+  struct ADT_pool pool;
+  void *items[5] = { "a", "b", "c", "d", "e" };
+  void *want[5];
+  void *data;
+  int i;
+
+  assert(ADT_dl_pool_init(&pool, 4) == 0);
+  ADT_dl_list_init_pooled(&list, &pool);
+  for (i = 0; i < 5; i++)
+    ADT_dl_list_append(&list, items[i]);
+  /* Middle, head and tail. */
+  ADT_dl_list_remove(&list, list.head->next->next, &data);
+  assert(data == items[2]);
+  ADT_dl_list_remove(&list, list.head, NULL);
+  ADT_dl_list_remove(&list, list.tail, &data);
+  assert(data == items[4]);
+  want[0] = items[1];
+  want[1] = items[3];
+  check_order(&list, want, 2);
+  assert(ADT_dl_list_insert_before(&list, list.head, items[0]) == 0);
+  assert(ADT_dl_list_insert_before(&list, list.tail, items[2]) == 0);
+  want[0] = items[0];
+  want[1] = items[1];
+  want[2] = items[2];
+  want[3] = items[3];
+  check_order(&list, want, 4);
+  printf("Test Double Linked List Remove (ADT_dl_list_remove)...ok\n");
+  ADT_dl_list_destroy(&list, NULL);
+  ADT_pool_destroy(&pool);
+}
+
+void test__ADT_dl_list_move()
+{
+  struct ADT_dl_list list;
+  void *items[3] = { "a", "b", "c" };
+  void *want[3];
+
+  ADT_dl_list_init(&list);
+  ADT_dl_list_append(&list, items[0]);
+  ADT_dl_list_append(&list, items[1]);
+  ADT_dl_list_append(&list, items[2]);
+  ADT_dl_list_move_to_front(&list, list.tail);
+  want[0] = items[2];
+  want[1] = items[0];
+  want[2] = items[1];
+  check_order(&list, want, 3);
+  ADT_dl_list_move_to_front(&list, list.head);
+  check_order(&list, want, 3);
+  ADT_dl_list_move_to_back(&list, list.head->next);
+  want[1] = items[1];
+  want[2] = items[0];
+  check_order(&list, want, 3);
+  printf("Test Double Linked List Move (ADT_dl_list_move_to_front)...ok\n");
+  ADT_dl_list_destroy(&list, NULL);
+}
+
+struct timer {
+  int expires;
+  struct ADT_dl_link link;
+};
+
+void test__ADT_dl_ilist()
+{
+  struct ADT_dl_ilist list;
+  struct ADT_dl_link *link;
+  struct timer timers[4];
+  int i, expect[3] = { 3, 0, 2 };
+
+  ADT_dl_ilist_init(&list);
+  for (i = 0; i < 4; i++) {
+    timers[i].expires = i;
+    ADT_dl_ilist_append(&list, &timers[i].link);
+  }
+  ADT_dl_ilist_remove(&list, &timers[1].link);
+  assert(timers[1].link.next == NULL && timers[1].link.prev == NULL);
+  ADT_dl_ilist_move_to_front(&list, &timers[3].link);
+  assert(ADT_dl_ilist_length(&list) == 3);
+  i = 0;
+  ADT_dl_ilist_foreach(&list, link)
+    assert(ADT_dl_ilist_entry(link, struct timer, link)->expires == expect[i++]);
+  ADT_dl_ilist_foreach_reverse(&list, link)
+    assert(ADT_dl_ilist_entry(link, struct timer, link)->expires == expect[--i]);
+  ADT_dl_ilist_move_to_back(&list, &timers[3].link);
+  ADT_dl_ilist_insert_after(&list, &timers[0].link, &timers[1].link);
+  ADT_dl_ilist_pop_tail(&list, &link);
+  assert(link == &timers[3].link && list.tail == &timers[2].link);
+  ADT_dl_ilist_pop(&list, &link);
+  assert(link == &timers[0].link && list.head == &timers[1].link);
+  ADT_dl_ilist_insert_before(&list, &timers[1].link, &timers[0].link);
+  assert(list.head == &timers[0].link && timers[1].link.prev == &timers[0].link);
+  assert(ADT_dl_ilist_length(&list) == 3);
+  printf("Test Intrusive Double Linked List (ADT_dl_ilist_*)...ok\n");
+}
+
+int main()
+{
+  test__ADT_dl_list_push_append_pop();
+  test__ADT_dl_list_remove();
+  test__ADT_dl_list_move();
+  test__ADT_dl_ilist();
+  return 0;
+}
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "list.h"
+#include "dlist.h"
+
+static struct ADT_sl_list list;
+static struct ADT_dl_list dlist;
+static struct ADT_dl_ilist ilist;
+
+static void quiet(const char *what, const char *file, int line)
+{
+}
+
+/* Not assert: this test matters most in NDEBUG builds. */
+static void expect(int ok, const char *what)
+{
+  if (!ok) {
+    fprintf(stderr, "testharden: %s\n", what);
+    abort();
+  }
+}
+
+/* Run misuse in a child and report whether the child aborted. */
+static int __attribute__((unused)) aborts(void (*misuse)(void))
+{
+  pid_t pid;
+  int status;
+
+  fflush(stdout);
+  pid = fork();
+  expect(pid >= 0, "fork");
+  if (pid == 0) {
+    ADT_set_harden_handler(&quiet);
+    close(STDERR_FILENO);
+    (*misuse)();
+    _exit(0);
+  }
+  expect(waitpid(pid, &status, 0) == pid, "waitpid");
+  return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+
+#if ADT_HARDEN > 0 || !defined(NDEBUG)
+static void pop_empty(void)
+{
+  void *data;
+
+  ADT_sl_list_pop(&list, &data);
+}
+
+static void remove_after_tail(void)
+{
+  void *data;
+
+  ADT_sl_list_remove_after(&list, list.tail, &data);
+}
+
+static void dl_pop_empty(void)
+{
+  void *data;
+
+  ADT_dl_list_pop(&dlist, &data);
+}
+
+static void ilist_double_remove(void)
+{
+  struct ADT_dl_link a, b;
+
+  ADT_dl_ilist_append(&ilist, &a);
+  ADT_dl_ilist_append(&ilist, &b);
+  ADT_dl_ilist_remove(&ilist, &b);
+  ADT_dl_ilist_remove(&ilist, &b);
+}
+
+#endif
+
+#if ADT_HARDEN > 1
+static struct ADT_sl_node *stale;
+static struct ADT_dl_node *dstale;
+
+static void insert_after_popped(void)
+{
+  ADT_sl_list_insert_after(&list, stale, "x");
+}
+
+static void dl_double_remove(void)
+{
+  void *data;
+
+  ADT_dl_list_remove(&dlist, dstale, &data);
+}
+
+static void smash_node(void)
+{
+  void *data;
+
+  ADT_sl_list_append(&list, "b");
+  /* A stray write running over the head node. */
+  *(uintptr_t *)((char *)list.head + sizeof(struct ADT_sl_node) - sizeof(uintptr_t)) = 0;
+  ADT_sl_list_pop(&list, &data);
+}
+#endif
+
+void test__ADT_check()
+{
+#if ADT_HARDEN > 0 || !defined(NDEBUG)
+  ADT_sl_list_init(&list);
+  ADT_dl_list_init(&dlist);
+  ADT_dl_ilist_init(&ilist);
+  expect(aborts(&pop_empty), "pop_empty aborts");
+  expect(aborts(&dl_pop_empty), "dl_pop_empty aborts");
+  expect(aborts(&ilist_double_remove), "ilist_double_remove aborts");
+  ADT_sl_list_append(&list, "a");
+  expect(aborts(&remove_after_tail), "remove_after_tail aborts");
+  ADT_sl_list_destroy(&list, NULL);
+  printf("Test Hardened Checks (ADT_check)...ok\n");
+#endif
+}
+
+void test__ADT_canary()
+{
+#if ADT_HARDEN > 1
+  struct ADT_pool pool;
+  void *data;
+
+  /* Pooled nodes are reused at once, the likeliest way to miss a stale one. */
+  expect(ADT_sl_pool_init(&pool, 16) == 0, "ADT_sl_pool_init");
+  ADT_sl_list_init_pooled(&list, &pool);
+  ADT_sl_list_append(&list, "a");
+  stale = list.head;
+  ADT_sl_list_pop(&list, &data);
+  expect(aborts(&insert_after_popped), "insert_after_popped aborts");
+  expect(aborts(&smash_node), "smash_node aborts");
+  ADT_sl_list_destroy(&list, NULL);
+  ADT_pool_destroy(&pool);
+
+  ADT_dl_list_init(&dlist);
+  ADT_dl_list_append(&dlist, "a");
+  ADT_dl_list_append(&dlist, "b");
+  dstale = dlist.head;
+  ADT_dl_list_remove(&dlist, dstale, &data);
+  expect(aborts(&dl_double_remove), "dl_double_remove aborts");
+  ADT_dl_list_destroy(&dlist, NULL);
+  printf("Test Node Canaries (ADT_canary_check)...ok\n");
+#endif
+}
+
+int main()
+{
+  test__ADT_check();
+  test__ADT_canary();
+  return 0;
+}
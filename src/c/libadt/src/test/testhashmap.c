@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "hashmap.h"
+
+#define ITEMS 100000
+
+/* Every key lands in the same place, so probing has to do all the work. */
+static size_t hash_const(const void *key)
+{
+  return 42;
+}
+
+static int freed;
+
+static void count_free(void *data)
+{
+  freed++;
+}
+
+void test__ADT_hashmap_insert_find()
+{
+  struct ADT_hashmap map;
+  void *value;
+
+  ADT_hashmap_init(&map, &ADT_hash_str, &ADT_equal_str);
+  assert(ADT_hashmap_find(&map, "a", &value) == -1);
+  assert(ADT_hashmap_capacity(&map) == 0);
+  assert(ADT_hashmap_insert(&map, "a", "A") == 0);
+  assert(ADT_hashmap_insert(&map, "b", "B") == 0);
+  assert(ADT_hashmap_insert(&map, "a", "A2") == 1);
+  assert(ADT_hashmap_length(&map) == 2);
+  assert(ADT_hashmap_find(&map, "a", &value) == 0 && strcmp(value, "A2") == 0);
+  assert(ADT_hashmap_find(&map, "b", &value) == 0 && strcmp(value, "B") == 0);
+  assert(ADT_hashmap_find(&map, "c", NULL) == -1);
+  freed = 0;
+  ADT_hashmap_destroy(&map, NULL, &count_free);
+  assert(freed == 2 && ADT_hashmap_length(&map) == 0);
+  printf("Test Hash Map Insert/Find (ADT_hashmap_insert)...ok\n");
+}
+
+void test__ADT_hashmap_grow_remove()
+{
+  struct ADT_hashmap map;
+  void *key, *value;
+  long i;
+  size_t pos = 0, n = 0;
+
+  ADT_hashmap_init(&map, &ADT_hash_ptr, &ADT_equal_ptr);
+  for (i = 1; i <= ITEMS; i++)
+    assert(ADT_hashmap_insert(&map, (void *)(i * 8), (void *)i) == 0);
+  assert(ADT_hashmap_length(&map) == ITEMS);
+  assert(ADT_hashmap_capacity(&map) - ADT_hashmap_capacity(&map) / 8 >= ITEMS);
+  for (i = 1; i <= ITEMS; i++)
+    assert(ADT_hashmap_find(&map, (void *)(i * 8), &value) == 0 && value == (void *)i);
+  /* Remove the odd ones, then reinsert them over their tombstones. */
+  for (i = 1; i <= ITEMS; i += 2) {
+    assert(ADT_hashmap_remove(&map, (void *)(i * 8), &key, &value) == 0);
+    assert(key == (void *)(i * 8) && value == (void *)i);
+  }
+  assert(ADT_hashmap_remove(&map, (void *)8, NULL, NULL) == -1);
+  assert(ADT_hashmap_length(&map) == ITEMS / 2);
+  for (i = 1; i <= ITEMS; i++)
+    assert(ADT_hashmap_find(&map, (void *)(i * 8), NULL) == (i % 2 ? -1 : 0));
+  while (ADT_hashmap_next(&map, &pos, &key, &value) == 0) {
+    assert((long)key == (long)value * 8 && (long)value % 2 == 0);
+    n++;
+  }
+  assert(n == ITEMS / 2);
+  for (i = 1; i <= ITEMS; i += 2)
+    assert(ADT_hashmap_insert(&map, (void *)(i * 8), (void *)i) == 0);
+  assert(ADT_hashmap_length(&map) == ITEMS);
+  ADT_hashmap_destroy(&map, NULL, NULL);
+  printf("Test Hash Map Growth and Removal (ADT_hashmap_remove)...ok\n");
+}
+
+void test__ADT_hashmap_collisions()
+{
+  struct ADT_hashmap map;
+  void *value;
+  long i;
+
+  ADT_hashmap_init(&map, &hash_const, &ADT_equal_ptr);
+  for (i = 1; i <= 200; i++)
+    assert(ADT_hashmap_insert(&map, (void *)i, (void *)-i) == 0);
+  for (i = 1; i <= 200; i += 3)
+    assert(ADT_hashmap_remove(&map, (void *)i, NULL, NULL) == 0);
+  for (i = 1; i <= 200; i++) {
+    if (i % 3 == 1)
+      assert(ADT_hashmap_find(&map, (void *)i, &value) == -1);
+    else
+      assert(ADT_hashmap_find(&map, (void *)i, &value) == 0 && value == (void *)-i);
+  }
+  ADT_hashmap_destroy(&map, NULL, NULL);
+  printf("Test Hash Map Collisions (ADT_hashmap_find)...ok\n");
+}
+
+void test__ADT_hashmap_reserve()
+{
+  struct ADT_hashmap map;
+  void *keys[1000], *values[1000];
+  size_t cap;
+  long i;
+
+  ADT_hashmap_init(&map, &ADT_hash_ptr, &ADT_equal_ptr);
+  assert(ADT_hashmap_reserve(&map, 1000) == 0);
+  cap = ADT_hashmap_capacity(&map);
+  assert(cap - cap / 8 >= 1000);
+  for (i = 0; i < 1000; i++) {
+    keys[i] = (void *)(i + 1);
+    values[i] = (void *)(i * 2);
+  }
+  assert(ADT_hashmap_insert_n(&map, keys, values, 1000) == 0);
+  assert(ADT_hashmap_capacity(&map) == cap && ADT_hashmap_length(&map) == 1000);
+  for (i = 0; i < 900; i++)
+    ADT_hashmap_remove(&map, keys[i], NULL, NULL);
+  /* Rehashing shrinks to what the remaining entries need. */
+  assert(ADT_hashmap_rehash(&map, 0) == 0);
+  assert(ADT_hashmap_capacity(&map) < cap && ADT_hashmap_length(&map) == 100);
+  for (i = 900; i < 1000; i++)
+    assert(ADT_hashmap_find(&map, keys[i], NULL) == 0);
+  for (i = 900; i < 1000; i++)
+    ADT_hashmap_remove(&map, keys[i], NULL, NULL);
+  assert(ADT_hashmap_rehash(&map, 0) == 0 && ADT_hashmap_capacity(&map) == 0);
+  ADT_hashmap_destroy(&map, NULL, NULL);
+  printf("Test Hash Map Reserve/Rehash (ADT_hashmap_reserve)...ok\n");
+}
+
+int main()
+{
+  test__ADT_hashmap_insert_find();
+  test__ADT_hashmap_grow_remove();
+  test__ADT_hashmap_collisions();
+  test__ADT_hashmap_reserve();
+  return 0;
+}
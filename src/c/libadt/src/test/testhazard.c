@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "hazard.h"
+
+static long objects[2];
+static void *_Atomic shared;
+static atomic_int freed;
+
+static void *counting_alloc(void *ctx, size_t size)
+{
+  return NULL;
+}
+
+static void counting_free(void *ctx, void *ptr)
+{
+  atomic_fetch_add(&freed, 1);
+}
+
+static const struct ADT_allocator counting = { &counting_alloc, &counting_free, NULL };
+
+static void *retirer(void *arg)
+{
+  struct ADT_hp_rec *rec = ADT_hp_get();
+
+  assert(rec != NULL);
+  ADT_hp_retire(rec, arg, &counting);
+  return NULL;
+}
+
+void test__ADT_hp_drain()
+{
+  struct ADT_hp_rec *rec = ADT_hp_get();
+
+  assert(rec != NULL);
+  atomic_init(&freed, 0);
+  atomic_init(&shared, &objects[0]);
+  ADT_hp_retire(rec, &objects[1], &counting);
+  ADT_hp_drain();
+  assert(atomic_load(&freed) == 1);
+  printf("Test Hazard Pointer Drain (ADT_hp_drain)...ok\n");
+}
+
+void test__ADT_hp_drain_exited()
+{
+  struct ADT_hp_rec *rec = ADT_hp_get();
+  pthread_t thread;
+
+  atomic_init(&freed, 0);
+  assert(ADT_hp_protect(rec, 0, &shared) == &objects[0]);
+  /* The retirer exits while we still protect its node. */
+  pthread_create(&thread, NULL, &retirer, &objects[0]);
+  pthread_join(thread, NULL);
+  ADT_hp_drain();
+  assert(atomic_load(&freed) == 0);
+  ADT_hp_clear(rec, 0);
+  ADT_hp_drain();
+  assert(atomic_load(&freed) == 1);
+  printf("Test Hazard Pointer Drain after Exit (ADT_hp_drain)...ok\n");
+}
+
+int main()
+{
+  test__ADT_hp_drain();
+  test__ADT_hp_drain_exited();
+  return 0;
+}
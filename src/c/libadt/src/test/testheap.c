@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "heap.h"
+#include "pool.h"
+
+#define ITEMS 10000
+
+struct timer {
+  long deadline;
+  struct ADT_pheap_node *node;
+};
+
+static int cmp_long(const void *a, const void *b, void *ctx)
+{
+  long x = (long)a, y = (long)b;
+
+  return (x > y) - (x < y);
+}
+
+static int cmp_timer(const void *a, const void *b, void *ctx)
+{
+  long x = ((const struct timer *)a)->deadline, y = ((const struct timer *)b)->deadline;
+
+  ++*(long *)ctx;
+  return (x > y) - (x < y);
+}
+
+void test__ADT_heap()
+{
+  struct ADT_heap heap;
+  void *data, *batch[ITEMS];
+  long i, prev;
+
+  ADT_heap_init(&heap, &cmp_long, NULL);
+  assert(ADT_heap_pop(&heap, &data) == -1 && ADT_heap_peek(&heap, &data) == -1);
+  srand(1);
+  for (i = 0; i < ITEMS; i++)
+    assert(ADT_heap_push(&heap, (void *)(long)(rand() % 1000)) == 0);
+  assert(ADT_heap_length(&heap) == ITEMS);
+  assert(ADT_heap_peek(&heap, &data) == 0);
+  for (prev = -1, i = 0; i < ITEMS; i++) {
+    assert(ADT_heap_pop(&heap, &data) == 0);
+    assert((long)data >= prev);
+    prev = (long)data;
+  }
+  assert(ADT_heap_length(&heap) == 0);
+
+  /* A small batch sifts in, a large one rebuilds the heap. */
+  for (i = 0; i < ITEMS; i++)
+    batch[i] = (void *)(ITEMS - i);
+  assert(ADT_heap_push_n(&heap, batch, 1) == 0);
+  assert(ADT_heap_push_n(&heap, batch + 1, ITEMS - 1) == 0);
+  assert(ADT_heap_push_n(&heap, batch, 10) == 0);
+  assert(ADT_heap_length(&heap) == ITEMS + 10);
+  for (prev = 0, i = 0; i < ITEMS + 10; i++) {
+    assert(ADT_heap_pop(&heap, &data) == 0);
+    assert((long)data >= prev);
+    prev = (long)data;
+  }
+  printf("Test 4-ary Heap (ADT_heap_*)...ok\n");
+  ADT_heap_destroy(&heap, NULL);
+}
+
+void test__ADT_pheap()
+{
+  struct ADT_pheap heap, other;
+  struct ADT_pool pool;
+  struct timer *timers = (struct timer *)malloc(ITEMS * sizeof(struct timer));
+  struct timer *t;
+  void *data;
+  long i, prev, cmps = 0;
+
+  assert(timers != NULL);
+  assert(ADT_pool_init(&pool, sizeof(struct ADT_pheap_node), 256) == 0);
+  ADT_pheap_init_alloc(&heap, &cmp_timer, &cmps, &pool.allocator);
+  ADT_pheap_init_alloc(&other, &cmp_timer, &cmps, &pool.allocator);
+  assert(ADT_pheap_pop(&heap, &data) == -1);
+  srand(2);
+  for (i = 0; i < ITEMS; i++) {
+    timers[i].deadline = 1000 + rand() % 100000;
+    timers[i].node = ADT_pheap_insert((i % 2) ? &heap : &other, &timers[i]);
+    assert(timers[i].node != NULL);
+  }
+  /* Inserting is a single comparison each. */
+  assert(cmps <= ITEMS);
+  ADT_pheap_meld(&heap, &other);
+  assert(ADT_pheap_length(&heap) == ITEMS && ADT_pheap_length(&other) == 0);
+
+  /* Pull every tenth timer forward, some to the very front. */
+  for (i = 0; i < ITEMS; i += 10) {
+    timers[i].deadline -= (i % 20) ? 500 : timers[i].deadline;
+    ADT_pheap_decrease_key(&heap, timers[i].node);
+  }
+  assert(ADT_pheap_peek(&heap, &data) == 0 && ((struct timer *)data)->deadline == 0);
+  /* And cancel every seventh. */
+  for (i = 3; i < ITEMS; i += 7) {
+    ADT_pheap_remove(&heap, timers[i].node, &data);
+    assert(data == &timers[i]);
+    timers[i].node = NULL;
+  }
+  for (prev = -1; ADT_pheap_pop(&heap, &data) == 0; prev = t->deadline) {
+    t = (struct timer *)data;
+    assert(t->node != NULL && t->deadline >= prev);
+    t->node = NULL;
+  }
+  for (i = 0; i < ITEMS; i++)
+    assert(timers[i].node == NULL);
+  assert(ADT_pheap_length(&heap) == 0);
+
+  for (i = 0; i < 100; i++)
+    ADT_pheap_insert(&heap, &timers[i]);
+  ADT_pheap_pop(&heap, &data);
+  ADT_pheap_destroy(&heap, NULL);
+  assert(ADT_pheap_length(&heap) == 0);
+  printf("Test Pairing Heap (ADT_pheap_*)...ok\n");
+  ADT_pool_destroy(&pool);
+  free(timers);
+}
+
+int main()
+{
+  test__ADT_heap();
+  test__ADT_pheap();
+  return 0;
+}
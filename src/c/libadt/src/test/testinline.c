@@ -0,0 +1,41 @@
+#define ADT_INLINE
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "list.h"
+
+/* The same operations as testlist, compiled from the inline definitions. */
+
+void test__ADT_sl_list_inline()
+{
+  struct ADT_sl_list list;
+  struct ADT_pool pool;
+  char *tmp;
+  int i;
+
+  ADT_sl_list_init(&list);
+  assert(ADT_sl_list_push(&list, "b") == 0);
+  assert(ADT_sl_list_push(&list, "a") == 0);
+  assert(ADT_sl_list_append(&list, "c") == 0);
+  assert(ADT_sl_list_length(&list) == 3);
+  ADT_sl_list_pop(&list, (void *)&tmp);
+  assert(*tmp == 'a');
+  ADT_sl_list_dequeue(&list, (void *)&tmp);
+  assert(*tmp == 'b' && list.tail->data == list.head->data);
+  ADT_sl_list_destroy(&list, NULL);
+
+  ADT_sl_pool_init(&pool, 8);
+  ADT_sl_list_init_pooled(&list, &pool);
+  for (i = 0; i < 100; i++)
+    ADT_sl_list_enqueue(&list, &list);
+  assert(ADT_sl_list_length(&list) == 100);
+  ADT_sl_list_destroy(&list, NULL);
+  ADT_pool_destroy(&pool);
+  printf("Test Single Linked List Inline (ADT_INLINE)...ok\n");
+}
+
+int main()
+{
+  test__ADT_sl_list_inline();
+  return 0;
+}
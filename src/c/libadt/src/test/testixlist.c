@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "ixlist.h"
+
+#define ITEMS 100000
+
+void test__ADT_ix_list()
+{
+  struct ADT_ix_list list;
+  void *items[4] = { "a", "b", "c", "d" };
+  void *data;
+  uint32_t ix;
+  int i = 0;
+
+  assert(ADT_ix_list_init(&list) == 0);
+  assert(list.slot_size == sizeof(uint32_t) + sizeof(void *));
+  assert(ADT_ix_list_append(&list, items[1]) == 0);
+  assert(ADT_ix_list_push(&list, items[0]) == 0);
+  assert(ADT_ix_list_append(&list, items[3]) == 0);
+  assert(ADT_ix_list_insert_after(&list, list.hdr->head, items[1]) == 0);
+  ADT_ix_list_remove_after(&list, list.hdr->head, &data);
+  assert(data == items[1]);
+  assert(ADT_ix_list_insert_after(&list, ADT_ix_next(&list, list.hdr->head), items[2]) == 0);
+  assert(ADT_ix_list_length(&list) == 4);
+  ADT_ix_list_foreach(&list, ix)
+    assert(ADT_ix_list_get(&list, ix) == items[i++]);
+  assert(ADT_ix_list_get(&list, list.hdr->tail) == items[3]);
+  /* The removed slot was recycled. */
+  assert(list.hdr->used == 4);
+  for (i = 0; i < 4; i++) {
+    ADT_ix_list_pop(&list, &data);
+    assert(data == items[i]);
+  }
+  assert(list.hdr->head == ADT_IX_NIL && list.hdr->tail == ADT_IX_NIL);
+  printf("Test Index List (ADT_ix_list_*)...ok\n");
+  ADT_ix_list_destroy(&list, NULL);
+}
+
+void test__ADT_ix_list_inline()
+{
+  struct ADT_ix_list list, copy;
+  struct ADT_ix_header *block;
+  uint32_t ix, v;
+  long i;
+
+  assert(ADT_ix_list_init_inline(&list, 0) == -1);
+  assert(ADT_ix_list_init_inline(&list, sizeof(uint32_t)) == 0);
+  assert(list.slot_size == 8);
+  for (i = 0; i < ITEMS; i++) {
+    v = (uint32_t)i;
+    assert(ADT_ix_list_append_inline(&list, &v) == 0);
+  }
+  v = ITEMS;
+  assert(ADT_ix_list_push_inline(&list, &v) == 0);
+  assert(ADT_ix_list_length(&list) == ITEMS + 1 && list.hdr->cap >= ITEMS + 1);
+  ADT_ix_list_pop_inline(&list, &v);
+  assert(v == ITEMS);
+  v = ITEMS / 2;
+  ix = ADT_ix_list_find(&list, &v);
+  assert(ix != ADT_IX_NIL && memcmp(ADT_ix_payload(&list, ix), &v, sizeof(v)) == 0);
+  v = ITEMS;
+  assert(ADT_ix_list_find(&list, &v) == ADT_IX_NIL);
+
+  /* A byte copy of the block is the same list. */
+  block = malloc(ADT_ix_list_size(&list));
+  memcpy(block, list.hdr, ADT_ix_list_size(&list));
+  ADT_ix_list_destroy(&list, NULL);
+  assert(ADT_ix_list_attach(&copy, block, NULL, NULL) == 0);
+  i = 0;
+  ADT_ix_list_foreach(&copy, ix) {
+    memcpy(&v, ADT_ix_payload(&copy, ix), sizeof(v));
+    assert(v == (uint32_t)i++);
+  }
+  assert(i == ITEMS);
+  /* Without a grow fn the block is full once its fresh slots run out. */
+  while (copy.hdr->used < copy.hdr->cap)
+    assert(ADT_ix_list_append_inline(&copy, &v) == 0);
+  assert(ADT_ix_list_append_inline(&copy, &v) == -1);
+  block->head = block->used;
+  assert(ADT_ix_list_attach(&copy, block, NULL, NULL) == -1);
+  free(block);
+  printf("Test Inline Index List (ADT_ix_list_*_inline)...ok\n");
+}
+
+int main()
+{
+  test__ADT_ix_list();
+  test__ADT_ix_list_inline();
+  return 0;
+}
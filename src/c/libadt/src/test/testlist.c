@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include "list.h"
 
@@ -159,6 +160,346 @@ void test__ADT_sl_list_length()
   free(list);
 }
 
+void test__ADT_sl_list_init_pooled()
+{
+  struct ADT_pool pool;
+  struct ADT_sl_list list;
+  struct ADT_sl_node *node;
+  char *a_ptr = (char *)malloc(sizeof(char));
+  char *b_ptr = (char *)malloc(sizeof(char));
+  char *tmp;
+
+  *a_ptr = 'a';
+  *b_ptr = 'b';
+
+  assert(ADT_sl_pool_init(&pool, 16) == 0);
+  ADT_sl_list_init_pooled(&list, &pool);
+  ADT_sl_list_append(&list, a_ptr);
+  ADT_sl_list_append(&list, b_ptr);
+  assert(*(char *)list.head->next->data == 'b');
+  /* A popped node is recycled by the next insert. */
+  node = list.head;
+  ADT_sl_list_pop(&list, (void *)&tmp);
+  assert(tmp == a_ptr);
+  ADT_sl_list_append(&list, a_ptr);
+  assert(list.tail == node && list.tail->data == a_ptr);
+  /* Removing the tail moves tail back to loc. */
+  ADT_sl_list_remove_after(&list, list.head, (void *)&tmp);
+  assert(tmp == a_ptr && list.tail == list.head);
+  free(tmp);
+  printf("Test Single Linked List Pooled (ADT_sl_list_init_pooled)...ok\n");
+  ADT_sl_list_destroy(&list, &free);
+  ADT_pool_destroy(&pool);
+}
+
+struct item {
+  char c;
+  struct ADT_sl_link link;
+};
+
+void test__ADT_sl_ilist()
+{
+  struct ADT_sl_ilist list;
+  struct item a = { 'a' }, b = { 'b' }, c = { 'c' };
+  struct ADT_sl_link *tmp;
+
+  ADT_sl_ilist_init(&list);
+  ADT_sl_ilist_append(&list, &b.link);
+  ADT_sl_ilist_push(&list, &a.link);
+  ADT_sl_ilist_insert_after(&list, &b.link, &c.link);
+  assert(ADT_sl_ilist_length(&list) == 3);
+  assert(ADT_sl_ilist_entry(list.head, struct item, link)->c == 'a');
+  assert(ADT_sl_ilist_entry(list.head->next, struct item, link)->c == 'b');
+  assert(list.tail == &c.link);
+
+  ADT_sl_ilist_remove_after(&list, &b.link, &tmp);
+  assert(tmp == &c.link && list.tail == &b.link);
+  ADT_sl_ilist_pop(&list, &tmp);
+  assert(ADT_sl_ilist_entry(tmp, struct item, link) == &a);
+  ADT_sl_ilist_dequeue(&list, &tmp);
+  assert(tmp == &b.link);
+  assert(ADT_sl_ilist_length(&list) == 0 && list.tail == NULL);
+  printf("Test Intrusive Single Linked List (ADT_sl_ilist_*)...ok\n");
+}
+
+void test__ADT_sl_list_append_n()
+{
+  struct ADT_sl_list list;
+  void *items[5] = { "a", "b", "c", "d", "e" };
+  void *out[8];
+  struct ADT_sl_node *node;
+  size_t i;
+
+  ADT_sl_list_init(&list);
+  assert(ADT_sl_list_append_n(&list, items + 2, 3) == 0);
+  assert(ADT_sl_list_push_n(&list, items, 2) == 0);
+  assert(ADT_sl_list_length(&list) == 5);
+  for (i = 0, node = list.head; node != NULL; i++, node = node->next)
+    assert(node->data == items[i]);
+  assert(list.tail->data == items[4] && list.tail->next == NULL);
+  printf("Test Single Linked List Batch Append (ADT_sl_list_append_n)...ok\n");
+
+  assert(ADT_sl_list_pop_n(&list, out, 2) == 2);
+  assert(out[0] == items[0] && out[1] == items[1]);
+  assert(ADT_sl_list_pop_n(&list, out, 8) == 3);
+  assert(out[2] == items[4] && list.tail == NULL);
+  assert(ADT_sl_list_pop_n(&list, out, 8) == 0);
+  printf("Test Single Linked List Batch Pop (ADT_sl_list_pop_n)...ok\n");
+  ADT_sl_list_destroy(&list, NULL);
+}
+
+void test__ADT_sl_list_splice()
+{
+  struct ADT_sl_list a, b;
+  void *items[4] = { "a", "b", "c", "d" };
+  void *out[4];
+
+  ADT_sl_list_init(&a);
+  ADT_sl_list_init(&b);
+  ADT_sl_list_splice(&a, &b);
+  assert(ADT_sl_list_length(&a) == 0);
+  ADT_sl_list_append_n(&b, items, 2);
+  ADT_sl_list_splice(&a, &b);
+  ADT_sl_list_append_n(&b, items + 2, 2);
+  ADT_sl_list_splice(&a, &b);
+  assert(ADT_sl_list_length(&a) == 4 && ADT_sl_list_length(&b) == 0);
+  assert(b.head == NULL && b.tail == NULL);
+  assert(a.tail->data == items[3]);
+  ADT_sl_list_pop_n(&a, out, 4);
+  assert(out[0] == items[0] && out[3] == items[3]);
+  printf("Test Single Linked List Splice (ADT_sl_list_splice)...ok\n");
+}
+
+void test__ADT_sl_list_split_after()
+{
+  struct ADT_sl_list a, b;
+  void *items[4] = { "a", "b", "c", "d" };
+
+  ADT_sl_list_init(&a);
+  ADT_sl_list_init(&b);
+  ADT_sl_list_append_n(&a, items, 4);
+  ADT_sl_list_split_after(&a, a.head->next, &b);
+  assert(ADT_sl_list_length(&a) == 2 && ADT_sl_list_length(&b) == 2);
+  assert(a.tail->data == items[1] && a.tail->next == NULL);
+  assert(b.head->data == items[2] && b.tail->data == items[3]);
+  /* Splitting after the tail moves nothing. */
+  ADT_sl_list_split_after(&a, a.tail, &b);
+  assert(ADT_sl_list_length(&b) == 2);
+  printf("Test Single Linked List Split After (ADT_sl_list_split_after)...ok\n");
+  ADT_sl_list_destroy(&a, NULL);
+  ADT_sl_list_destroy(&b, NULL);
+}
+
+static int cmp_long(const void *a, const void *b, void *ctx)
+{
+  return ((long)a > (long)b) - ((long)a < (long)b);
+}
+
+/* Items sort by their first character only, the rest checks stability. */
+static int cmp_first(const void *a, const void *b, void *ctx)
+{
+  (*(int *)ctx)++;
+  return *(const char *)a - *(const char *)b;
+}
+
+void test__ADT_sl_list_sort()
+{
+  struct ADT_sl_list list;
+  struct ADT_sl_node *node;
+  void *items[9] = { "c0", "a0", "b0", "c1", "a1", "a2", "b1", "c2", "a3" };
+  void *sorted[9] = { "a0", "a1", "a2", "a3", "b0", "b1", "c0", "c1", "c2" };
+  int calls = 0, i = 0;
+  long n, prev;
+
+  ADT_sl_list_init(&list);
+  ADT_sl_list_sort(&list, &cmp_first, &calls);
+  assert(list.head == NULL && calls == 0);
+  ADT_sl_list_append_n(&list, items, 9);
+  ADT_sl_list_sort(&list, &cmp_first, &calls);
+  ADT_sl_list_foreach(&list, node)
+    assert(node->data == sorted[i++]);
+  assert(i == 9 && list.tail->data == sorted[8] && list.tail->next == NULL);
+  ADT_sl_list_destroy(&list, NULL);
+
+  /* A long reversed run, so every power of two is exercised. */
+  ADT_sl_list_init(&list);
+  for (n = 0; n < 1000; n++)
+    ADT_sl_list_push(&list, (void *)(n * 7919 % 1000));
+  ADT_sl_list_sort(&list, &cmp_long, NULL);
+  prev = -1;
+  i = 0;
+  ADT_sl_list_foreach(&list, node) {
+    assert((long)node->data > prev);
+    prev = (long)node->data;
+    i++;
+  }
+  assert(i == 1000 && ADT_sl_list_length(&list) == 1000 && (long)list.tail->data == 999);
+  printf("Test Single Linked List Sort (ADT_sl_list_sort)...ok\n");
+  ADT_sl_list_destroy(&list, NULL);
+}
+
+void test__ADT_sl_list_merge_n()
+{
+  struct ADT_sl_list lists[5], *srcs[5], dst;
+  struct ADT_sl_node *node;
+  long i, n = 0, prev = -1;
+
+  ADT_sl_list_init(&dst);
+  for (i = 0; i < 5; i++) {
+    ADT_sl_list_init(&lists[i]);
+    srcs[i] = &lists[i];
+  }
+  /* List i holds the multiples of i + 1 below 100; list 3 stays empty. */
+  for (i = 0; i < 100; i++) {
+    ADT_sl_list_append(&lists[0], (void *)i);
+    if (i % 2 == 0)
+      ADT_sl_list_append(&lists[1], (void *)i);
+    if (i % 3 == 0)
+      ADT_sl_list_append(&lists[2], (void *)i);
+    if (i % 5 == 0)
+      ADT_sl_list_append(&lists[4], (void *)i);
+  }
+  ADT_sl_list_merge_n(&dst, srcs, 5, &cmp_long, NULL);
+  ADT_sl_list_foreach(&dst, node) {
+    assert((long)node->data >= prev);
+    prev = (long)node->data;
+    n++;
+  }
+  assert(n == 100 + 50 + 34 + 20 && ADT_sl_list_length(&dst) == n);
+  assert((long)dst.tail->data == 99);
+  for (i = 0; i < 5; i++)
+    assert(ADT_sl_list_length(&lists[i]) == 0 && lists[i].head == NULL);
+  printf("Test Single Linked List K-way Merge (ADT_sl_list_merge_n)...ok\n");
+  ADT_sl_list_destroy(&dst, NULL);
+}
+
+static void sum_chars(void *data, void *ctx)
+{
+  *(int *)ctx += *(char *)data;
+}
+
+void test__ADT_sl_list_map()
+{
+  struct ADT_sl_list list;
+  struct ADT_sl_iter iter;
+  struct ADT_sl_node *node;
+  void *items[10] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9" };
+  void *data;
+  int i = 0, sum = 0;
+
+  ADT_sl_list_init(&list);
+  ADT_sl_iter_init(&iter, &list);
+  assert(ADT_sl_iter_next(&iter, &data) == -1);
+  ADT_sl_list_append_n(&list, items, 10);
+  ADT_sl_iter_init(&iter, &list);
+  while (ADT_sl_iter_next(&iter, &data) == 0)
+    assert(data == items[i++]);
+  assert(i == 10);
+  ADT_sl_list_map(&list, &sum_chars, &sum);
+  assert(sum == 10 * '0' + 45);
+  i = 0;
+  ADT_sl_list_foreach(&list, node)
+    assert(node->data == items[i++]);
+  printf("Test Single Linked List Map (ADT_sl_list_map)...ok\n");
+  ADT_sl_list_destroy(&list, NULL);
+}
+
+static int freed;
+
+static void count_free(void *data)
+{
+  freed++;
+}
+
+void test__ADT_sl_list_destroy_deferred()
+{
+  struct ADT_sl_list list;
+  struct ADT_sl_reclaim r;
+  struct ADT_pool pool;
+  struct ADT_allocator bulk;
+  long i;
+
+  ADT_sl_list_init(&list);
+  for (i = 0; i < 1000; i++)
+    ADT_sl_list_append(&list, (void *)i);
+  ADT_sl_list_destroy_deferred(&list, &count_free, &r);
+  assert(ADT_sl_list_length(&list) == 0 && list.head == NULL && list.tail == NULL);
+  assert(r.len == 1000 && freed == 0);
+  assert(ADT_sl_reclaim_step(&r, 300) == 700 && freed == 300);
+  assert(ADT_sl_reclaim_step(&r, SIZE_MAX) == 0 && freed == 1000);
+  assert(ADT_sl_reclaim_step(&r, SIZE_MAX) == 0);
+
+  /* A bulk allocator with nothing to destroy leaves nothing to step. */
+  assert(ADT_sl_pool_init(&pool, 64) == 0);
+  bulk.alloc = pool.allocator.alloc;
+  bulk.free = NULL;
+  bulk.ctx = pool.allocator.ctx;
+  ADT_sl_list_init_alloc(&list, &bulk);
+  for (i = 0; i < 1000; i++)
+    ADT_sl_list_append(&list, (void *)i);
+  ADT_sl_list_destroy_deferred(&list, NULL, &r);
+  assert(r.len == 0 && r.chain == NULL);
+  ADT_pool_destroy(&pool);
+  printf("Test Single Linked List Deferred Destroy (ADT_sl_list_destroy_deferred)...ok\n");
+}
+
+static size_t str_size(const void *data, void *ctx)
+{
+  return strlen((const char *)data);
+}
+
+static void str_encode(const void *data, void *buf, void *ctx)
+{
+  memcpy(buf, data, strlen((const char *)data));
+}
+
+static void *str_decode(const void *buf, size_t len, void *ctx)
+{
+  char *s;
+
+  if (len == 0 || (s = malloc(len + 1)) == NULL)
+    return NULL;
+  memcpy(s, buf, len);
+  s[len] = '\0';
+  return s;
+}
+
+void test__ADT_sl_list_serialize()
+{
+  struct ADT_sl_list list, copy;
+  struct ADT_sl_codec codec = { &str_size, &str_encode, &str_decode, NULL };
+  struct ADT_sl_node *node;
+  struct iovec iov[4];
+  void *items[3] = { "alpha", "be", "gamma" }, *out[4];
+  char buf[64];
+  size_t n;
+  int i = 0;
+
+  ADT_sl_list_init(&list);
+  ADT_sl_list_append_n(&list, items, 3);
+  assert(ADT_sl_list_to_array(&list, out, 2) == 2);
+  assert(out[0] == items[0] && out[1] == items[1]);
+  assert(ADT_sl_list_to_array(&list, out, 4) == 3 && out[2] == items[2]);
+  assert(ADT_sl_list_to_iovec(&list, iov, 4, &str_size, NULL) == 3);
+  assert(iov[1].iov_base == items[1] && iov[1].iov_len == 2);
+
+  n = ADT_sl_list_serialize(&list, &codec, NULL, 0);
+  assert(n == 4 + 3 * 4 + 5 + 2 + 5);
+  assert(ADT_sl_list_serialize(&list, &codec, buf, sizeof(buf)) == n);
+  ADT_sl_list_init(&copy);
+  /* Truncated input leaves the list untouched. */
+  assert(ADT_sl_list_deserialize(&copy, &codec, buf, n - 1, &free) == -1);
+  assert(ADT_sl_list_length(&copy) == 0);
+  assert(ADT_sl_list_deserialize(&copy, &codec, buf, n + 1, &free) == -1);
+  assert(ADT_sl_list_deserialize(&copy, &codec, buf, n, &free) == 0);
+  assert(ADT_sl_list_length(&copy) == 3);
+  ADT_sl_list_foreach(&copy, node)
+    assert(strcmp(node->data, items[i++]) == 0);
+  printf("Test Single Linked List Serialize (ADT_sl_list_serialize)...ok\n");
+  ADT_sl_list_destroy(&copy, &free);
+  ADT_sl_list_destroy(&list, NULL);
+}
+
 int main()
 {
   test__ADT_sl_list_push();
@@ -167,5 +508,15 @@ int main()
   test__ADT_sl_list_insert_after();
   test__ADT_sl_list_remove_after();
   test__ADT_sl_list_length();
+  test__ADT_sl_list_init_pooled();
+  test__ADT_sl_ilist();
+  test__ADT_sl_list_append_n();
+  test__ADT_sl_list_splice();
+  test__ADT_sl_list_split_after();
+  test__ADT_sl_list_sort();
+  test__ADT_sl_list_merge_n();
+  test__ADT_sl_list_map();
+  test__ADT_sl_list_serialize();
+  test__ADT_sl_list_destroy_deferred();
   return 0;
 }
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "lru.h"
+
+static size_t hash_str(const void *key)
+{
+  const unsigned char *s = (const unsigned char *)key;
+  size_t h = 5381;
+
+  while (*s != '\0')
+    h = h * 33 + *s++;
+  return h;
+}
+
+static int equal_str(const void *a, const void *b)
+{
+  return strcmp((const char *)a, (const char *)b) == 0;
+}
+
+/* Equal low bits for every key, as pointer or aligned-offset hashes give. */
+static size_t hash_shifted(const void *key)
+{
+  return (size_t)*(const int *)key << 20;
+}
+
+static int equal_int(const void *a, const void *b)
+{
+  return *(const int *)a == *(const int *)b;
+}
+
+static int evicted;
+
+static void count_evict(void *value)
+{
+  evicted++;
+}
+
+void test__ADT_lru_entries()
+{
+  struct ADT_lru lru;
+  struct ADT_lru_stats stats;
+  void *value;
+
+  evicted = 0;
+  assert(ADT_lru_init(&lru, 2, 0, &hash_str, &equal_str, &count_evict) == 0);
+  assert(ADT_lru_put(&lru, "a", "A", 1) == 0);
+  assert(ADT_lru_put(&lru, "b", "B", 1) == 0);
+  /* Touching a makes b the least recently used. */
+  assert(ADT_lru_get(&lru, "a", &value) == 0 && strcmp(value, "A") == 0);
+  assert(ADT_lru_put(&lru, "c", "C", 1) == 0);
+  assert(evicted == 1 && ADT_lru_length(&lru) == 2);
+  assert(ADT_lru_get(&lru, "b", &value) == -1);
+  assert(ADT_lru_get(&lru, "c", &value) == 0 && strcmp(value, "C") == 0);
+  /* Replacing drops the old value without an eviction. */
+  assert(ADT_lru_put(&lru, "a", "A2", 1) == 0);
+  assert(evicted == 2 && ADT_lru_length(&lru) == 2);
+  assert(ADT_lru_remove(&lru, "c", &value) == 0 && strcmp(value, "C") == 0);
+  assert(ADT_lru_remove(&lru, "c", &value) == -1 && evicted == 2);
+  ADT_lru_get_stats(&lru, &stats);
+  assert(stats.hits == 2 && stats.misses == 1);
+  assert(stats.evictions == 1 && stats.inserts == 3);
+  ADT_lru_destroy(&lru);
+  assert(evicted == 3);
+  printf("Test LRU Entry Bound (ADT_lru_put)...ok\n");
+}
+
+void test__ADT_lru_bytes()
+{
+  struct ADT_lru lru;
+  void *value;
+
+  evicted = 0;
+  assert(ADT_lru_init(&lru, 0, 10, &hash_str, &equal_str, &count_evict) == 0);
+  assert(ADT_lru_put(&lru, "a", "A", 4) == 0);
+  assert(ADT_lru_put(&lru, "b", "B", 4) == 0);
+  assert(ADT_lru_put(&lru, "c", "C", 4) == 0);
+  assert(evicted == 1 && lru.bytes == 8);
+  assert(ADT_lru_get(&lru, "a", &value) == -1);
+  /* Too big for the bound, so it is left on its own. */
+  assert(ADT_lru_put(&lru, "d", "D", 20) == 0);
+  assert(evicted == 3 && ADT_lru_length(&lru) == 1 && lru.bytes == 20);
+  ADT_lru_destroy(&lru);
+  printf("Test LRU Byte Bound (ADT_lru_put)...ok\n");
+}
+
+void test__ADT_lru_grow()
+{
+  struct ADT_lru lru;
+  char (*keys)[8];
+  void *value;
+  int i, n = 10000;
+
+  keys = malloc(n * sizeof(*keys));
+  assert(ADT_lru_init(&lru, 0, 0, &hash_str, &equal_str, NULL) == 0);
+  for (i = 0; i < n; i++) {
+    sprintf(keys[i], "%d", i);
+    assert(ADT_lru_put(&lru, keys[i], keys[i], 1) == 0);
+  }
+  assert(ADT_lru_length(&lru) == n && lru.mask + 1 >= (size_t)n);
+  for (i = 0; i < n; i++)
+    assert(ADT_lru_get(&lru, keys[i], &value) == 0 && value == keys[i]);
+  ADT_lru_destroy(&lru);
+  free(keys);
+  printf("Test LRU Index Growth (ADT_lru_get)...ok\n");
+}
+
+void test__ADT_lru_spread()
+{
+  struct ADT_lru lru;
+  struct ADT_lru_entry *entry;
+  int keys[64], i;
+  size_t b, len, longest = 0;
+  void *value;
+
+  assert(ADT_lru_init(&lru, 0, 0, &hash_shifted, &equal_int, NULL) == 0);
+  for (i = 0; i < 64; i++) {
+    keys[i] = i;
+    assert(ADT_lru_put(&lru, &keys[i], &keys[i], 1) == 0);
+  }
+  for (b = 0; b <= lru.mask; b++) {
+    for (len = 0, entry = lru.buckets[b]; entry != NULL; entry = entry->chain)
+      len++;
+    if (len > longest)
+      longest = len;
+  }
+  assert(longest < 16);
+  for (i = 0; i < 64; i++)
+    assert(ADT_lru_get(&lru, &keys[i], &value) == 0 && value == &keys[i]);
+  ADT_lru_destroy(&lru);
+  printf("Test LRU Hash Spread (ADT_lru_put)...ok\n");
+}
+
+int main()
+{
+  test__ADT_lru_entries();
+  test__ADT_lru_bytes();
+  test__ADT_lru_grow();
+  test__ADT_lru_spread();
+  return 0;
+}
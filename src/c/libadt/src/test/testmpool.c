@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "mpool.h"
+#include "cqueue.h"
+#include "hazard.h"
+
+#define THREADS 4
+#define ITEMS 20000
+#define OBJS (5 * ADT_MAG_SIZE)
+
+static struct ADT_mpool mpool;
+static struct ADT_ms_queue ms;
+static atomic_long consumed_sum;
+static atomic_long consumed_count;
+
+void test__ADT_mpool_get()
+{
+  void *objs[OBJS];
+  int i, j;
+
+  assert(ADT_mpool_init(&mpool, 0, 1) == -1);
+  assert(ADT_mpool_init(&mpool, 24, 2) == 0);
+  assert(mpool.ndepots == 2 && mpool.size == 24);
+  for (i = 0; i < OBJS; i++) {
+    objs[i] = ADT_mpool_get(&mpool);
+    assert(objs[i] != NULL);
+    memset(objs[i], i, mpool.size);
+  }
+  for (i = 0; i < OBJS; i++)
+    for (j = 0; j < i; j++)
+      assert(objs[i] != objs[j]);
+  for (i = 0; i < OBJS; i++)
+    ADT_mpool_put(&mpool, objs[i]);
+  /* Both magazines filled and full ones went to the depot. */
+  assert(mpool.caches != NULL && mpool.caches->depot->full != NULL);
+  /* The most recently freed object is handed back first. */
+  assert(ADT_mpool_get(&mpool) == objs[OBJS - 1]);
+  printf("Test Concurrent Pool Get (ADT_mpool_get)...ok\n");
+  ADT_mpool_destroy(&mpool);
+}
+
+static void *ms_producer(void *arg)
+{
+  long base = (long)arg * ITEMS, i;
+
+  for (i = 1; i <= ITEMS; i++)
+    assert(ADT_ms_queue_enqueue(&ms, (void *)(base + i)) == 0);
+  return NULL;
+}
+
+static void *ms_consumer(void *arg)
+{
+  void *data;
+
+  while (atomic_load(&consumed_count) < THREADS * ITEMS) {
+    if (ADT_ms_queue_dequeue(&ms, &data) == 0) {
+      atomic_fetch_add(&consumed_sum, (long)data);
+      atomic_fetch_add(&consumed_count, 1);
+    }
+  }
+  return NULL;
+}
+
+void test__ADT_mpool_queue()
+{
+  pthread_t producers[THREADS], consumers[THREADS];
+  long i, n = (long)THREADS * ITEMS;
+
+  assert(ADT_mpool_init(&mpool, sizeof(struct ADT_ms_node), 0) == 0);
+  assert(mpool.ndepots >= 1);
+  assert(ADT_ms_queue_init_alloc(&ms, &mpool.allocator) == 0);
+  atomic_init(&consumed_sum, 0);
+  atomic_init(&consumed_count, 0);
+  for (i = 0; i < THREADS; i++) {
+    pthread_create(&producers[i], NULL, &ms_producer, (void *)i);
+    pthread_create(&consumers[i], NULL, &ms_consumer, NULL);
+  }
+  for (i = 0; i < THREADS; i++) {
+    pthread_join(producers[i], NULL);
+    pthread_join(consumers[i], NULL);
+  }
+  assert(atomic_load(&consumed_sum) == n * (n + 1) / 2);
+  /* Exited threads gave their magazines back; only ours is left. */
+  assert(mpool.caches != NULL && mpool.caches->next == NULL);
+  ADT_ms_queue_destroy(&ms, NULL);
+  ADT_hp_drain();
+  printf("Test Concurrent Pool Queue Nodes (ADT_mpool_put)...ok\n");
+  ADT_mpool_destroy(&mpool);
+}
+
+int main()
+{
+  test__ADT_mpool_get();
+  test__ADT_mpool_queue();
+  return 0;
+}
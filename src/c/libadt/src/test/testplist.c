@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "plist.h"
+
+#define ITEMS 10000
+
+static char path[64];
+
+/* Read the state field of the persistent list header in the file at path. */
+static uint32_t plist_state(void)
+{
+  int fd = open(path, O_RDONLY);
+  uint32_t state = UINT32_MAX;
+
+  if (fd >= 0) {
+    if (pread(fd, &state, sizeof(state), offsetof(struct ADT_plist_header, state)) != sizeof(state))
+      state = UINT32_MAX;
+    close(fd);
+  }
+  return state;
+}
+
+void test__ADT_plist()
+{
+  struct ADT_plist plist;
+  uint32_t ix, v;
+  long i;
+
+  assert(ADT_plist_open(&plist, path, 0) == -1 && errno == EINVAL);
+  unlink(path);
+  assert(ADT_plist_open(&plist, path, sizeof(uint32_t)) == 0);
+  assert(ADT_plist_length(&plist) == 0);
+  for (i = 0; i < ITEMS; i++) {
+    v = (uint32_t)i;
+    assert(ADT_plist_enqueue(&plist, &v) == 0);
+  }
+  ADT_plist_dequeue(&plist, &v);
+  assert(v == 0);
+  assert(ADT_plist_checkpoint(&plist) == 0);
+  assert(plist_state() == ADT_PLIST_CLEAN);
+  assert(ADT_plist_close(&plist) == 0);
+
+  /* Reopening takes the payload from the file and resumes the queue. */
+  assert(ADT_plist_open(&plist, path, sizeof(uint64_t)) == -1 && errno == EINVAL);
+  assert(ADT_plist_open(&plist, path, 0) == 0);
+  assert(((struct ADT_plist_header *)plist.map)->generation == 1);
+  assert(ADT_plist_length(&plist) == ITEMS - 1);
+  i = 1;
+  ADT_plist_foreach(&plist, ix) {
+    memcpy(&v, ADT_ix_payload(&plist.list, ix), sizeof(v));
+    assert(v == (uint32_t)i++);
+  }
+  v = 0;
+  /* The first change marks the file itself dirty, not just the mapping. */
+  assert(plist_state() == ADT_PLIST_CLEAN);
+  assert(ADT_plist_push(&plist, &v) == 0);
+  assert(plist_state() == ADT_PLIST_DIRTY);
+  assert(ADT_plist_close(&plist) == 0);
+  assert(plist_state() == ADT_PLIST_CLEAN);
+
+  assert(ADT_plist_open(&plist, path, sizeof(uint32_t)) == 0);
+  for (i = 0; i < ITEMS; i++) {
+    ADT_plist_pop(&plist, &v);
+    assert(v == (uint32_t)i);
+  }
+  assert(ADT_plist_length(&plist) == 0);
+  assert(ADT_plist_close(&plist) == 0);
+  printf("Test Persistent List (ADT_plist_*)...ok\n");
+}
+
+/* Overwrite a 32-bit field of the list header in the file at path. */
+static int plist_poke(size_t offset, uint32_t v)
+{
+  int fd = open(path, O_RDWR);
+  ssize_t n;
+
+  if (fd < 0)
+    return -1;
+  n = pwrite(fd, &v, sizeof(v), (off_t)(sizeof(struct ADT_plist_header) + offset));
+  close(fd);
+  return (n == sizeof(v)) ? 0 : -1;
+}
+
+void test__ADT_plist_recovery()
+{
+  struct ADT_plist plist;
+  struct ADT_plist_header *hdr;
+  uint32_t v, tail, free_ix;
+  long i;
+
+  assert(ADT_plist_open(&plist, path, 0) == 0);
+  for (i = 0; i < 100; i++) {
+    v = (uint32_t)i;
+    assert(ADT_plist_append(&plist, &v) == 0);
+  }
+  assert(ADT_plist_sync(&plist) == 0);
+  /* Interrupt an append after it linked its slot; a dirty file is repaired. */
+  hdr = (struct ADT_plist_header *)plist.map;
+  assert(hdr->state == ADT_PLIST_DIRTY);
+  tail = plist.list.hdr->tail;
+  plist.list.hdr->len = 42;
+  plist.list.hdr->tail = plist.list.hdr->head;
+  munmap(plist.map, plist.map_size);
+  close(plist.fd);
+
+  assert(ADT_plist_open(&plist, path, 0) == 0);
+  assert(ADT_plist_length(&plist) == 100 && plist.list.hdr->tail == tail);
+  v = 100;
+  assert(ADT_plist_append(&plist, &v) == 0);
+  assert(ADT_plist_close(&plist) == 0);
+
+  /* A clean file is trusted, but its links must stay within the slots used. */
+  assert(ADT_plist_open(&plist, path, 0) == 0);
+  assert(ADT_plist_length(&plist) == 101);
+  free_ix = plist.list.hdr->free;
+  plist.list.hdr->free = plist.list.hdr->used;
+  assert(ADT_plist_close(&plist) == 0);
+  assert(ADT_plist_open(&plist, path, 0) == -1 && errno == EINVAL);
+  assert(plist_poke(offsetof(struct ADT_ix_header, free), free_ix) == 0);
+
+  /* And its magic and version are checked. */
+  assert(ADT_plist_open(&plist, path, 0) == 0);
+  assert(ADT_plist_length(&plist) == 101);
+  hdr = (struct ADT_plist_header *)plist.map;
+  hdr->version = ADT_PLIST_VERSION + 1;
+  assert(ADT_plist_close(&plist) == 0);
+  assert(ADT_plist_open(&plist, path, 0) == -1 && errno == EINVAL);
+  unlink(path);
+  printf("Test Persistent List (ADT_plist_open recovery)...ok\n");
+}
+
+int main()
+{
+  FILE *f;
+
+  snprintf(path, sizeof(path), "/tmp/testplist.%ld", (long)getpid());
+  /* Not a persistent list file. */
+  f = fopen(path, "w");
+  fputs("not a list", f);
+  fclose(f);
+  test__ADT_plist();
+  test__ADT_plist_recovery();
+  return 0;
+}
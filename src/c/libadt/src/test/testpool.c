@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "pool.h"
+
+void test__ADT_pool_get()
+{
+  struct ADT_pool pool;
+  char *a_ptr, *b_ptr;
+
+  assert(ADT_pool_init(&pool, sizeof(char), 2) == 0);
+  a_ptr = (char *)ADT_pool_get(&pool);
+  b_ptr = (char *)ADT_pool_get(&pool);
+  assert(a_ptr != NULL && b_ptr != NULL);
+  /* Both objects come from the same chunk. */
+  assert(b_ptr == a_ptr + pool.size);
+  /* The third object needs a second chunk. */
+  assert(ADT_pool_get(&pool) != NULL);
+  assert(pool.chunks != NULL && pool.chunks->next != NULL);
+  printf("Test Pool Get (ADT_pool_get)...ok\n");
+  ADT_pool_destroy(&pool);
+}
+
+void test__ADT_pool_put()
+{
+  struct ADT_pool pool;
+  void *a_ptr, *b_ptr;
+
+  assert(ADT_pool_init(&pool, 24, 8) == 0);
+  a_ptr = ADT_pool_get(&pool);
+  b_ptr = ADT_pool_get(&pool);
+  ADT_pool_put(&pool, a_ptr);
+  ADT_pool_put(&pool, b_ptr);
+  /* Recycled objects are handed back most recently freed first. */
+  assert(ADT_pool_get(&pool) == b_ptr);
+  assert(ADT_pool_get(&pool) == a_ptr);
+  printf("Test Pool Put (ADT_pool_put)...ok\n");
+  ADT_pool_destroy(&pool);
+}
+
+void test__ADT_pool_destroy()
+{
+  struct ADT_pool pool;
+  int i;
+
+  assert(ADT_pool_init(&pool, 16, 4) == 0);
+  for (i = 0; i < 10; i++)
+    assert(ADT_pool_get(&pool) != NULL);
+  ADT_pool_destroy(&pool);
+  assert(pool.chunks == NULL && pool.free == NULL);
+  /* A destroyed pool is reusable. */
+  assert(ADT_pool_get(&pool) != NULL);
+  printf("Test Pool Destroy (ADT_pool_destroy)...ok\n");
+  ADT_pool_destroy(&pool);
+}
+
+int main()
+{
+  test__ADT_pool_get();
+  test__ADT_pool_put();
+  test__ADT_pool_destroy();
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "ring.h"
+
+#define ITEMS 100000
+
+static int dropped;
+
+static void count_drop(void *data)
+{
+  dropped++;
+}
+
+void test__ADT_ring_fail()
+{
+  struct ADT_ring ring;
+  void *data;
+  long i;
+
+  assert(ADT_ring_init(&ring, 3, ADT_RING_FAIL) == 0);
+  /* Capacity is rounded up to a power of two. */
+  assert(ring.mask == 3);
+  for (i = 0; i < 4; i++)
+    assert(ADT_ring_enqueue(&ring, (void *)i) == 0);
+  assert(ADT_ring_enqueue(&ring, (void *)i) == -1);
+  assert(ADT_ring_length(&ring) == 4);
+  for (i = 0; i < 4; i++) {
+    assert(ADT_ring_dequeue(&ring, &data) == 0);
+    assert(data == (void *)i);
+  }
+  assert(ADT_ring_dequeue(&ring, &data) == -1);
+  printf("Test Ring Fail Policy (ADT_RING_FAIL)...ok\n");
+  ADT_ring_destroy(&ring, NULL);
+}
+
+void test__ADT_ring_overwrite()
+{
+  struct ADT_ring ring;
+  void *data;
+  long i;
+
+  assert(ADT_ring_init(&ring, 4, ADT_RING_OVERWRITE) == 0);
+  ring.drop = &count_drop;
+  for (i = 0; i < 10; i++)
+    assert(ADT_ring_enqueue(&ring, (void *)i) == 0);
+  assert(dropped == 6 && ADT_ring_length(&ring) == 4);
+  /* The newest four survive. */
+  assert(ADT_ring_dequeue(&ring, &data) == 0 && data == (void *)6L);
+  printf("Test Ring Overwrite Policy (ADT_RING_OVERWRITE)...ok\n");
+  ADT_ring_destroy(&ring, NULL);
+}
+
+void test__ADT_ring_grow()
+{
+  struct ADT_ring ring;
+  void *data;
+  long i;
+
+  assert(ADT_ring_init(&ring, 4, ADT_RING_GROW) == 0);
+  /* Wrap the ring before it has to grow. */
+  ADT_ring_enqueue(&ring, NULL);
+  ADT_ring_enqueue(&ring, NULL);
+  ADT_ring_dequeue(&ring, &data);
+  ADT_ring_dequeue(&ring, &data);
+  for (i = 0; i < 100; i++)
+    assert(ADT_ring_enqueue(&ring, (void *)i) == 0);
+  assert(ADT_ring_length(&ring) == 100 && ring.mask == 127);
+  for (i = 0; i < 100; i++) {
+    assert(ADT_ring_dequeue(&ring, &data) == 0);
+    assert(data == (void *)i);
+  }
+  printf("Test Ring Grow Policy (ADT_RING_GROW)...ok\n");
+  ADT_ring_destroy(&ring, NULL);
+}
+
+static void *spsc_producer(void *arg)
+{
+  struct ADT_spsc_ring *ring = (struct ADT_spsc_ring *)arg;
+  long i;
+
+  for (i = 1; i <= ITEMS; i++)
+    while (ADT_spsc_ring_enqueue(ring, (void *)i) != 0)
+      ;
+  return NULL;
+}
+
+void test__ADT_spsc_ring()
+{
+  struct ADT_spsc_ring ring;
+  pthread_t producer;
+  void *data;
+  long expect = 1;
+
+  assert(ADT_spsc_ring_init(&ring, 64) == 0);
+  assert(ADT_spsc_ring_dequeue(&ring, &data) == -1);
+  pthread_create(&producer, NULL, &spsc_producer, &ring);
+  while (expect <= ITEMS) {
+    if (ADT_spsc_ring_dequeue(&ring, &data) == 0) {
+      assert(data == (void *)expect);
+      expect++;
+    }
+  }
+  pthread_join(producer, NULL);
+  assert(ADT_spsc_ring_length(&ring) == 0);
+  printf("Test SPSC Ring (ADT_spsc_ring_*)...ok\n");
+  ADT_spsc_ring_destroy(&ring, NULL);
+}
+
+int main()
+{
+  test__ADT_ring_fail();
+  test__ADT_ring_overwrite();
+  test__ADT_ring_grow();
+  test__ADT_spsc_ring();
+  return 0;
+}
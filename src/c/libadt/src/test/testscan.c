@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "scan.h"
+
+#define MAXN 67
+
+void test__ADT_find()
+{
+  const void *keys[MAXN + 4];
+  size_t n, off, i;
+
+  for (i = 0; i < MAXN + 4; i++)
+    keys[i] = (const void *)(uintptr_t)(i * 0x100000001ULL + 7);
+  /* Every length and start alignment, with the key at every position. */
+  for (off = 0; off < 4; off++) {
+    for (n = 0; n <= MAXN; n++) {
+      for (i = 0; i < n; i++)
+        assert(ADT_find(keys + off, n, keys[off + i]) == i);
+      assert(ADT_find(keys + off, n, (const void *)1) == n);
+#if UINTPTR_MAX == UINT64_MAX
+      /* Equal low halves alone are not a match. */
+      for (i = 0; i < n; i++)
+        assert(ADT_find(keys + off, n, (const void *)((uintptr_t)keys[off + i] + (1ULL << 32))) == n);
+#endif
+    }
+  }
+  printf("Test Vectorized Find (ADT_find, %s)...ok\n", ADT_scan_isa());
+}
+
+void test__ADT_filter()
+{
+  const void *keys[MAXN + 4];
+  void *out[MAXN], *ref[MAXN];
+  uintptr_t lo, hi;
+  size_t n, off, i, m, r;
+
+  srand(3);
+  for (i = 0; i < MAXN + 4; i++)
+    keys[i] = (const void *)(uintptr_t)(rand() % 64);
+  /* Keys with the top bit set must compare unsigned. */
+  keys[5] = (const void *)UINTPTR_MAX;
+  keys[9] = (const void *)(UINTPTR_MAX / 2 + 1);
+  for (off = 0; off < 4; off++) {
+    for (n = 0; n <= MAXN; n++) {
+      for (lo = 0; lo < 64; lo += 7) {
+        for (hi = lo; hi < 72; hi += 5) {
+          m = ADT_filter(keys + off, n, lo, hi, out);
+          for (r = 0, i = 0; i < n; i++) {
+            if ((uintptr_t)keys[off + i] >= lo && (uintptr_t)keys[off + i] <= hi)
+              ref[r++] = (void *)keys[off + i];
+          }
+          assert(m == r);
+          for (i = 0; i < m; i++)
+            assert(out[i] == ref[i]);
+        }
+      }
+    }
+  }
+  assert(ADT_filter(keys, MAXN, UINTPTR_MAX / 2, UINTPTR_MAX, out) == 2);
+  assert(out[0] == (void *)UINTPTR_MAX && out[1] == (void *)(UINTPTR_MAX / 2 + 1));
+  assert(ADT_filter(keys, MAXN, 0, UINTPTR_MAX, out) == MAXN);
+  assert(ADT_filter(keys, MAXN, 10, 9, out) == 0);
+  printf("Test Vectorized Filter (ADT_filter, %s)...ok\n", ADT_scan_isa());
+}
+
+int main()
+{
+  static const char *isas[] = { "avx2", "sse2", "neon", "scalar" };
+  const char *best = ADT_scan_isa();
+  size_t i;
+
+  /* Every variant this CPU runs, not just the one dispatched to. */
+  for (i = 0; i < sizeof(isas) / sizeof(isas[0]); i++) {
+    if (ADT_scan_force(isas[i]) != 0)
+      continue;
+    test__ADT_find();
+    test__ADT_filter();
+  }
+  assert(ADT_scan_force("mmx") == -1);
+  assert(ADT_scan_force(NULL) == 0 && strcmp(ADT_scan_isa(), best) == 0);
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "skiplist.h"
+
+#define ITEMS 10000
+#define READERS 3
+
+static int cmp_long(const void *a, const void *b, void *ctx)
+{
+  return ((long)a > (long)b) - ((long)a < (long)b);
+}
+
+void test__ADT_skiplist()
+{
+  struct ADT_skiplist list;
+  struct ADT_skip_iter iter;
+  void *key, *value;
+  long i, n, prev;
+
+  ADT_skiplist_init(&list, &cmp_long, NULL);
+  /* Keys 0, 2, .. in a scrambled order. */
+  for (i = 0; i < ITEMS; i++)
+    assert(ADT_skiplist_insert(&list, (void *)(i * 7919 % ITEMS * 2), (void *)i) == 0);
+  assert(ADT_skiplist_insert(&list, (void *)0, (void *)-1) == 1);
+  assert(ADT_skiplist_length(&list) == ITEMS);
+  assert(ADT_skiplist_find(&list, (void *)0, &value) == 0 && value == (void *)-1);
+  assert(ADT_skiplist_find(&list, (void *)1, &value) == -1);
+  for (i = 0; i < ITEMS; i += 2) {
+    assert(ADT_skiplist_remove(&list, (void *)(i * 2), &key, NULL) == 0);
+    assert(key == (void *)(i * 2));
+  }
+  assert(ADT_skiplist_remove(&list, (void *)0, NULL, NULL) == -1);
+  assert(ADT_skiplist_length(&list) == ITEMS / 2);
+  /* [100, 200) holds 102, 106, .. 198. */
+  ADT_skiplist_range(&list, &iter, (void *)100, (void *)200);
+  prev = 98;
+  n = 0;
+  while (ADT_skip_iter_next(&iter, &key, NULL) == 0) {
+    assert((long)key == prev + 4);
+    prev = (long)key;
+    n++;
+  }
+  assert(n == 25 && prev == 198);
+  ADT_skiplist_range(&list, &iter, NULL, NULL);
+  for (n = 0; ADT_skip_iter_next(&iter, NULL, NULL) == 0; n++)
+    ;
+  assert(n == ITEMS / 2);
+  ADT_skiplist_destroy(&list, NULL, NULL);
+  assert(ADT_skiplist_length(&list) == 0);
+  printf("Test Skip List (ADT_skiplist_*)...ok\n");
+}
+
+static struct ADT_cskiplist clist;
+static atomic_int writing;
+
+/* Even keys are always present; odd ones come and go under the writer. */
+static void *reader(void *arg)
+{
+  struct ADT_cskip_iter iter;
+  void *key, *value;
+  long k, prev, evens;
+
+  while (atomic_load(&writing)) {
+    for (k = 0; k < ITEMS; k += 2) {
+      assert(ADT_cskiplist_find(&clist, (void *)k, &value) == 0);
+      assert(value == (void *)k);
+    }
+    assert(ADT_cskiplist_range(&clist, &iter, (void *)(ITEMS / 4), (void *)(ITEMS / 2)) == 0);
+    prev = -1;
+    evens = 0;
+    while (ADT_cskip_iter_next(&iter, &key, NULL) == 0) {
+      assert((long)key > prev && (long)key >= ITEMS / 4 && (long)key < ITEMS / 2);
+      prev = (long)key;
+      evens += ((long)key % 2 == 0);
+    }
+    assert(evens == ITEMS / 8);
+  }
+  return NULL;
+}
+
+void test__ADT_cskiplist()
+{
+  pthread_t readers[READERS];
+  void *key;
+  long i, round;
+
+  assert(ADT_cskiplist_init(&clist, &cmp_long, NULL) == 0);
+  for (i = 0; i < ITEMS; i += 2)
+    assert(ADT_cskiplist_insert(&clist, (void *)i, (void *)i) == 0);
+  atomic_store(&writing, 1);
+  for (i = 0; i < READERS; i++)
+    pthread_create(&readers[i], NULL, &reader, NULL);
+  for (round = 0; round < 20; round++) {
+    for (i = 1; i < ITEMS; i += 2)
+      assert(ADT_cskiplist_insert(&clist, (void *)i, (void *)i) == 0);
+    assert(ADT_cskiplist_length(&clist) == ITEMS);
+    for (i = 1; i < ITEMS; i += 2) {
+      assert(ADT_cskiplist_remove(&clist, (void *)i, &key, NULL) == 0);
+      assert(key == (void *)i);
+    }
+  }
+  atomic_store(&writing, 0);
+  for (i = 0; i < READERS; i++)
+    pthread_join(readers[i], NULL);
+  assert(ADT_cskiplist_length(&clist) == ITEMS / 2);
+  assert(ADT_cskiplist_find(&clist, (void *)1, NULL) == -1);
+  ADT_cskiplist_destroy(&clist, NULL, NULL);
+  ADT_hp_drain();
+  printf("Test Concurrent Skip List (ADT_cskiplist_*)...ok\n");
+}
+
+int main()
+{
+  test__ADT_skiplist();
+  test__ADT_cskiplist();
+  return 0;
+}
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+/* Count in this file's inline copies whatever the library was built with. */
+#ifndef ADT_STATS
+#define ADT_STATS
+#endif
+#ifndef ADT_STATS_TIMING
+#define ADT_STATS_TIMING
+#endif
+#define ADT_INLINE
+#include "list.h"
+#include "stats.h"
+
+static int allocs_left;
+
+static void *failing_alloc(void *ctx, size_t size)
+{
+  if (allocs_left == 0)
+    return NULL;
+  allocs_left--;
+  return malloc(size);
+}
+
+static void failing_free(void *ctx, void *ptr)
+{
+  free(ptr);
+}
+
+static const struct ADT_allocator failing = { &failing_alloc, &failing_free, NULL };
+
+static unsigned long long latency_total(struct ADT_stats *stats, int op)
+{
+  unsigned long long n = 0;
+  int i;
+
+  for (i = 0; i < ADT_STATS_BUCKETS; i++)
+    n += stats->latency[op][i];
+  return n;
+}
+
+void test__ADT_stats_snapshot()
+{
+  struct ADT_sl_list list;
+  struct ADT_stats stats;
+  void *data;
+  long i;
+
+  ADT_stats_reset();
+  ADT_sl_list_init(&list);
+  for (i = 0; i < 10; i++)
+    ADT_sl_list_push(&list, (void *)i);
+  for (i = 0; i < 5; i++)
+    ADT_sl_list_append(&list, (void *)i);
+  for (i = 0; i < 12; i++)
+    ADT_sl_list_pop(&list, &data);
+  ADT_stats_snapshot(&stats);
+  assert(stats.calls[ADT_STATS_PUSH] == 10);
+  assert(stats.calls[ADT_STATS_APPEND] == 5);
+  assert(stats.calls[ADT_STATS_POP] == 12);
+  assert(stats.nodes_allocated == 15 && stats.nodes_freed == 12);
+  assert(stats.peak_length == 15);
+  assert(latency_total(&stats, ADT_STATS_PUSH) == 10);
+  assert(latency_total(&stats, ADT_STATS_POP) == 12);
+  ADT_sl_list_destroy(&list, NULL);
+  ADT_stats_reset();
+  ADT_stats_snapshot(&stats);
+  assert(stats.calls[ADT_STATS_PUSH] == 0 && stats.peak_length == 0);
+  printf("Test List Statistics (ADT_stats_snapshot)...ok\n");
+}
+
+/* Only nodes actually allocated are counted. */
+void test__ADT_stats_alloc_failure()
+{
+  struct ADT_sl_list list;
+  struct ADT_stats stats;
+
+  ADT_stats_reset();
+  ADT_sl_list_init_alloc(&list, &failing);
+  allocs_left = 2;
+  assert(ADT_sl_list_push(&list, (void *)1) == 0);
+  assert(ADT_sl_list_push(&list, (void *)2) == 0);
+  assert(ADT_sl_list_push(&list, (void *)3) == -1);
+  assert(ADT_sl_list_append(&list, (void *)4) == -1);
+  ADT_stats_snapshot(&stats);
+  assert(stats.nodes_allocated == 2 && stats.nodes_freed == 0);
+  ADT_sl_list_destroy(&list, NULL);
+  ADT_stats_reset();
+  printf("Test List Statistics on Allocation Failure (ADT_stats_snapshot)...ok\n");
+}
+
+int main()
+{
+  test__ADT_stats_snapshot();
+  test__ADT_stats_alloc_failure();
+  return 0;
+}
@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include "tpool.h"
+
+#define ITEMS 100000
+#define TASKS 1000
+
+static void add(void *data, void *ctx)
+{
+  atomic_fetch_add((atomic_long *)ctx, (long)data);
+}
+
+static void fold_sum(void *acc, void *data, void *ctx)
+{
+  *(long *)acc += (long)data;
+}
+
+static void combine_sum(void *acc, void *other, void *ctx)
+{
+  *(long *)acc += *(long *)other;
+}
+
+/* Concatenation checks that chunks are combined in list order. */
+struct span {
+  long first;
+  long last;
+  int ok;
+};
+
+static void fold_span(void *acc, void *data, void *ctx)
+{
+  struct span *s = (struct span *)acc;
+
+  if (s->first == -1)
+    s->first = (long)data;
+  else if ((long)data != s->last + 1)
+    s->ok = 0;
+  s->last = (long)data;
+}
+
+static void combine_span(void *acc, void *other, void *ctx)
+{
+  struct span *s = (struct span *)acc, *o = (struct span *)other;
+
+  if (o->first == -1)
+    return;
+  if (s->first == -1) {
+    *s = *o;
+    return;
+  }
+  if (o->first != s->last + 1 || !o->ok)
+    s->ok = 0;
+  s->last = o->last;
+}
+
+struct counted {
+  struct ADT_task task;
+  atomic_int *count;
+  struct ADT_tpool *pool;
+  int spawn;
+};
+
+static void run_counted(struct ADT_task *task)
+{
+  struct counted *c = ADT_container_of(task, struct counted, task);
+
+  atomic_fetch_add(c->count, 1);
+  /* Tasks submitted from a worker go on its own deque. */
+  if (c->spawn) {
+    c->spawn = 0;
+    assert(ADT_tpool_submit(c->pool, &c->task) == 0);
+  }
+}
+
+void test__ADT_tpool_submit()
+{
+  struct ADT_tpool pool;
+  struct counted *tasks;
+  atomic_int count;
+  int i;
+
+  atomic_init(&count, 0);
+  tasks = (struct counted *)malloc(TASKS * sizeof(struct counted));
+  assert(ADT_tpool_init(&pool, 4) == 0);
+  assert(pool.nthreads == 4);
+  for (i = 0; i < TASKS; i++) {
+    tasks[i].task.fn = &run_counted;
+    tasks[i].count = &count;
+    tasks[i].pool = &pool;
+    tasks[i].spawn = 1;
+    assert(ADT_tpool_submit(&pool, &tasks[i].task) == 0);
+  }
+  while (atomic_load(&count) < 2 * TASKS)
+    ;
+  ADT_tpool_destroy(&pool);
+  assert(atomic_load(&count) == 2 * TASKS);
+  free(tasks);
+  printf("Test Thread Pool Submit (ADT_tpool_submit)...ok\n");
+}
+
+void test__ADT_sl_list_parallel_for()
+{
+  struct ADT_sl_list list;
+  atomic_long sum;
+  unsigned int n;
+  long i;
+
+  ADT_sl_list_init(&list);
+  atomic_init(&sum, 0);
+  assert(ADT_sl_list_parallel_for(&list, &add, &sum, 4) == 0);
+  assert(atomic_load(&sum) == 0);
+  for (i = 0; i < ITEMS; i++)
+    ADT_sl_list_append(&list, (void *)i);
+  /* Fewer items than chunks, and the default thread count. */
+  for (n = 1; n <= 4; n++) {
+    atomic_store(&sum, 0);
+    assert(ADT_sl_list_parallel_for(&list, &add, &sum, n) == 0);
+    assert(atomic_load(&sum) == (long)ITEMS * (ITEMS - 1) / 2);
+  }
+  atomic_store(&sum, 0);
+  assert(ADT_sl_list_parallel_for(&list, &add, &sum, 0) == 0);
+  assert(atomic_load(&sum) == (long)ITEMS * (ITEMS - 1) / 2);
+  ADT_sl_list_destroy(&list, NULL);
+  printf("Test Parallel For (ADT_sl_list_parallel_for)...ok\n");
+}
+
+void test__ADT_sl_list_parallel_reduce()
+{
+  struct ADT_sl_list list;
+  struct ADT_tpool pool;
+  struct span span;
+  long i, sum;
+
+  ADT_sl_list_init(&list);
+  for (i = 0; i < 10; i++)
+    ADT_sl_list_append(&list, (void *)i);
+  sum = 0;
+  assert(ADT_sl_list_parallel_reduce(&list, &fold_sum, &combine_sum, NULL, &sum,
+                                     sizeof(sum), 4) == 0);
+  assert(sum == 45);
+  for (; i < ITEMS; i++)
+    ADT_sl_list_append(&list, (void *)i);
+  assert(ADT_tpool_init(&pool, 4) == 0);
+  sum = 0;
+  assert(ADT_sl_list_parallel_reduce_pool(&pool, &list, &fold_sum, &combine_sum, NULL, &sum,
+                                          sizeof(sum)) == 0);
+  assert(sum == (long)ITEMS * (ITEMS - 1) / 2);
+  span.first = -1;
+  span.last = -1;
+  span.ok = 1;
+  assert(ADT_sl_list_parallel_reduce_pool(&pool, &list, &fold_span, &combine_span, NULL,
+                                          &span, sizeof(span)) == 0);
+  assert(span.ok && span.first == 0 && span.last == ITEMS - 1);
+  ADT_tpool_destroy(&pool);
+  ADT_sl_list_destroy(&list, NULL);
+  printf("Test Parallel Reduce (ADT_sl_list_parallel_reduce)...ok\n");
+}
+
+static atomic_long destroyed;
+
+static void count_destroy(void *data)
+{
+  atomic_fetch_add(&destroyed, 1);
+}
+
+static atomic_int gate_open;
+static long probe_saw;
+
+static void gate_run(struct ADT_task *task)
+{
+  while (!atomic_load(&gate_open))
+    ;
+}
+
+static void probe_run(struct ADT_task *task)
+{
+  probe_saw = atomic_load(&destroyed);
+}
+
+void test__ADT_sl_list_destroy_async()
+{
+  struct ADT_sl_list list;
+  struct ADT_tpool pool;
+  struct ADT_task gate, probe;
+  long i;
+
+  assert(ADT_tpool_init(&pool, 2) == 0);
+  ADT_sl_list_init(&list);
+  for (i = 0; i < ITEMS; i++)
+    ADT_sl_list_append(&list, (void *)i);
+  atomic_init(&destroyed, 0);
+  assert(ADT_sl_list_destroy_async(&pool, &list, &count_destroy) == 0);
+  assert(ADT_sl_list_length(&list) == 0 && list.head == NULL && list.tail == NULL);
+  /* The list is reusable at once. */
+  ADT_sl_list_append(&list, (void *)1);
+  ADT_tpool_destroy(&pool);
+  assert(atomic_load(&destroyed) == ITEMS);
+  ADT_sl_list_destroy(&list, NULL);
+
+  /*
+   * On one worker, a task queued behind the release still runs between
+   * its slices: a gate holds the worker until both are queued.
+   */
+  assert(ADT_tpool_init(&pool, 1) == 0);
+  for (i = 0; i < ITEMS; i++)
+    ADT_sl_list_append(&list, (void *)i);
+  atomic_init(&destroyed, 0);
+  atomic_init(&gate_open, 0);
+  gate.fn = &gate_run;
+  probe.fn = &probe_run;
+  assert(ADT_tpool_submit(&pool, &gate) == 0);
+  assert(ADT_sl_list_destroy_async(&pool, &list, &count_destroy) == 0);
+  assert(ADT_tpool_submit(&pool, &probe) == 0);
+  atomic_store(&gate_open, 1);
+  ADT_tpool_destroy(&pool);
+  assert(atomic_load(&destroyed) == ITEMS);
+  assert(probe_saw > 0 && probe_saw < ITEMS);
+  printf("Test Background Destroy (ADT_sl_list_destroy_async)...ok\n");
+}
+
+int main()
+{
+  test__ADT_tpool_submit();
+  test__ADT_sl_list_parallel_for();
+  test__ADT_sl_list_parallel_reduce();
+  test__ADT_sl_list_destroy_async();
+  return 0;
+}
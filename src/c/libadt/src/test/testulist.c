@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "ulist.h"
+
+static int destroyed;
+
+static void count_destroy(void *data)
+{
+  destroyed++;
+}
+
+void test__ADT_ul_list_push()
+{
+  struct ADT_ul_list list;
+  int items[ADT_UL_NODE_CAP + 1];
+  int i;
+
+  ADT_ul_list_init(&list);
+  for (i = 0; i <= ADT_UL_NODE_CAP; i++)
+    assert(ADT_ul_list_push(&list, &items[i]) == 0);
+  /* One full node plus a second head node holding the last push. */
+  assert(list.head->count == 1 && list.head->data[list.head->start] == &items[ADT_UL_NODE_CAP]);
+  assert(list.tail->count == ADT_UL_NODE_CAP && list.head->next == list.tail);
+  printf("Test Unrolled List Push (ADT_ul_list_push)...ok\n");
+  ADT_ul_list_destroy(&list, NULL);
+}
+
+void test__ADT_ul_list_append()
+{
+  struct ADT_ul_list list;
+  struct ADT_ul_node *node;
+  int items[3 * ADT_UL_NODE_CAP];
+  int i, n = 0;
+
+  ADT_ul_list_init(&list);
+  for (i = 0; i < 3 * ADT_UL_NODE_CAP; i++)
+    assert(ADT_ul_list_append(&list, &items[i]) == 0);
+  for (node = list.head; node != NULL; node = node->next)
+    for (i = node->start; i < node->start + node->count; i++)
+      assert(node->data[i] == &items[n++]);
+  assert(n == 3 * ADT_UL_NODE_CAP);
+  printf("Test Unrolled List Append (ADT_ul_list_append)...ok\n");
+  ADT_ul_list_destroy(&list, NULL);
+}
+
+void test__ADT_ul_list_pop()
+{
+  struct ADT_ul_list list;
+  int items[2 * ADT_UL_NODE_CAP];
+  int *tmp;
+  int i;
+
+  ADT_ul_list_init(&list);
+  for (i = 0; i < 2 * ADT_UL_NODE_CAP; i++)
+    ADT_ul_list_enqueue(&list, &items[i]);
+  ADT_ul_list_push(&list, &items[0]);
+  ADT_ul_list_pop(&list, (void *)&tmp);
+  assert(tmp == &items[0]);
+  for (i = 0; i < 2 * ADT_UL_NODE_CAP; i++) {
+    ADT_ul_list_dequeue(&list, (void *)&tmp);
+    assert(tmp == &items[i]);
+  }
+  assert(list.head == NULL && list.tail == NULL);
+  printf("Test Unrolled List Pop (ADT_ul_list_pop)...ok\n");
+  ADT_ul_list_destroy(&list, NULL);
+}
+
+void test__ADT_ul_list_length()
+{
+  struct ADT_ul_list list;
+  int i;
+
+  ADT_ul_list_init(&list);
+  assert(ADT_ul_list_length(&list) == 0);
+  for (i = 0; i < 100; i++) {
+    ADT_ul_list_append(&list, &list);
+    ADT_ul_list_push(&list, &list);
+  }
+  assert(ADT_ul_list_length(&list) == 200);
+  destroyed = 0;
+  ADT_ul_list_destroy(&list, &count_destroy);
+  assert(destroyed == 200 && ADT_ul_list_length(&list) == 0);
+  printf("Test Unrolled List Length (ADT_ul_list_length)...ok\n");
+}
+
+void test__ADT_ul_list_find()
+{
+  struct ADT_ul_list list;
+  struct ADT_ul_node *node;
+  void *out[10 * ADT_UL_NODE_CAP];
+  unsigned int index;
+  long i;
+
+  ADT_ul_list_init(&list);
+  assert(ADT_ul_list_find(&list, (void *)1, &node, &index) == -1);
+  for (i = 1; i <= 5 * ADT_UL_NODE_CAP; i++) {
+    ADT_ul_list_append(&list, (void *)(2 * i));
+    ADT_ul_list_push(&list, (void *)(2 * i + 1));
+  }
+  assert(ADT_ul_list_find(&list, (void *)(2L * ADT_UL_NODE_CAP), &node, &index) == 0);
+  assert(node->data[index] == (void *)(2L * ADT_UL_NODE_CAP));
+  assert(ADT_ul_list_find(&list, (void *)3, NULL, NULL) == 0);
+  assert(ADT_ul_list_find(&list, (void *)2, NULL, NULL) == 0);
+  assert(ADT_ul_list_find(&list, (void *)1, NULL, NULL) == -1);
+
+  /* Odd keys were pushed, so they come first and in descending order. */
+  assert(ADT_ul_list_filter(&list, 10, 20, out, 10 * ADT_UL_NODE_CAP) == 11);
+  assert(out[0] == (void *)19 && out[4] == (void *)11 && out[5] == (void *)10);
+  assert(out[10] == (void *)20);
+  assert(ADT_ul_list_filter(&list, 10, 20, out, 3) == 3 && out[2] == (void *)15);
+  assert(ADT_ul_list_filter(&list, 20, 10, out, 10) == 0);
+  printf("Test Unrolled List Find (ADT_ul_list_find, ADT_ul_list_filter)...ok\n");
+  ADT_ul_list_destroy(&list, NULL);
+}
+
+int main()
+{
+  test__ADT_ul_list_push();
+  test__ADT_ul_list_append();
+  test__ADT_ul_list_pop();
+  test__ADT_ul_list_length();
+  test__ADT_ul_list_find();
+  return 0;
+}
@@ -0,0 +1,637 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include "tpool.h"
+#ifdef DMALLOC
+  #include "dmalloc.h"
+#endif
+
+#define ADT_WS_INITIAL 256
+#define ADT_TPOOL_CHUNKS_PER_THREAD 8
+/* Rounds of stealing an idle worker tries before it goes to sleep. */
+#define ADT_TPOOL_SPINS 64
+/* Nodes a background destroy releases before yielding to other tasks. */
+#define ADT_TPOOL_RECLAIM_SLICE 4096
+
+/* The pool and deque index of the calling thread, if it is a worker. */
+static _Thread_local struct ADT_tpool *ADT_tpool_self_pool = NULL;
+static _Thread_local unsigned int ADT_tpool_self_index;
+
+static struct ADT_ws_array *
+ADT_ws_array_new(long size)
+{
+  struct ADT_ws_array *a;
+
+  a = (struct ADT_ws_array *)malloc(sizeof(struct ADT_ws_array) +
+                                    size * sizeof(struct ADT_task *));
+  if (a == NULL)
+    return NULL;
+  a->size = size;
+  a->prev = NULL;
+  return a;
+}
+
+static int
+ADT_ws_deque_init(struct ADT_ws_deque *d)
+{
+  struct ADT_ws_array *a = ADT_ws_array_new(ADT_WS_INITIAL);
+
+  if (a == NULL)
+    return -1;
+  atomic_init(&d->top, 0);
+  atomic_init(&d->bottom, 0);
+  atomic_init(&d->array, a);
+  return 0;
+}
+
+static void
+ADT_ws_deque_destroy(struct ADT_ws_deque *d)
+{
+  struct ADT_ws_array *a = atomic_load(&d->array), *prev;
+
+  while (a != NULL) {
+    prev = a->prev;
+    free(a);
+    a = prev;
+  }
+}
+
+/*
+ * Push task on the bottom of d. Only the owning worker may call this.
+ * Thieves may still be reading an outgrown array, so it is kept until the
+ * deque is destroyed.
+ */
+static int
+ADT_ws_deque_push(struct ADT_ws_deque *d, struct ADT_task *task)
+{
+  long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+  long t = atomic_load_explicit(&d->top, memory_order_acquire);
+  struct ADT_ws_array *a = atomic_load_explicit(&d->array, memory_order_relaxed), *grown;
+  long i;
+
+  if (b - t > a->size - 1) {
+    grown = ADT_ws_array_new(2 * a->size);
+    if (grown == NULL)
+      return -1;
+    for (i = t; i < b; i++)
+      atomic_store_explicit(&grown->buf[i % grown->size],
+                            atomic_load_explicit(&a->buf[i % a->size], memory_order_relaxed),
+                            memory_order_relaxed);
+    grown->prev = a;
+    atomic_store_explicit(&d->array, grown, memory_order_release);
+    a = grown;
+  }
+  atomic_store_explicit(&a->buf[b % a->size], task, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+  return 0;
+}
+
+/* Pop the newest task of d. Only the owning worker may call this. */
+static struct ADT_task *
+ADT_ws_deque_take(struct ADT_ws_deque *d)
+{
+  long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+  struct ADT_ws_array *a = atomic_load_explicit(&d->array, memory_order_relaxed);
+  struct ADT_task *task = NULL;
+  long t;
+
+  atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  t = atomic_load_explicit(&d->top, memory_order_relaxed);
+  if (t <= b) {
+    task = atomic_load_explicit(&a->buf[b % a->size], memory_order_relaxed);
+    if (t == b) {
+      /* Last task: race the thieves for it. */
+      if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                   memory_order_relaxed))
+        task = NULL;
+      atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+  } else {
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+  }
+  return task;
+}
+
+/* Take the oldest task of d from any thread. NULL if empty or contended. */
+static struct ADT_task *
+ADT_ws_deque_steal(struct ADT_ws_deque *d)
+{
+  long t = atomic_load_explicit(&d->top, memory_order_acquire);
+  struct ADT_ws_array *a;
+  struct ADT_task *task;
+  long b;
+
+  atomic_thread_fence(memory_order_seq_cst);
+  b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+  if (t >= b)
+    return NULL;
+  a = atomic_load_explicit(&d->array, memory_order_acquire);
+  task = atomic_load_explicit(&a->buf[t % a->size], memory_order_relaxed);
+  if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                               memory_order_relaxed))
+    return NULL;
+  return task;
+}
+
+/* Tell sleeping workers that new work has been published. */
+static void
+ADT_tpool_signal(struct ADT_tpool *pool)
+{
+  atomic_fetch_add(&pool->signals, 1);
+  if (atomic_load(&pool->nidle) > 0) {
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+static struct ADT_task *
+ADT_tpool_find(struct ADT_tpool *pool, unsigned int self, int worker)
+{
+  struct ADT_task *task = NULL;
+  void *data;
+  unsigned int i, victim;
+
+  if (worker) {
+    task = ADT_ws_deque_take(&pool->deques[self]);
+    if (task != NULL)
+      return task;
+  }
+  if (ADT_ms_queue_dequeue(&pool->inject, &data) == 0)
+    return (struct ADT_task *)data;
+  for (i = 0; i < pool->nthreads; i++) {
+    victim = (self + 1 + i) % pool->nthreads;
+    if (worker && victim == self)
+      continue;
+    task = ADT_ws_deque_steal(&pool->deques[victim]);
+    if (task != NULL)
+      return task;
+  }
+  return NULL;
+}
+
+static void *
+ADT_tpool_worker(void *arg)
+{
+  struct ADT_tpool *pool = (struct ADT_tpool *)arg;
+  struct ADT_task *task;
+  unsigned int self, seen;
+  int spins = 0;
+
+  pthread_mutex_lock(&pool->lock);
+  for (self = 0; !pthread_equal(pool->threads[self], pthread_self()); self++)
+    ;
+  pthread_mutex_unlock(&pool->lock);
+  ADT_tpool_self_pool = pool;
+  ADT_tpool_self_index = self;
+
+  for (;;) {
+    seen = atomic_load(&pool->signals);
+    task = ADT_tpool_find(pool, self, 1);
+    if (task != NULL) {
+      spins = 0;
+      (*task->fn)(task);
+      continue;
+    }
+    if (atomic_load(&pool->stop))
+      break;
+    if (++spins < ADT_TPOOL_SPINS) {
+      sched_yield();
+      continue;
+    }
+    /* Nothing seen since seen was read means nothing is pending: sleep. */
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->nidle, 1);
+    if (atomic_load(&pool->signals) == seen && !atomic_load(&pool->stop))
+      pthread_cond_wait(&pool->wake, &pool->lock);
+    atomic_fetch_sub(&pool->nidle, 1);
+    pthread_mutex_unlock(&pool->lock);
+    spins = 0;
+  }
+  ADT_tpool_self_pool = NULL;
+  return NULL;
+}
+
+/*
+ * Return a new initialized thread pool running nthreads workers, or one per
+ * online CPU if nthreads is 0.
+ * Pre: pool is a pointer to a newly created ADT_tpool.
+ * Returns: 0 on success or -1 if memory or threads could not be obtained.
+ */
+int
+ADT_tpool_init(struct ADT_tpool *pool, unsigned int nthreads)
+{
+  unsigned int i, started = 0;
+  long ncpu;
+
+  if (nthreads == 0) {
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = (ncpu > 0) ? (unsigned int)ncpu : 1;
+  }
+  pool->nthreads = nthreads;
+  pool->threads = (pthread_t *)calloc(nthreads, sizeof(pthread_t));
+  pool->deques = (struct ADT_ws_deque *)aligned_alloc(ADT_CACHE_LINE,
+                    ADT_CACHE_LINE * ((nthreads * sizeof(struct ADT_ws_deque) +
+                                       ADT_CACHE_LINE - 1) / ADT_CACHE_LINE));
+  if (pool->threads == NULL || pool->deques == NULL)
+    goto fail_alloc;
+  for (i = 0; i < nthreads; i++) {
+    if (ADT_ws_deque_init(&pool->deques[i]) != 0) {
+      while (i-- > 0)
+        ADT_ws_deque_destroy(&pool->deques[i]);
+      goto fail_alloc;
+    }
+  }
+  if (ADT_ms_queue_init_alloc(&pool->inject, &ADT_malloc_allocator) != 0)
+    goto fail_deques;
+  atomic_init(&pool->stop, 0);
+  atomic_init(&pool->signals, 0);
+  atomic_init(&pool->nidle, 0);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->wake, NULL);
+
+  /* Workers look themselves up in threads[], so hold the lock until it is filled. */
+  pthread_mutex_lock(&pool->lock);
+  for (started = 0; started < nthreads; started++) {
+    if (pthread_create(&pool->threads[started], NULL, &ADT_tpool_worker, pool) != 0)
+      break;
+  }
+  pthread_mutex_unlock(&pool->lock);
+  if (started == nthreads)
+    return 0;
+
+  pthread_mutex_lock(&pool->lock);
+  atomic_store(&pool->stop, 1);
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+  for (i = 0; i < started; i++)
+    pthread_join(pool->threads[i], NULL);
+  ADT_ms_queue_destroy(&pool->inject, NULL);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->wake);
+fail_deques:
+  for (i = 0; i < nthreads; i++)
+    ADT_ws_deque_destroy(&pool->deques[i]);
+fail_alloc:
+  free(pool->threads);
+  free(pool->deques);
+  return -1;
+}
+
+/*
+ * Stop the workers once they have run out of tasks, join them and release
+ * the pool.
+ * Pre: nothing submits to pool any more.
+ */
+void
+ADT_tpool_destroy(struct ADT_tpool *pool)
+{
+  unsigned int i;
+
+  pthread_mutex_lock(&pool->lock);
+  atomic_store(&pool->stop, 1);
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+  for (i = 0; i < pool->nthreads; i++)
+    pthread_join(pool->threads[i], NULL);
+  for (i = 0; i < pool->nthreads; i++)
+    ADT_ws_deque_destroy(&pool->deques[i]);
+  ADT_ms_queue_destroy(&pool->inject, NULL);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->wake);
+  free(pool->threads);
+  free(pool->deques);
+}
+
+/*
+ * Schedule task to run on pool. From a worker of pool the task goes on that
+ * worker's deque, from any other thread through the injection queue.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_tpool_submit(struct ADT_tpool *pool, struct ADT_task *task)
+{
+  int rc;
+
+  if (ADT_tpool_self_pool == pool)
+    rc = ADT_ws_deque_push(&pool->deques[ADT_tpool_self_index], task);
+  else
+    rc = ADT_ms_queue_enqueue(&pool->inject, task);
+  if (rc == 0)
+    ADT_tpool_signal(pool);
+  return rc;
+}
+
+/*******************************************************************************
+ * Parallel traversal
+ */
+
+struct ADT_par_job {
+  struct ADT_tpool *pool;
+  struct ADT_sl_node **starts;
+  unsigned int *counts;
+  unsigned int nchunks;
+  void (*fn)(void *, void *);
+  void (*fold)(void *, void *, void *);
+  void *ctx;
+  char *accs;                   /* one accumulator per chunk for reduce */
+  size_t acc_size;
+  atomic_uint remaining;
+  int finished;                 /* set under lock by the last chunk */
+  pthread_mutex_t lock;
+  pthread_cond_t done;
+};
+
+struct ADT_par_task {
+  struct ADT_task task;
+  struct ADT_par_job *job;
+  unsigned int lo;
+  unsigned int hi;
+};
+
+static void
+ADT_par_chunk(struct ADT_par_job *job, unsigned int c)
+{
+  struct ADT_sl_node *node = job->starts[c];
+  unsigned int i;
+  void *acc;
+
+  if (job->fold != NULL) {
+    acc = job->accs + c * job->acc_size;
+    for (i = 0; i < job->counts[c]; i++, node = node->next)
+      (*job->fold)(acc, node->data, job->ctx);
+  } else {
+    for (i = 0; i < job->counts[c]; i++, node = node->next)
+      (*job->fn)(node->data, job->ctx);
+  }
+}
+
+/*
+ * Run the chunk range [lo, hi), first pushing its upper halves for other
+ * workers to steal. Each range lives in the task slot of its first chunk.
+ */
+static void
+ADT_par_run(struct ADT_task *task)
+{
+  struct ADT_par_task *range = ADT_container_of(task, struct ADT_par_task, task);
+  struct ADT_par_job *job = range->job;
+  struct ADT_par_task *tasks = range - range->lo, *half;
+  unsigned int lo = range->lo, hi = range->hi, mid;
+
+  while (hi - lo > 1) {
+    mid = lo + (hi - lo) / 2;
+    half = &tasks[mid];
+    half->task.fn = &ADT_par_run;
+    half->job = job;
+    half->lo = mid;
+    half->hi = hi;
+    if (ADT_tpool_submit(job->pool, &half->task) != 0) {
+      /* No room to share the work: do the upper half here too. */
+      break;
+    }
+    hi = mid;
+  }
+  for (mid = lo; mid < hi; mid++)
+    ADT_par_chunk(job, mid);
+  if (atomic_fetch_sub(&job->remaining, hi - lo) == hi - lo) {
+    pthread_mutex_lock(&job->lock);
+    job->finished = 1;
+    pthread_cond_signal(&job->done);
+    pthread_mutex_unlock(&job->lock);
+  }
+}
+
+/* Block until job is done, helping with the pool's tasks from a worker. */
+static void
+ADT_par_wait(struct ADT_par_job *job)
+{
+  struct ADT_task *task;
+
+  if (ADT_tpool_self_pool == job->pool) {
+    while (atomic_load(&job->remaining) != 0) {
+      task = ADT_tpool_find(job->pool, ADT_tpool_self_index, 1);
+      if (task != NULL)
+        (*task->fn)(task);
+      else
+        sched_yield();
+    }
+  }
+  /* Wait for finished even then, the last chunk may still hold job->lock. */
+  pthread_mutex_lock(&job->lock);
+  while (!job->finished)
+    pthread_cond_wait(&job->done, &job->lock);
+  pthread_mutex_unlock(&job->lock);
+}
+
+static int
+ADT_par_exec(struct ADT_tpool *pool, struct ADT_sl_list *list, struct ADT_par_job *job)
+{
+  struct ADT_par_task *tasks;
+  struct ADT_sl_node *node;
+  unsigned int c, i, per, extra;
+  int rc = 0;
+
+  if (list->len == 0)
+    return 0;
+  job->pool = pool;
+  job->nchunks = pool->nthreads * ADT_TPOOL_CHUNKS_PER_THREAD;
+  if (job->nchunks > list->len)
+    job->nchunks = list->len;
+  job->starts = (struct ADT_sl_node **)malloc(job->nchunks * sizeof(struct ADT_sl_node *));
+  job->counts = (unsigned int *)malloc(job->nchunks * sizeof(unsigned int));
+  tasks = (struct ADT_par_task *)malloc(job->nchunks * sizeof(struct ADT_par_task));
+  if (job->starts == NULL || job->counts == NULL || tasks == NULL) {
+    rc = -1;
+    goto out;
+  }
+  /* One pass over the list records where every chunk starts. */
+  per = list->len / job->nchunks;
+  extra = list->len % job->nchunks;
+  node = list->head;
+  for (c = 0; c < job->nchunks; c++) {
+    job->starts[c] = node;
+    job->counts[c] = per + (c < extra);
+    for (i = 0; i < job->counts[c]; i++)
+      node = node->next;
+  }
+  atomic_init(&job->remaining, job->nchunks);
+  pthread_mutex_init(&job->lock, NULL);
+  pthread_cond_init(&job->done, NULL);
+  tasks[0].task.fn = &ADT_par_run;
+  tasks[0].job = job;
+  tasks[0].lo = 0;
+  tasks[0].hi = job->nchunks;
+  if (ADT_tpool_submit(pool, &tasks[0].task) != 0)
+    ADT_par_run(&tasks[0].task);
+  ADT_par_wait(job);
+  pthread_mutex_destroy(&job->lock);
+  pthread_cond_destroy(&job->done);
+out:
+  free(job->starts);
+  free(job->counts);
+  free(tasks);
+  return rc;
+}
+
+/*
+ * Call fn(data, ctx) for the data of every node of list on the workers of
+ * pool, in no particular order.
+ * Returns: 0 on success or -1 on an allocation error, before fn has run.
+ */
+int
+ADT_sl_list_parallel_for_pool(struct ADT_tpool *pool, struct ADT_sl_list *list,
+                              void (*fn)(void *, void *), void *ctx)
+{
+  struct ADT_par_job job;
+
+  memset(&job, 0, sizeof(job));
+  job.fn = fn;
+  job.ctx = ctx;
+  return ADT_par_exec(pool, list, &job);
+}
+
+/*
+ * Fold every element of list into acc on the workers of pool. Each chunk
+ * folds into its own copy of the acc_size bytes at acc, which on entry must
+ * hold the identity, with fold(chunk_acc, data, ctx). The chunk results are
+ * then merged left to right with combine(acc, chunk_acc, ctx), so combine
+ * needs to be associative but not commutative.
+ * Returns: 0 on success or -1 on an allocation error, acc is then unchanged.
+ */
+int
+ADT_sl_list_parallel_reduce_pool(struct ADT_tpool *pool, struct ADT_sl_list *list,
+                                 void (*fold)(void *, void *, void *),
+                                 void (*combine)(void *, void *, void *), void *ctx,
+                                 void *acc, size_t acc_size)
+{
+  struct ADT_par_job job;
+  unsigned int c, nchunks;
+  int rc;
+
+  if (list->len == 0)
+    return 0;
+  memset(&job, 0, sizeof(job));
+  job.fold = fold;
+  job.ctx = ctx;
+  job.acc_size = acc_size;
+  nchunks = pool->nthreads * ADT_TPOOL_CHUNKS_PER_THREAD;
+  if (nchunks > list->len)
+    nchunks = list->len;
+  job.accs = (char *)malloc(nchunks * acc_size);
+  if (job.accs == NULL)
+    return -1;
+  for (c = 0; c < nchunks; c++)
+    memcpy(job.accs + c * acc_size, acc, acc_size);
+  rc = ADT_par_exec(pool, list, &job);
+  if (rc == 0) {
+    for (c = 0; c < nchunks; c++)
+      (*combine)(acc, job.accs + c * acc_size, ctx);
+  }
+  free(job.accs);
+  return rc;
+}
+
+/*
+ * As ADT_sl_list_parallel_for_pool on a transient pool of nthreads workers.
+ * Returns: 0 on success or -1 if the pool or the job could not be set up.
+ */
+int
+ADT_sl_list_parallel_for(struct ADT_sl_list *list, void (*fn)(void *, void *), void *ctx,
+                         unsigned int nthreads)
+{
+  struct ADT_tpool pool;
+  int rc;
+
+  if (ADT_tpool_init(&pool, nthreads) != 0)
+    return -1;
+  rc = ADT_sl_list_parallel_for_pool(&pool, list, fn, ctx);
+  ADT_tpool_destroy(&pool);
+  return rc;
+}
+
+/*
+ * As ADT_sl_list_parallel_reduce_pool on a transient pool of nthreads
+ * workers.
+ */
+int
+ADT_sl_list_parallel_reduce(struct ADT_sl_list *list, void (*fold)(void *, void *, void *),
+                            void (*combine)(void *, void *, void *), void *ctx,
+                            void *acc, size_t acc_size, unsigned int nthreads)
+{
+  struct ADT_tpool pool;
+  int rc;
+
+  if (ADT_tpool_init(&pool, nthreads) != 0)
+    return -1;
+  rc = ADT_sl_list_parallel_reduce_pool(&pool, list, fold, combine, ctx, acc, acc_size);
+  ADT_tpool_destroy(&pool);
+  return rc;
+}
+
+/*******************************************************************************
+ * Background destruction
+ */
+
+struct ADT_reclaim_task {
+  struct ADT_task task;
+  struct ADT_sl_reclaim r;
+};
+
+/*
+ * Release a slice of nodes, then requeue behind any other pending work:
+ * through the injection queue, since a worker takes from its own deque
+ * LIFO and would pick the task straight back up. If that fails, carry on
+ * here.
+ */
+static void
+ADT_reclaim_run(struct ADT_task *task)
+{
+  struct ADT_reclaim_task *t = ADT_container_of(task, struct ADT_reclaim_task, task);
+  struct ADT_tpool *pool = ADT_tpool_self_pool;
+
+  while (ADT_sl_reclaim_step(&t->r, ADT_TPOOL_RECLAIM_SLICE) != 0) {
+    if (ADT_ms_queue_enqueue(&pool->inject, task) == 0) {
+      ADT_tpool_signal(pool);
+      return;
+    }
+  }
+  free(t);
+}
+
+/*
+ * Empty list in constant time and release its nodes, and its data through
+ * destroy, on a worker of pool, so the caller's latency does not depend on
+ * the list length. Nodes from an allocator that reclaims in bulk are
+ * dropped at once when there is no destroy fn, without using the pool.
+ * Pre: list must be a pointer to an initialized ADT_sl_list structure whose
+ *      allocator allows frees from pool's workers; ADT_pool does not.
+ * Post: list is empty and may be used again. ADT_tpool_destroy waits for
+ *       the release to finish.
+ * Returns: 0 on success or -1 on an allocation error, with list unchanged.
+ */
+int
+ADT_sl_list_destroy_async(struct ADT_tpool *pool, struct ADT_sl_list *list,
+                          void (*destroy)(void *))
+{
+  struct ADT_sl_list saved = *list;
+  struct ADT_reclaim_task *t;
+
+  if (destroy == NULL && list->alloc->free == NULL) {
+    ADT_sl_list_destroy(list, NULL);
+    return 0;
+  }
+  t = malloc(sizeof(*t));
+  if (t == NULL)
+    return -1;
+  t->task.fn = &ADT_reclaim_run;
+  ADT_sl_list_destroy_deferred(list, destroy, &t->r);
+  if (ADT_tpool_submit(pool, &t->task) != 0) {
+    *list = saved;
+    free(t);
+    return -1;
+  }
+  return 0;
+}
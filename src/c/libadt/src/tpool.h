@@ -0,0 +1,87 @@
+#ifndef _ADT_TPOOL_H
+#define _ADT_TPOOL_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "cache.h"
+#include "cqueue.h"
+#include "list.h"
+
+/*******************************************************************************
+ * Work-stealing thread pool
+ *
+ * Each worker owns a Chase-Lev deque. Tasks submitted by a worker go on its
+ * own deque, which it drains LIFO while idle workers steal FIFO from the
+ * other end; tasks submitted from outside the pool go through a shared MPMC
+ * injection queue. Idle workers sleep until new work is published.
+ *
+ * A task is a struct ADT_task embedded in a caller structure (see
+ * ADT_container_of), which must stay valid until its fn has run.
+ */
+
+struct ADT_task {
+  void (*fn)(struct ADT_task *);
+};
+
+struct ADT_ws_array {
+  long size;
+  struct ADT_ws_array *prev;    /* outgrown arrays, freed with the deque */
+  struct ADT_task *_Atomic buf[];
+};
+
+struct ADT_ws_deque {
+  _Alignas(ADT_CACHE_LINE) atomic_long top;     /* thieves */
+  _Alignas(ADT_CACHE_LINE) atomic_long bottom;  /* owner */
+  struct ADT_ws_array *_Atomic array;
+};
+
+struct ADT_tpool {
+  unsigned int nthreads;
+  pthread_t *threads;
+  struct ADT_ws_deque *deques;
+  struct ADT_ms_queue inject;
+  atomic_int stop;
+  atomic_uint signals;          /* bumped whenever work is published */
+  atomic_int nidle;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+};
+
+int ADT_tpool_init(struct ADT_tpool *, unsigned int);
+void ADT_tpool_destroy(struct ADT_tpool *);
+int ADT_tpool_submit(struct ADT_tpool *, struct ADT_task *);
+
+/*******************************************************************************
+ * Parallel traversal
+ *
+ * The list is cut into about eight chunks per thread with one pass over it,
+ * then the chunks are split recursively across the pool, so busy workers
+ * shed halves of their range to idle ones. The list must not be modified
+ * until the call returns. With nthreads 0 one thread per online CPU is used.
+ * The _pool variants run on an existing pool instead of a transient one.
+ */
+
+int ADT_sl_list_parallel_for(struct ADT_sl_list *, void (*fn)(void *, void *), void *,
+                             unsigned int);
+int ADT_sl_list_parallel_reduce(struct ADT_sl_list *, void (*fold)(void *, void *, void *),
+                                void (*combine)(void *, void *, void *), void *,
+                                void *, size_t, unsigned int);
+int ADT_sl_list_parallel_for_pool(struct ADT_tpool *, struct ADT_sl_list *,
+                                  void (*fn)(void *, void *), void *);
+int ADT_sl_list_parallel_reduce_pool(struct ADT_tpool *, struct ADT_sl_list *,
+                                     void (*fold)(void *, void *, void *),
+                                     void (*combine)(void *, void *, void *), void *,
+                                     void *, size_t);
+
+/*******************************************************************************
+ * Background destruction
+ *
+ * ADT_sl_list_destroy_async hands the nodes of a list to the pool, which
+ * releases them in slices between other tasks.
+ */
+
+int ADT_sl_list_destroy_async(struct ADT_tpool *, struct ADT_sl_list *, void (*destroy)(void *));
+
+
+#endif
@@ -0,0 +1,217 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "ulist.h"
+#include "harden.h"
+#include "scan.h"
+
+/*
+ * Return a new initialized Unrolled List.
+ * Pre: list is a pointer to a newly created ADT_ul_list.
+ * Post: list's head and tail will be set to NULL. The length
+ * list will be zero. Nodes come from the library-wide allocator.
+ */
+void
+ADT_ul_list_init(struct ADT_ul_list *list)
+{
+  ADT_ul_list_init_alloc(list, ADT_get_allocator());
+}
+
+/*
+ * Return a new initialized Unrolled List whose nodes come from alloc.
+ * Pre: list is a pointer to a newly created ADT_ul_list, and alloc must
+ *      outlive the list.
+ */
+void
+ADT_ul_list_init_alloc(struct ADT_ul_list *list, const struct ADT_allocator *alloc)
+{
+  list->head = NULL;
+  list->tail = NULL;
+  list->len = 0;
+  list->alloc = alloc;
+}
+
+/*
+ * Remove all items from list and call the designated destroy fn
+ * to free list data.
+ * Pre: list must be a pointer to an initialized ADT_ul_list structure,
+ *      and destroy must be valid function for freeing list data or NULL
+ *      if the list does not own its data.
+ * Post: list nodes are all destroyed. list head and tail are set
+ *       to NULL.
+ */
+void
+ADT_ul_list_destroy(struct ADT_ul_list *list, void (*destroy)(void *))
+{
+  struct ADT_ul_node *node;
+  unsigned int i;
+
+  if (destroy == NULL && list->alloc->free == NULL)
+    list->head = NULL;
+  while (list->head != NULL) {
+    node = list->head;
+    list->head = node->next;
+    if (destroy != NULL) {
+      for (i = node->start; i < node->start + node->count; i++)
+        (*destroy)(node->data[i]);
+    }
+    ADT_free(list->alloc, node);
+  }
+  list->tail = NULL;
+  list->len = 0;
+}
+
+static struct ADT_ul_node *
+ADT_ul_node_alloc(struct ADT_ul_list *list, unsigned int start)
+{
+  struct ADT_ul_node *node;
+
+  node = (struct ADT_ul_node *)ADT_alloc(list->alloc, sizeof(struct ADT_ul_node));
+  if (node == NULL)
+    return NULL;
+  node->next = NULL;
+  node->start = start;
+  node->count = 0;
+  return node;
+}
+
+/*
+ * Insert data at the head of list.
+ * Pre: list must be a pointer to an initialized ADT_ul_list structure.
+ * Post: data is the first element of list, and the list length will be
+ *       increased by one.
+ * Returns: 0 on success or -1 on an allocation error.
+ */
+int
+ADT_ul_list_push(struct ADT_ul_list *list, void *data)
+{
+  struct ADT_ul_node *node = list->head;
+
+  if (node == NULL || node->start == 0) {
+    /* Fill new head nodes back to front so further pushes stay in place. */
+    node = ADT_ul_node_alloc(list, ADT_UL_NODE_CAP);
+    if (node == NULL)
+      return -1;
+    node->next = list->head;
+    if (list->head == NULL)
+      list->tail = node;
+    list->head = node;
+  }
+  node->data[--node->start] = data;
+  node->count++;
+  list->len++;
+  return 0;
+}
+
+/*
+ * Remove data from the head of list.
+ * Pre: list must be a pointer to an initialized ADT_ul_list structure.
+ * Post: data points to the first element of list, which is removed. The
+ *       head node is freed once it is empty. List length is reduced by one.
+ * Note: This routine will abort and die if an attempt is made to
+ *       pop from an empty list.
+ */
+void
+ADT_ul_list_pop(struct ADT_ul_list *list, void **data)
+{
+  struct ADT_ul_node *node = list->head;
+
+  ADT_check(list->len != 0, "pop from an empty list");
+  *data = node->data[node->start++];
+  node->count--;
+  list->len--;
+  if (node->count == 0) {
+    list->head = node->next;
+    if (list->head == NULL)
+      list->tail = NULL;
+    ADT_free(list->alloc, node);
+  }
+}
+
+/*
+ * Insert data to the end of list.
+ * Pre: list must be a pointer to an initialized ADT_ul_list structure.
+ * Post: data is the last element of list. List length will be increased
+ *       by one.
+ * Returns: 0 on success, or -1 on allocation failure.
+ */
+int
+ADT_ul_list_append(struct ADT_ul_list *list, void *data)
+{
+  struct ADT_ul_node *node = list->tail;
+
+  if (node == NULL || node->start + node->count == ADT_UL_NODE_CAP) {
+    node = ADT_ul_node_alloc(list, 0);
+    if (node == NULL)
+      return -1;
+    if (list->tail == NULL)
+      list->head = node;
+    else
+      list->tail->next = node;
+    list->tail = node;
+  }
+  node->data[node->start + node->count++] = data;
+  list->len++;
+  return 0;
+}
+
+unsigned int
+ADT_ul_list_length(struct ADT_ul_list *list)
+{
+  return list->len;
+}
+
+/*
+ * Find the first element of list equal to key.
+ * Pre: list must be a pointer to an initialized ADT_ul_list structure.
+ * Post: if found and node and index are not NULL, the element is
+ *       (*node)->data[*index].
+ * Returns: 0 if found, or -1 otherwise.
+ */
+int
+ADT_ul_list_find(struct ADT_ul_list *list, const void *key, struct ADT_ul_node **node,
+                 unsigned int *index)
+{
+  struct ADT_ul_node *n;
+  size_t i;
+
+  for (n = list->head; n != NULL; n = n->next) {
+    i = ADT_find((const void *const *)n->data + n->start, n->count, key);
+    if (i < n->count) {
+      if (node != NULL)
+        *node = n;
+      if (index != NULL)
+        *index = n->start + (unsigned int)i;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/*
+ * Copy the elements of list whose pointers lie in [lo, hi] as unsigned integers, in
+ * list order, to out, stopping once it holds max.
+ * Pre: list must be a pointer to an initialized ADT_ul_list structure, out
+ *      must have room for max pointers.
+ * Returns: the number of elements copied.
+ */
+size_t
+ADT_ul_list_filter(struct ADT_ul_list *list, uintptr_t lo, uintptr_t hi, void **out, size_t max)
+{
+  struct ADT_ul_node *n;
+  void *block[ADT_UL_NODE_CAP];
+  size_t m = 0, k;
+
+  for (n = list->head; n != NULL && m < max; n = n->next) {
+    if (max - m >= n->count) {
+      m += ADT_filter((const void *const *)n->data + n->start, n->count, lo, hi, out + m);
+    } else {
+      /* Not enough room for a whole node: filter it aside and take what fits. */
+      k = ADT_filter((const void *const *)n->data + n->start, n->count, lo, hi, block);
+      k = (k < max - m) ? k : max - m;
+      memcpy(out + m, block, k * sizeof(void *));
+      m += k;
+    }
+  }
+  return m;
+}
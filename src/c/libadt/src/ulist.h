@@ -0,0 +1,57 @@
+#ifndef _ADT_ULIST_H
+#define _ADT_ULIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "alloc.h"
+
+/*******************************************************************************
+ * Unrolled single linked list
+ *
+ * Each node holds up to ADT_UL_NODE_CAP data pointers in data[start] through
+ * data[start + count - 1], so a sequential scan does one pointer hop per
+ * node instead of one per element:
+ *
+ *   for (node = list->head; node != NULL; node = node->next)
+ *     for (i = node->start; i < node->start + node->count; i++)
+ *       visit(node->data[i]);
+ *
+ * The default capacity makes a node exactly two 64 byte cache lines on LP64.
+ *
+ * find and filter treat the data pointers themselves as keys and run the
+ * ADT_find and ADT_filter kernels (see scan.h) over each node's block, so
+ * they take no comparator.
+ */
+
+#ifndef ADT_UL_NODE_CAP
+#define ADT_UL_NODE_CAP 14
+#endif
+
+struct ADT_ul_node {
+  struct ADT_ul_node *next;
+  unsigned int start;
+  unsigned int count;
+  void *data[ADT_UL_NODE_CAP];
+};
+
+struct ADT_ul_list {
+  struct ADT_ul_node *head;
+  struct ADT_ul_node *tail;
+  unsigned int len;
+  const struct ADT_allocator *alloc;    /* node source */
+};
+
+void ADT_ul_list_init(struct ADT_ul_list *);
+void ADT_ul_list_init_alloc(struct ADT_ul_list *, const struct ADT_allocator *);
+void ADT_ul_list_destroy(struct ADT_ul_list *, void (*destroy)(void *));
+int ADT_ul_list_push(struct ADT_ul_list *, void *);
+void ADT_ul_list_pop(struct ADT_ul_list *, void **);
+int ADT_ul_list_append(struct ADT_ul_list *, void *);
+unsigned int ADT_ul_list_length(struct ADT_ul_list *);
+int ADT_ul_list_find(struct ADT_ul_list *, const void *, struct ADT_ul_node **, unsigned int *);
+size_t ADT_ul_list_filter(struct ADT_ul_list *, uintptr_t, uintptr_t, void **, size_t);
+#define ADT_ul_list_enqueue(list, data) ADT_ul_list_append(list, data)
+#define ADT_ul_list_dequeue(list, data) ADT_ul_list_pop(list, data)
+
+
+#endif